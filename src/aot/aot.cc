@@ -0,0 +1,141 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "aot.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+/*
+    Programs of generated units linked into the executable
+    Built on first use, so units may add to it on start in any order
+*/
+std::vector<const Aot::Program *> & Aot::programs ()
+{
+    static std::vector<const Program *> linked;
+    return linked;
+}
+
+
+Aot::Link::Link(const Program & program)
+{
+    programs().push_back(&program);
+}
+
+
+/*
+    Index linked blocks of running variant
+*/
+Aot::Aot(Cpu & cpu, Bus & bus) : PageTracker(bus), cpu(cpu), entries(0x10000)
+{
+    for (auto program : programs())
+    {
+        if (program -> variant != cpu.variant)
+            continue;
+
+        for (size_t index = 0; index < program -> count; index++)
+        {
+            auto & block = program -> blocks[index];
+
+            blocks.emplace(block.pc, &block);
+            linked[block.pc >> 8] = true;
+        }
+    }
+}
+
+
+/*
+    Run commands until cycle or stop condition
+
+    Block runs only when no interrupt is pending and its worst case
+    fits in the budget, otherwise one command is interpreted.
+*/
+template <Cpu::Variant V>
+Cpu::Stop Aot::run (uint64_t end)
+{
+    while (cpu.cycles < end)
+    {
+        if (!cpu.pending)
+        {
+            auto block = find(cpu.pc);
+
+            if (block && cpu.cycles + block -> worst <= end)
+            {
+                if (block -> code(cpu) && cpu.traps)
+                    return Cpu::Stop::Trap;
+
+                continue;
+            }
+        }
+
+        auto temp = cpu.pc;
+        cpu.step<V>();
+
+        if (cpu.jammed)
+            return Cpu::Stop::Jam;
+
+        if (cpu.traps && cpu.pc == temp)
+            return Cpu::Stop::Trap;
+    }
+
+    return Cpu::Stop::Budget;
+}
+
+template Cpu::Stop Aot::run<Cpu::Variant::Ricoh2A03> (uint64_t end);
+template Cpu::Stop Aot::run<Cpu::Variant::Nmos6502> (uint64_t end);
+
+
+/*
+    Validate page and check linked blocks at address
+*/
+const Aot::Block * Aot::miss (uint16_t pc)
+{
+    auto & page = bus.pages[pc >> 8];
+
+    if (!linked[pc >> 8] || !validate(pc >> 8))
+        return nullptr;
+
+    auto & entry = entries[pc];
+    auto range = blocks.equal_range(pc);
+
+    // First block translated from the same bytes
+    for (auto found = range.first; found != range.second; found++)
+    {
+        auto block = found -> second;
+
+        if ((pc & 0xFF) + block -> size <= 0x100 && !std::memcmp(page.read + (pc & 0xFF), block -> bytes, block -> size))
+        {
+            entry.block = block;
+            break;
+        }
+    }
+
+    entry.checked = true;
+
+    return entry.block;
+}
+
+
+/*
+    Drop entries of page
+*/
+void Aot::drop (uint8_t index)
+{
+    auto first = entries.begin() + (index << 8);
+    std::fill(first, first + 0x100, Entry());
+}
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AOT_H
+#define AOT_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bus/bus.h"
+#include "bus/pagetracker.h"
+#include "cpu/cpu.h"
+
+//
+// Ahead-of-time recompiled blocks
+//
+//      nes-aot translates blocks of a ROM to C++, one function per block
+//      working on registers of Cpu, and the units are linked into the
+//      executable. Each unit adds its program on start, see Link.
+//
+//      A block keeps the bytes it was translated from and runs only
+//      where memory holds the same bytes, so other banks, other ROMs and
+//      self-modifying code fall back to the interpreter. Pages are checked
+//      again when their host memory changes, RAM pages are watched on Bus
+//      and checked again after being written.
+//
+//      Blocks update cycle counter before every bus access as commands
+//      in the interpreter do, leave after a device access and run only
+//      if they fit in the cycle budget, so runs stop on the same command.
+//
+
+class Aot : public PageTracker
+{
+public:
+
+    // Translated block, returns 1 if last command jumped to itself
+    using Native = int (*) (Cpu & cpu);
+
+    struct Block
+    {
+        // Address of first command
+        uint16_t pc;
+
+        // Bytes translated, block ends on its page
+        uint16_t size;
+
+        // Most cycles block can take
+        uint16_t worst;
+
+        // Commands translated
+        const uint8_t * bytes;
+
+        Native code;
+    };
+
+    struct Program
+    {
+        // ROM image translated
+        const char * name;
+
+        // Variant commands were translated for
+        Cpu::Variant variant;
+
+        const Block * blocks;
+        size_t count;
+    };
+
+    //
+    // Adds program of generated unit on start
+    //
+
+    struct Link
+    {
+        Link(const Program & program);
+    };
+
+private:
+
+    struct Entry
+    {
+        // Block matching memory at address, nullptr if none
+        const Block * block = nullptr;
+
+        // Memory at address was checked
+        bool checked = false;
+    };
+
+    Cpu & cpu;
+
+    // Linked blocks of running variant by address
+    std::unordered_multimap<uint16_t, const Block *> blocks;
+
+    // Page has linked blocks
+    std::bitset<256> linked;
+
+    // Entry per address
+    std::vector<Entry> entries;
+
+    /*
+        Programs of generated units linked into the executable
+    */
+    static std::vector<const Program *> & programs ();
+
+    /*
+        Returns block matching memory at address
+        nullptr if there is none or it must be interpreted
+    */
+    const Block * find (uint16_t pc)
+    {
+        auto & entry = entries[pc];
+
+        if (entry.checked && isValid(pc >> 8))
+            return entry.block;
+
+        return miss(pc);
+    }
+
+    /*
+        Validate page and check linked blocks at address
+    */
+    const Block * miss (uint16_t pc);
+
+    /*
+        Drop entries of page
+    */
+    void drop (uint8_t index) override;
+
+public:
+
+    Aot(Cpu & cpu, Bus & bus);
+
+    /*
+        Run commands until cycle or stop condition
+        Commands outside of blocks are run by interpreter
+    */
+    template <Cpu::Variant V>
+    Cpu::Stop run (uint64_t end);
+
+    /*
+        Bus access of translated code
+        Slow is set when access is not plain host memory
+    */
+    static uint8_t read (Bus & bus, uint16_t index, bool & slow)
+    {
+        auto & page = bus.pages[index >> 8];
+
+        if (page.read)
+            return page.read[index & 0xFF];
+
+        slow = true;
+        return bus.read(index);
+    }
+
+    static void write (Bus & bus, uint16_t index, uint8_t data, bool & slow)
+    {
+        auto & page = bus.pages[index >> 8];
+
+        if (page.write) {
+            page.write[index & 0xFF] = data;
+        } else {
+            slow = true;
+            bus.write(index, data);
+        }
+    }
+
+    /*
+        Read 2-bytes address from zeropage without carry
+    */
+    static uint16_t pointer (Bus & bus, uint8_t zp, bool & slow)
+    {
+        uint16_t lo = read(bus, zp, slow);
+        uint16_t hi = read(bus, 0x00FF & (zp + 1), slow);
+
+        return (hi << 8) | lo;
+    }
+
+    /*
+        Leave block at address with static cycles and commands run
+    */
+    static int leave (Cpu & cpu, uint16_t pc, uint32_t cycles, uint32_t count, bool trap = false)
+    {
+        cpu.pc       = pc;
+        cpu.cycles  += cycles;
+        cpu.counter += count;
+
+        return trap;
+    }
+};
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "apu.h"
+
+#include <algorithm>
+
+#include "cpu/cpu.h"
+#include "bus/bus.h"
+#include "state.h"
+
+// Sequencer steps in CPU clocks from sequence start (4-step and 5-step mode)
+static const uint16_t steps[2][4] =
+{
+    { 7457, 14913, 22371, 29829 },
+    { 7457, 14913, 22371, 37281 }
+};
+
+// Sequence length in CPU clocks
+static const uint16_t lengths[2] = { 29830, 37282 };
+
+// Blip buffer, enough for several frames between syncs
+static const size_t capacity = 4096;
+
+
+Apu::Apu(Cpu & cpu, Bus & bus, Samples & samples) :
+    cpu     (cpu),
+    samples (samples),
+    blip    (clock, rate, capacity),
+    dmc     (cpu, bus)
+{ }
+
+
+/*
+    Catch up with CPU cycle counter
+*/
+void Apu::sync()
+{
+    uint64_t target = cpu.getCycles();
+
+    while (time < target)
+    {
+        uint64_t event = getFrameEvent();
+        uint64_t end = std::min(target, event);
+
+        pulse1.run(end, blip);
+        pulse2.run(end, blip);
+        triangle.run(end, blip);
+        noise.run(end, blip);
+        dmc.run(end, blip);
+
+        time = end;
+
+        if (time == event)
+            frame();
+    }
+
+    cpu.irq(Cpu::DmcIrq, dmc.isIrq());
+
+    flush();
+}
+
+
+/*
+    CPU clock of next possible interrupt
+*/
+uint64_t Apu::getDeadline() const
+{
+    uint64_t deadline = dmc.getDeadline();
+
+    if (!fiveStep && !inhibit && !frameIrq)
+        deadline = std::min(deadline, frameStart + steps[0][3]);
+
+    return deadline;
+}
+
+
+/*
+    CPU clock of next sequencer step
+*/
+uint64_t Apu::getFrameEvent() const
+{
+    return frameStart + steps[fiveStep][frameStep];
+}
+
+
+/*
+    Clock envelopes, counters and sweeps of sequencer step
+
+    +------+---------------+---------------+
+    | step | 4-step        | 5-step        |
+    +------+---------------+---------------+
+    | 0    | quarter       | quarter       |
+    | 1    | quarter, half | quarter, half |
+    | 2    | quarter       | quarter       |
+    | 3    | all, IRQ      | all           |
+    +------+---------------+---------------+
+
+    Fourth step of 5-step mode (no clocks) is omitted
+*/
+void Apu::frame()
+{
+    pulse1.quarter();
+    pulse2.quarter();
+    triangle.quarter();
+    noise.quarter();
+
+    if (frameStep & 0x01)
+    {
+        pulse1.half();
+        pulse2.half();
+        triangle.half();
+        noise.half();
+    }
+
+    if (frameStep == 3 && !fiveStep && !inhibit)
+    {
+        frameIrq = true;
+        cpu.irq(Cpu::FrameIrq, true);
+    }
+
+    if (++frameStep == 4)
+    {
+        frameStep = 0;
+        frameStart += lengths[fiveStep];
+    }
+}
+
+
+/*
+    Push completed samples to ring buffer
+    Samples are dropped when sink does not keep up
+*/
+void Apu::flush()
+{
+    int16_t buffer[512];
+
+    while (auto count = blip.available(time))
+    {
+        count = blip.read(buffer, std::min(count, sizeof(buffer) / sizeof(buffer[0])));
+        samples.push(buffer, count);
+    }
+}
+
+
+/*
+    Read status register $4015
+
+    IF-D NT21   DMC IRQ, frame IRQ, DMC active, length counters active
+    Reading clears frame IRQ
+*/
+uint8_t Apu::read(uint16_t index)
+{
+    if (index != 0x4015)
+        return 0x00;
+
+    sync();
+
+    uint8_t data =
+        (dmc.isIrq()         ? 0x80 : 0x00) |
+        (frameIrq            ? 0x40 : 0x00) |
+        (dmc.isActive()      ? 0x10 : 0x00) |
+        (noise.isActive()    ? 0x08 : 0x00) |
+        (triangle.isActive() ? 0x04 : 0x00) |
+        (pulse2.isActive()   ? 0x02 : 0x00) |
+        (pulse1.isActive()   ? 0x01 : 0x00);
+
+    frameIrq = false;
+    cpu.irq(Cpu::FrameIrq, false);
+
+    return data;
+}
+
+
+/*
+    Write register
+*/
+void Apu::write(uint16_t index, uint8_t data)
+{
+    sync();
+
+    switch (index)
+    {
+        case 0x4000: case 0x4001: case 0x4002: case 0x4003:
+            pulse1.write(index & 0x03, data);
+            break;
+
+        case 0x4004: case 0x4005: case 0x4006: case 0x4007:
+            pulse2.write(index & 0x03, data);
+            break;
+
+        case 0x4008: case 0x4009: case 0x400A: case 0x400B:
+            triangle.write(index & 0x03, data);
+            break;
+
+        case 0x400C: case 0x400D: case 0x400E: case 0x400F:
+            noise.write(index & 0x03, data);
+            break;
+
+        case 0x4010: case 0x4011: case 0x4012: case 0x4013:
+            dmc.write(index & 0x03, data);
+            cpu.irq(Cpu::DmcIrq, dmc.isIrq());
+            break;
+
+        // ---D NT21 channel enable, clears DMC IRQ
+        case 0x4015:
+            pulse1.setEnabled(data & 0x01);
+            pulse2.setEnabled(data & 0x02);
+            triangle.setEnabled(data & 0x04);
+            noise.setEnabled(data & 0x08);
+            dmc.setEnabled(data & 0x10);
+
+            dmc.clearIrq();
+            cpu.irq(Cpu::DmcIrq, false);
+            break;
+
+        // MI-- ---- 5-step mode, IRQ inhibit, restarts sequence
+        case 0x4017:
+            fiveStep = data & 0x80;
+            inhibit  = data & 0x40;
+
+            if (inhibit)
+            {
+                frameIrq = false;
+                cpu.irq(Cpu::FrameIrq, false);
+            }
+
+            frameStart = time;
+            frameStep  = 0;
+
+            // 5-step mode clocks all units immediately
+            if (fiveStep)
+            {
+                pulse1.quarter();
+                pulse2.quarter();
+                triangle.quarter();
+                noise.quarter();
+
+                pulse1.half();
+                pulse2.half();
+                triangle.half();
+                noise.half();
+            }
+            break;
+    }
+}
+
+
+/*
+    Write channels and frame sequencer
+*/
+void Apu::save(State & state) const
+{
+    state.mark("APU ");
+
+    state.put(time);
+    state.put(frameStart);
+    state.put(frameStep);
+    state.put(fiveStep);
+    state.put(inhibit);
+    state.put(frameIrq);
+
+    pulse1.save(state);
+    pulse2.save(state);
+    triangle.save(state);
+    noise.save(state);
+    dmc.save(state);
+}
+
+
+/*
+    Read channels and frame sequencer
+*/
+void Apu::load(State & state)
+{
+    state.check("APU ");
+
+    state.get(time);
+    state.get(frameStart);
+    state.get(frameStep, uint8_t(3));
+    state.get(fiveStep);
+    state.get(inhibit);
+    state.get(frameIrq);
+
+    pulse1.load(state);
+    pulse2.load(state);
+    triangle.load(state);
+    noise.load(state);
+    dmc.load(state);
+
+    blip.reset(time);
+}
@@ -0,0 +1,140 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef APU_H
+#define APU_H
+
+#include <cstdint>
+
+#include "bus/device.h"
+
+#include "blip.h"
+#include "ring.h"
+#include "pulse.h"
+#include "triangle.h"
+#include "noise.h"
+#include "dmc.h"
+
+class Cpu;
+class Bus;
+
+//
+// Ricoh 2A03 Audio Processing Unit
+//
+//      Like PPU, APU is clocked lazily: channels and frame sequencer catch
+//      up with the CPU cycle counter on register access and at deadlines
+//      of frame counter and DMC interrupts. Channel level changes are
+//      band-limited by Blip and mixed linearly, completed samples are
+//      pushed to the ring buffer, which audio sink drains on its own pace.
+//
+//      $4000 - $4003   Pulse 1
+//      $4004 - $4007   Pulse 2
+//      $4008 - $400B   Triangle
+//      $400C - $400F   Noise
+//      $4010 - $4013   DMC
+//      $4015           Channel enable / status
+//      $4017           Frame counter
+//
+
+class Apu : public Device
+{
+public:
+
+    // CPU clock (NTSC)
+    static const uint32_t clock = 1789773;
+
+    // Output sample rate
+    static const uint32_t rate = 44100;
+
+    // Output samples, mono 16-bit
+    using Samples = Ring<int16_t, 0x4000>;
+
+private:
+
+    Cpu & cpu;
+    Samples & samples;
+
+    Blip blip;
+
+    Pulse    pulse1 { true  };
+    Pulse    pulse2 { false };
+    Triangle triangle;
+    Noise    noise;
+    Dmc      dmc;
+
+    // CPU clock up to which APU is synchronized
+    uint64_t time = 0;
+
+    //
+    // Frame sequencer
+    //
+
+    // CPU clock of sequence start
+    uint64_t frameStart = 0;
+
+    // Next step of sequence
+    uint8_t frameStep = 0;
+
+    bool fiveStep = false;
+    bool inhibit  = false;
+    bool frameIrq = false;
+
+    /*
+        CPU clock of next sequencer step
+    */
+    uint64_t getFrameEvent() const;
+
+    /*
+        Clock envelopes, counters and sweeps of sequencer step
+    */
+    void frame();
+
+    /*
+        Push completed samples to ring buffer
+    */
+    void flush();
+
+public:
+
+    Apu(Cpu & cpu, Bus & bus, Samples & samples);
+
+    /*
+        Catch up with CPU cycle counter
+    */
+    void sync();
+
+    /*
+        CPU clock of next possible interrupt
+        CPU must not run past it without calling sync()
+    */
+    uint64_t getDeadline() const;
+
+    /*
+        Write/Read channels and frame sequencer
+        Samples not yet pushed to ring buffer are dropped
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    /*
+        Register access $4000 - $4017
+    */
+    uint8_t read(uint16_t index) override;
+    void write(uint16_t index, uint8_t data) override;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blip.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Cutoff relative to output rate, below Nyquist to leave room for window
+static const double cutoff = 0.45;
+
+// DC blocker pole, about 7Hz at 44.1kHz
+static const float leak = 0.001f;
+
+
+/*
+    Build windowed-sinc impulse for every phase
+*/
+Blip::Blip(double clock, double rate, size_t capacity) :
+    factor (rate / clock),
+    buffer (capacity + taps, 0.0f)
+{
+    const double pi = std::acos(-1.0);
+    const double half = taps / 2;
+
+    for (int phase = 0; phase < phases; phase++)
+    {
+        double total = 0.0;
+
+        for (int k = 0; k < taps; k++)
+        {
+            double t = k - (half - 1) - double(phase) / phases;
+
+            double sinc   = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * t) / (pi * t);
+            double window = 0.42 + 0.5 * std::cos(pi * t / half) + 0.08 * std::cos(2.0 * pi * t / half);
+
+            kernel[phase][k] = float(sinc * window);
+            total += kernel[phase][k];
+        }
+
+        // Unity gain, so integrated step settles to delta exactly
+        for (auto & value : kernel[phase]) {
+            value = float(value / total);
+        }
+    }
+}
+
+
+/*
+    Add amplitude change at CPU clock
+*/
+void Blip::add(uint64_t clock, float delta)
+{
+    double position = (clock - base) * factor;
+
+    auto index = size_t(position);
+    auto phase = int((position - index) * phases);
+
+    // Reader fell behind, drop rather than overrun
+    if (index + taps > buffer.size())
+        return;
+
+    auto & impulse = kernel[phase];
+
+    for (int k = 0; k < taps; k++) {
+        buffer[index + k] += impulse[k] * delta;
+    }
+}
+
+
+/*
+    Samples completed before CPU clock
+    Later deltas only touch samples from clock on
+*/
+size_t Blip::available(uint64_t clock) const
+{
+    if (clock <= base)
+        return 0;
+
+    return std::min(size_t((clock - base) * factor), buffer.size() - taps);
+}
+
+
+/*
+    Read completed samples, returns samples read
+*/
+size_t Blip::read(int16_t * out, size_t count)
+{
+    count = std::min(count, buffer.size() - taps);
+
+    for (size_t index = 0; index < count; index++)
+    {
+        sum += buffer[index];
+        dc  += (sum - dc) * leak;
+
+        float value = (sum - dc) * 32767.0f;
+
+        out[index] = int16_t(std::clamp(value, -32768.0f, 32767.0f));
+    }
+
+    // Shift remaining deltas to buffer start
+    std::copy(buffer.begin() + count, buffer.end(), buffer.begin());
+    std::fill(buffer.end() - count, buffer.end(), 0.0f);
+
+    base += count / factor;
+
+    return count;
+}
+
+
+/*
+    Drop pending deltas and restart at CPU clock
+    Integrator is kept, so output level does not jump
+*/
+void Blip::reset(uint64_t clock)
+{
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    base = double(clock);
+}
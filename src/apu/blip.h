@@ -0,0 +1,90 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLIP_H
+#define BLIP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// Band-limited step synthesis
+//
+//      Channels report amplitude changes (deltas) at CPU clock resolution.
+//      Each delta is added as a windowed-sinc impulse at its fractional
+//      sample position, and the buffer is integrated on read, so every
+//      step is band-limited to the output rate without aliasing and
+//      without generating samples at CPU clock rate.
+//
+
+class Blip
+{
+private:
+
+    // Impulse length in samples
+    static const int taps = 16;
+
+    // Sub-sample positions of impulse
+    static const int phases = 64;
+
+    // Impulse per phase
+    std::array<std::array<float, taps>, phases> kernel;
+
+    // Output samples per CPU clock
+    double factor;
+
+    // CPU clock of first buffered sample
+    double base = 0.0;
+
+    // Pending deltas, one slot per output sample
+    std::vector<float> buffer;
+
+    // Integrator and DC blocker state
+    float sum = 0.0f;
+    float dc  = 0.0f;
+
+public:
+
+    /*
+        Buffer up to capacity samples
+    */
+    Blip(double clock, double rate, size_t capacity);
+
+    /*
+        Add amplitude change at CPU clock
+    */
+    void add(uint64_t clock, float delta);
+
+    /*
+        Samples completed before CPU clock
+    */
+    size_t available(uint64_t clock) const;
+
+    /*
+        Read completed samples, returns samples read
+    */
+    size_t read(int16_t * out, size_t count);
+
+    /*
+        Drop pending deltas and restart at CPU clock
+    */
+    void reset(uint64_t clock);
+};
+
+#endif
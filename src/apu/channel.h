@@ -0,0 +1,101 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <cstdint>
+
+#include "blip.h"
+#include "state.h"
+
+//
+// Base of APU channels
+//
+//      Channel output is synthesized lazily: run() advances the channel
+//      timer from time to end and reports every level change to Blip at
+//      the CPU clock of the timer tick causing it.
+//
+
+class Channel
+{
+protected:
+
+    // CPU clock up to which output is synthesized
+    uint64_t time = 0;
+
+    // CPU clock of next timer tick
+    uint64_t next = 0;
+
+    // Output level last reported to Blip
+    uint8_t level = 0;
+
+    // Mixer weight of one level step
+    float gain;
+
+    /*
+        Report level change at CPU clock
+    */
+    void output(uint64_t clock, uint8_t value, Blip & blip)
+    {
+        if (value != level)
+        {
+            blip.add(clock, (int(value) - int(level)) * gain);
+            level = value;
+        }
+    }
+
+    /*
+        Pass timer ticks up to end without output
+        Returns number of ticks passed
+    */
+    uint64_t skip(uint64_t end, uint32_t period)
+    {
+        if (next > end)
+            return 0;
+
+        uint64_t count = (end - next) / period + 1;
+        next += count * period;
+
+        return count;
+    }
+
+public:
+
+    Channel(float gain) :
+        gain (gain)
+    { }
+
+    /*
+        Write/Read timer position and output level
+    */
+    void save(State & state) const
+    {
+        state.put(time);
+        state.put(next);
+        state.put(level);
+    }
+
+    void load(State & state)
+    {
+        state.get(time);
+        state.get(next);
+        state.get(level);
+    }
+};
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dmc.h"
+
+#include "cpu/cpu.h"
+#include "bus/bus.h"
+
+// Timer period in CPU cycles (NTSC)
+static const uint16_t rates[16] =
+{
+    428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54
+};
+
+
+Dmc::Dmc(Cpu & cpu, Bus & bus) :
+    Channel (0.00335f),
+    cpu     (cpu),
+    bus     (bus)
+{ }
+
+
+/*
+    Write register 0 - 3
+*/
+void Dmc::write(uint8_t reg, uint8_t data)
+{
+    switch (reg)
+    {
+        case 0:
+            irqEnabled = data & 0x80;
+            loop  = data & 0x40;
+            index = data & 0x0F;
+
+            if (!irqEnabled)
+                irq = false;
+            break;
+
+        case 1:
+            value = data & 0x7F;
+            break;
+
+        case 2:
+            start = data;
+            break;
+
+        case 3:
+            size = data;
+            break;
+    }
+}
+
+
+/*
+    Restart sample from start register
+*/
+void Dmc::restart()
+{
+    address   = 0xC000 | (start << 6);
+    remaining = (size << 4) + 1;
+}
+
+
+/*
+    Fill sample buffer by DMA
+*/
+void Dmc::fetch()
+{
+    if (!empty || remaining == 0)
+        return;
+
+    buffer = bus.read(address);
+    empty  = false;
+
+    cpu.stall(4);
+
+    address = (address == 0xFFFF) ? 0x8000 : address + 1;
+
+    if (--remaining == 0)
+    {
+        if (loop) {
+            restart();
+        } else if (irqEnabled) {
+            irq = true;
+        }
+    }
+}
+
+
+/*
+    Clock output unit
+*/
+void Dmc::tick()
+{
+    if (!silence)
+    {
+        if (shift & 0x01) {
+            if (value <= 125) value += 2;
+        } else {
+            if (value >= 2) value -= 2;
+        }
+
+        shift >>= 1;
+    }
+
+    if (--bits == 0)
+    {
+        bits = 8;
+
+        if (empty)
+        {
+            silence = true;
+        }
+        else
+        {
+            silence = false;
+            shift = buffer;
+            empty = true;
+
+            fetch();
+        }
+    }
+}
+
+
+void Dmc::setEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        remaining = 0;
+    }
+    else if (remaining == 0)
+    {
+        restart();
+        fetch();
+    }
+}
+
+
+bool Dmc::isActive() const
+{
+    return remaining > 0;
+}
+
+
+bool Dmc::isIrq() const
+{
+    return irq;
+}
+
+
+void Dmc::clearIrq()
+{
+    irq = false;
+}
+
+
+/*
+    Earliest CPU clock when sample may end and raise IRQ
+    Last byte is fetched when output unit empties buffer
+*/
+uint64_t Dmc::getDeadline() const
+{
+    if (!irqEnabled || loop || remaining == 0)
+        return UINT64_MAX;
+
+    return next + (bits - 1 + 8 * (remaining - 1)) * uint64_t(rates[index]);
+}
+
+
+/*
+    Synthesize output up to CPU clock
+    Idle channel holds its level and passes timer ticks at once
+*/
+void Dmc::run(uint64_t end, Blip & blip)
+{
+    uint32_t cycles = rates[index];
+
+    output(time, value, blip);
+
+    if (silence && empty && remaining == 0)
+    {
+        skip(end, cycles);
+    }
+    else
+    {
+        for (; next <= end; next += cycles)
+        {
+            tick();
+            output(next, value, blip);
+        }
+    }
+
+    time = end;
+}
+
+
+/*
+    Write channel state
+*/
+void Dmc::save(State & state) const
+{
+    Channel::save(state);
+
+    state.put(irqEnabled);
+    state.put(loop);
+    state.put(irq);
+    state.put(index);
+    state.put(start);
+    state.put(size);
+    state.put(address);
+    state.put(remaining);
+    state.put(buffer);
+    state.put(empty);
+    state.put(shift);
+    state.put(bits);
+    state.put(silence);
+    state.put(value);
+}
+
+
+/*
+    Read channel state
+*/
+void Dmc::load(State & state)
+{
+    Channel::load(state);
+
+    state.get(irqEnabled);
+    state.get(loop);
+    state.get(irq);
+    state.get(index, uint8_t(15));
+    state.get(start);
+    state.get(size);
+    state.get(address);
+    state.get(remaining);
+    state.get(buffer);
+    state.get(empty);
+    state.get(shift);
+    state.get(bits);
+    state.get(silence);
+    state.get(value);
+}
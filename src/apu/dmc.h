@@ -0,0 +1,111 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DMC_H
+#define DMC_H
+
+#include "channel.h"
+
+class Cpu;
+class Bus;
+
+//
+// Delta modulation channel
+//
+//      $4010   IL-- RRRR   IRQ enable, loop, rate index
+//      $4011   -DDD DDDD   direct output level
+//      $4012   AAAA AAAA   sample address $C000 + A * 64
+//      $4013   LLLL LLLL   sample length L * 16 + 1 bytes
+//
+//      Sample bytes are fetched by DMA from CPU bus, each fetch stalls
+//      CPU for 4 cycles. Output level moves by 2 per sample bit.
+//
+
+class Dmc : public Channel
+{
+private:
+
+    Cpu & cpu;
+    Bus & bus;
+
+    bool irqEnabled = false;
+    bool loop       = false;
+    bool irq        = false;
+
+    uint8_t index = 0;
+
+    // Sample start and length registers
+    uint8_t start  = 0;
+    uint8_t size   = 0;
+
+    // Sample reader
+    uint16_t address   = 0xC000;
+    uint16_t remaining = 0;
+    uint8_t  buffer    = 0;
+    bool     empty     = true;
+
+    // Output unit
+    uint8_t shift   = 0;
+    uint8_t bits    = 8;
+    bool    silence = true;
+    uint8_t value   = 0;
+
+    /*
+        Restart sample from start register
+    */
+    void restart();
+
+    /*
+        Fill sample buffer by DMA
+    */
+    void fetch();
+
+    /*
+        Clock output unit
+    */
+    void tick();
+
+public:
+
+    Dmc(Cpu & cpu, Bus & bus);
+
+    /*
+        Write register 0 - 3
+    */
+    void write(uint8_t reg, uint8_t data);
+
+    void setEnabled(bool enabled);
+    bool isActive() const;
+
+    bool isIrq() const;
+    void clearIrq();
+
+    /*
+        Earliest CPU clock when sample may end and raise IRQ
+    */
+    uint64_t getDeadline() const;
+
+    /*
+        Write/Read channel state
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    void run(uint64_t end, Blip & blip);
+};
+
+#endif
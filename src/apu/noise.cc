@@ -0,0 +1,154 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "noise.h"
+
+// Timer period in CPU cycles (NTSC)
+static const uint16_t periods[16] =
+{
+    4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
+};
+
+
+Noise::Noise() :
+    Channel (0.00494f)
+{ }
+
+
+/*
+    Write register 0 - 3
+*/
+void Noise::write(uint8_t reg, uint8_t data)
+{
+    switch (reg)
+    {
+        case 0:
+            length.setHalt(data & 0x20);
+            envelope.write(data);
+            break;
+
+        case 2:
+            mode  = data & 0x80;
+            index = data & 0x0F;
+            break;
+
+        case 3:
+            length.load(data >> 3);
+            envelope.restart();
+            break;
+    }
+}
+
+
+uint8_t Noise::getOutput() const
+{
+    if (!length.isActive() || (shift & 0x01))
+        return 0;
+
+    return envelope.getVolume();
+}
+
+
+/*
+    Quarter frame: envelope
+*/
+void Noise::quarter()
+{
+    envelope.clock();
+}
+
+
+/*
+    Half frame: length counter
+*/
+void Noise::half()
+{
+    length.clock();
+}
+
+
+void Noise::setEnabled(bool enabled)
+{
+    length.setEnabled(enabled);
+}
+
+
+bool Noise::isActive() const
+{
+    return length.isActive();
+}
+
+
+/*
+    Synthesize output up to CPU clock
+    Shift register of silent channel is not observable, so it is not stepped
+*/
+void Noise::run(uint64_t end, Blip & blip)
+{
+    uint32_t cycles = periods[index];
+
+    output(time, getOutput(), blip);
+
+    if (!length.isActive() || envelope.getVolume() == 0)
+    {
+        skip(end, cycles);
+    }
+    else
+    {
+        uint8_t tap = mode ? 6 : 1;
+
+        for (; next <= end; next += cycles)
+        {
+            uint16_t feedback = (shift ^ (shift >> tap)) & 0x01;
+            shift = (shift >> 1) | (feedback << 14);
+
+            output(next, getOutput(), blip);
+        }
+    }
+
+    time = end;
+}
+
+
+/*
+    Write channel state
+*/
+void Noise::save(State & state) const
+{
+    Channel::save(state);
+
+    envelope.save(state);
+    length.save(state);
+    state.put(mode);
+    state.put(index);
+    state.put(shift);
+}
+
+
+/*
+    Read channel state
+*/
+void Noise::load(State & state)
+{
+    Channel::load(state);
+
+    envelope.load(state);
+    length.load(state);
+    state.get(mode);
+    state.get(index, uint8_t(15));
+    state.get(shift);
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NOISE_H
+#define NOISE_H
+
+#include "channel.h"
+#include "unit.h"
+
+//
+// Noise channel
+//
+//      $400C   --LC VVVV   halt, constant volume, volume
+//      $400E   M--- PPPP   mode, period index
+//      $400F   LLLL L---   length index
+//
+//      Timer steps 15-bit linear feedback shift register,
+//      short mode taps bit 6 instead of bit 1.
+//
+
+class Noise : public Channel
+{
+private:
+
+    Envelope envelope;
+    Length length;
+
+    bool     mode  = false;
+    uint8_t  index = 0;
+    uint16_t shift = 0x0001;
+
+    uint8_t getOutput() const;
+
+public:
+
+    Noise();
+
+    /*
+        Write register 0 - 3
+    */
+    void write(uint8_t reg, uint8_t data);
+
+    /*
+        Quarter and half frame clocks
+    */
+    void quarter();
+    void half();
+
+    void setEnabled(bool enabled);
+    bool isActive() const;
+
+    /*
+        Write/Read channel state
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    void run(uint64_t end, Blip & blip);
+};
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pulse.h"
+
+// Output step of duty sequences 12.5%, 25%, 50% and 75%
+static const uint8_t sequences[4][8] =
+{
+    { 0, 1, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 1, 0, 0, 0, 0, 0 },
+    { 0, 1, 1, 1, 1, 0, 0, 0 },
+    { 1, 0, 0, 1, 1, 1, 1, 1 }
+};
+
+
+Pulse::Pulse(bool first) :
+    Channel (0.00752f),
+    first   (first)
+{ }
+
+
+/*
+    Write register 0 - 3
+*/
+void Pulse::write(uint8_t reg, uint8_t data)
+{
+    switch (reg)
+    {
+        case 0:
+            duty = data >> 6;
+            length.setHalt(data & 0x20);
+            envelope.write(data);
+            break;
+
+        case 1:
+            sweep  = data & 0x80;
+            period = (data >> 4) & 0x07;
+            negate = data & 0x08;
+            shift  = data & 0x07;
+            reload = true;
+            break;
+
+        case 2:
+            timer = (timer & 0x0700) | data;
+            break;
+
+        case 3:
+            timer = (timer & 0x00FF) | ((data & 0x07) << 8);
+            length.load(data >> 3);
+            envelope.restart();
+            step = 0;
+            break;
+    }
+}
+
+
+/*
+    Sweep target period
+*/
+uint16_t Pulse::getTarget() const
+{
+    uint16_t change = timer >> shift;
+
+    if (!negate)
+        return timer + change;
+
+    // Pulse 1 subtracts one more
+    if (first)
+        change++;
+
+    return change > timer ? 0 : timer - change;
+}
+
+
+/*
+    Timer or sweep target is out of range
+*/
+bool Pulse::isMuted() const
+{
+    return timer < 8 || getTarget() > 0x07FF;
+}
+
+
+uint8_t Pulse::getOutput() const
+{
+    if (!length.isActive() || isMuted())
+        return 0;
+
+    return sequences[duty][step] * envelope.getVolume();
+}
+
+
+/*
+    Quarter frame: envelope
+*/
+void Pulse::quarter()
+{
+    envelope.clock();
+}
+
+
+/*
+    Half frame: length counter and sweep
+*/
+void Pulse::half()
+{
+    length.clock();
+
+    if (divider == 0 && sweep && shift && !isMuted())
+        timer = getTarget();
+
+    if (divider == 0 || reload)
+    {
+        divider = period;
+        reload = false;
+    }
+    else
+    {
+        divider--;
+    }
+}
+
+
+void Pulse::setEnabled(bool enabled)
+{
+    length.setEnabled(enabled);
+}
+
+
+bool Pulse::isActive() const
+{
+    return length.isActive();
+}
+
+
+/*
+    Synthesize output up to CPU clock
+    Silent channel passes timer ticks at once
+*/
+void Pulse::run(uint64_t end, Blip & blip)
+{
+    uint32_t cycles = (timer + 1) * 2;
+
+    output(time, getOutput(), blip);
+
+    if (!length.isActive() || isMuted() || envelope.getVolume() == 0)
+    {
+        step = (step + skip(end, cycles)) & 0x07;
+    }
+    else
+    {
+        for (; next <= end; next += cycles)
+        {
+            step = (step + 1) & 0x07;
+            output(next, getOutput(), blip);
+        }
+    }
+
+    time = end;
+}
+
+
+/*
+    Write channel state
+*/
+void Pulse::save(State & state) const
+{
+    Channel::save(state);
+
+    envelope.save(state);
+    length.save(state);
+    state.put(duty);
+    state.put(step);
+    state.put(timer);
+    state.put(sweep);
+    state.put(negate);
+    state.put(reload);
+    state.put(period);
+    state.put(shift);
+    state.put(divider);
+}
+
+
+/*
+    Read channel state
+*/
+void Pulse::load(State & state)
+{
+    Channel::load(state);
+
+    envelope.load(state);
+    length.load(state);
+    state.get(duty, uint8_t(3));
+    state.get(step, uint8_t(7));
+    state.get(timer);
+    state.get(sweep);
+    state.get(negate);
+    state.get(reload);
+    state.get(period);
+    state.get(shift);
+    state.get(divider);
+}
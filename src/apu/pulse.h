@@ -0,0 +1,96 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PULSE_H
+#define PULSE_H
+
+#include "channel.h"
+#include "unit.h"
+
+//
+// Pulse channel
+//
+//      $4000 / $4004   DDLC VVVV   duty, halt, constant volume, volume
+//      $4001 / $4005   EPPP NSSS   sweep enable, period, negate, shift
+//      $4002 / $4006   TTTT TTTT   timer low
+//      $4003 / $4007   LLLL LTTT   length index, timer high
+//
+//      Timer is clocked every other CPU cycle and steps 8-step duty sequence.
+//
+
+class Pulse : public Channel
+{
+private:
+
+    // Pulse 1 negates sweep with ones' complement
+    bool first;
+
+    Envelope envelope;
+    Length length;
+
+    uint8_t  duty  = 0;
+    uint8_t  step  = 0;
+    uint16_t timer = 0;
+
+    // Sweep unit
+    bool    sweep   = false;
+    bool    negate  = false;
+    bool    reload  = false;
+    uint8_t period  = 0;
+    uint8_t shift   = 0;
+    uint8_t divider = 0;
+
+    /*
+        Sweep target period
+    */
+    uint16_t getTarget() const;
+
+    /*
+        Timer or sweep target is out of range
+    */
+    bool isMuted() const;
+
+    uint8_t getOutput() const;
+
+public:
+
+    Pulse(bool first);
+
+    /*
+        Write register 0 - 3
+    */
+    void write(uint8_t reg, uint8_t data);
+
+    /*
+        Quarter and half frame clocks
+    */
+    void quarter();
+    void half();
+
+    void setEnabled(bool enabled);
+    bool isActive() const;
+
+    /*
+        Write/Read channel state
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    void run(uint64_t end, Blip & blip);
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//
+// Lock-free single-producer/single-consumer ring buffer
+//
+//      Emulation thread pushes, audio sink pops. Each side owns one index
+//      and only reads the other one, so neither side ever waits: push stores
+//      what fits and pop takes what is there.
+//
+
+template <typename T, size_t Size>
+class Ring
+{
+private:
+
+    static_assert((Size & (Size - 1)) == 0, "Ring size must be a power of two");
+
+    std::array<T, Size> data {};
+
+    // Indices grow forever and are masked on access,
+    // padding keeps them on separate cache lines so both sides
+    // do not false share, alignas would pad the class (MSVC C4324)
+
+    std::atomic<size_t> head {0};
+    char padding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail {0};
+
+public:
+
+    /*
+        Push values, returns number of values stored
+        Producer side
+    */
+    size_t push(const T * values, size_t count)
+    {
+        auto h = head.load(std::memory_order_relaxed);
+        auto t = tail.load(std::memory_order_acquire);
+
+        if (count > Size - (h - t))
+            count = Size - (h - t);
+
+        for (size_t index = 0; index < count; index++) {
+            data[(h + index) & (Size - 1)] = values[index];
+        }
+
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    /*
+        Pop values, returns number of values taken
+        Consumer side
+    */
+    size_t pop(T * values, size_t count)
+    {
+        auto t = tail.load(std::memory_order_relaxed);
+        auto h = head.load(std::memory_order_acquire);
+
+        if (count > h - t)
+            count = h - t;
+
+        for (size_t index = 0; index < count; index++) {
+            values[index] = data[(t + index) & (Size - 1)];
+        }
+
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    /*
+        Number of values ready to pop
+    */
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
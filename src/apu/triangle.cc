@@ -0,0 +1,158 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "triangle.h"
+
+
+Triangle::Triangle() :
+    Channel (0.00851f)
+{ }
+
+
+/*
+    Write register 0 - 3
+*/
+void Triangle::write(uint8_t reg, uint8_t data)
+{
+    switch (reg)
+    {
+        case 0:
+            control = data & 0x80;
+            counter = data & 0x7F;
+            length.setHalt(control);
+            break;
+
+        case 2:
+            timer = (timer & 0x0700) | data;
+            break;
+
+        case 3:
+            timer = (timer & 0x00FF) | ((data & 0x07) << 8);
+            length.load(data >> 3);
+            reload = true;
+            break;
+    }
+}
+
+
+/*
+    Sequence 15 down to 0, then 0 up to 15
+*/
+uint8_t Triangle::getOutput() const
+{
+    return step < 16 ? 15 - step : step - 16;
+}
+
+
+/*
+    Quarter frame: linear counter
+*/
+void Triangle::quarter()
+{
+    if (reload) {
+        linear = counter;
+    } else if (linear > 0) {
+        linear--;
+    }
+
+    if (!control)
+        reload = false;
+}
+
+
+/*
+    Half frame: length counter
+*/
+void Triangle::half()
+{
+    length.clock();
+}
+
+
+void Triangle::setEnabled(bool enabled)
+{
+    length.setEnabled(enabled);
+}
+
+
+bool Triangle::isActive() const
+{
+    return length.isActive();
+}
+
+
+/*
+    Synthesize output up to CPU clock
+
+    Halted sequencer holds its level. Ultrasonic periods
+    are halted as well instead of producing inaudible noise.
+*/
+void Triangle::run(uint64_t end, Blip & blip)
+{
+    uint32_t cycles = timer + 1;
+
+    output(time, getOutput(), blip);
+
+    if (!length.isActive() || !linear || timer < 2)
+    {
+        skip(end, cycles);
+    }
+    else
+    {
+        for (; next <= end; next += cycles)
+        {
+            step = (step + 1) & 0x1F;
+            output(next, getOutput(), blip);
+        }
+    }
+
+    time = end;
+}
+
+
+/*
+    Write channel state
+*/
+void Triangle::save(State & state) const
+{
+    Channel::save(state);
+
+    length.save(state);
+    state.put(control);
+    state.put(reload);
+    state.put(counter);
+    state.put(linear);
+    state.put(step);
+    state.put(timer);
+}
+
+
+/*
+    Read channel state
+*/
+void Triangle::load(State & state)
+{
+    Channel::load(state);
+
+    length.load(state);
+    state.get(control);
+    state.get(reload);
+    state.get(counter);
+    state.get(linear);
+    state.get(step);
+    state.get(timer);
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIANGLE_H
+#define TRIANGLE_H
+
+#include "channel.h"
+#include "unit.h"
+
+//
+// Triangle channel
+//
+//      $4008   CRRR RRRR   control (length halt), linear counter reload
+//      $400A   TTTT TTTT   timer low
+//      $400B   LLLL LTTT   length index, timer high
+//
+//      Timer is clocked every CPU cycle and steps 32-step triangle sequence
+//      while both linear and length counters are non-zero.
+//
+
+class Triangle : public Channel
+{
+private:
+
+    Length length;
+
+    bool    control = false;
+    bool    reload  = false;
+    uint8_t counter = 0;
+    uint8_t linear  = 0;
+
+    uint8_t  step  = 0;
+    uint16_t timer = 0;
+
+    uint8_t getOutput() const;
+
+public:
+
+    Triangle();
+
+    /*
+        Write register 0 - 3
+    */
+    void write(uint8_t reg, uint8_t data);
+
+    /*
+        Quarter and half frame clocks
+    */
+    void quarter();
+    void half();
+
+    void setEnabled(bool enabled);
+    bool isActive() const;
+
+    /*
+        Write/Read channel state
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    void run(uint64_t end, Blip & blip);
+};
+
+#endif
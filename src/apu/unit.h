@@ -0,0 +1,195 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UNIT_H
+#define UNIT_H
+
+#include <cstdint>
+
+#include "state.h"
+
+//
+// Envelope generator
+//
+//      Decays volume from 15 to 0 once per quarter frame divided by period,
+//      optionally looping. Constant volume mode outputs period as volume.
+//
+
+class Envelope
+{
+private:
+
+    bool start    = false;
+    bool loop     = false;
+    bool constant = false;
+
+    uint8_t period  = 0;
+    uint8_t divider = 0;
+    uint8_t decay   = 0;
+
+public:
+
+    /*
+        Write --LC VVVV register
+    */
+    void write(uint8_t data)
+    {
+        loop     = data & 0x20;
+        constant = data & 0x10;
+        period   = data & 0x0F;
+    }
+
+    /*
+        Restart on length counter load
+    */
+    void restart() {
+        start = true;
+    }
+
+    /*
+        Quarter frame clock
+    */
+    void clock()
+    {
+        if (start)
+        {
+            start   = false;
+            decay   = 15;
+            divider = period;
+        }
+        else if (divider == 0)
+        {
+            divider = period;
+
+            if (decay > 0) {
+                decay--;
+            } else if (loop) {
+                decay = 15;
+            }
+        }
+        else
+        {
+            divider--;
+        }
+    }
+
+    uint8_t getVolume() const {
+        return constant ? period : decay;
+    }
+
+    /*
+        Write/Read state
+    */
+    void save(State & state) const
+    {
+        state.put(start);
+        state.put(loop);
+        state.put(constant);
+        state.put(period);
+        state.put(divider);
+        state.put(decay);
+    }
+
+    void load(State & state)
+    {
+        state.get(start);
+        state.get(loop);
+        state.get(constant);
+        state.get(period);
+        state.get(divider);
+        state.get(decay);
+    }
+};
+
+
+//
+// Length counter
+//
+//      Silences channel after loaded number of half frames
+//      unless halted. Disabled channel keeps counter at zero.
+//
+
+class Length
+{
+private:
+
+    bool enabled = false;
+    bool halt    = false;
+
+    uint8_t value = 0;
+
+public:
+
+    /*
+        Load counter from length table index
+    */
+    void load(uint8_t index)
+    {
+        static const uint8_t table[32] =
+        {
+            10, 254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
+            12,  16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30
+        };
+
+        if (enabled)
+            value = table[index & 0x1F];
+    }
+
+    void setEnabled(bool state)
+    {
+        enabled = state;
+
+        if (!enabled)
+            value = 0;
+    }
+
+    void setHalt(bool state) {
+        halt = state;
+    }
+
+    /*
+        Half frame clock
+    */
+    void clock()
+    {
+        if (value && !halt)
+            value--;
+    }
+
+    bool isActive() const {
+        return value > 0;
+    }
+
+    /*
+        Write/Read state
+    */
+    void save(State & state) const
+    {
+        state.put(enabled);
+        state.put(halt);
+        state.put(value);
+    }
+
+    void load(State & state)
+    {
+        state.get(enabled);
+        state.get(halt);
+        state.get(value);
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wav.h"
+
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+
+/*
+    Write value little-endian
+*/
+static void put(std::ofstream & file, uint32_t value, int bytes)
+{
+    for (int index = 0; index < bytes; index++) {
+        file.put(char((value >> (index * 8)) & 0xFF));
+    }
+}
+
+
+Wav::Wav(const std::string & path, uint32_t rate) :
+    file (path, std::ios::out | std::ios::binary),
+    rate (rate)
+{
+    if (!file.is_open())
+        throw std::runtime_error(fmt::format("Unable to create {}", path));
+
+    header();
+}
+
+
+Wav::~Wav()
+{
+    file.seekp(0);
+    header();
+}
+
+
+/*
+    Write RIFF header for current sample count
+*/
+void Wav::header()
+{
+    uint32_t bytes = count * 2;
+
+    file.write("RIFF", 4);
+    put(file, 36 + bytes, 4);
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    put(file, 16, 4);       // chunk size
+    put(file, 1, 2);        // PCM
+    put(file, 1, 2);        // mono
+    put(file, rate, 4);
+    put(file, rate * 2, 4); // byte rate
+    put(file, 2, 2);        // block align
+    put(file, 16, 2);       // bits per sample
+
+    file.write("data", 4);
+    put(file, bytes, 4);
+}
+
+
+/*
+    Append samples
+*/
+void Wav::write(const int16_t * samples, size_t size)
+{
+    for (size_t index = 0; index < size; index++) {
+        put(file, uint16_t(samples[index]), 2);
+    }
+
+    count += size;
+}
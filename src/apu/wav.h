@@ -0,0 +1,61 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WAV_H
+#define WAV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+//
+// WAV file writer, mono 16-bit PCM
+//
+//      Header sizes are patched when writer is destroyed.
+//
+
+class Wav
+{
+private:
+
+    std::ofstream file;
+
+    uint32_t rate;
+    uint32_t count = 0;
+
+    /*
+        Write RIFF header for current sample count
+    */
+    void header();
+
+public:
+
+    Wav(const std::string & path, uint32_t rate);
+
+    Wav(const Wav &) = delete;
+    Wav & operator= (const Wav &) = delete;
+
+    ~Wav();
+
+    /*
+        Append samples
+    */
+    void write(const int16_t * samples, size_t size);
+};
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch.h"
+#include "pool.h"
+#include "machine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+
+/*
+    JSON string literal
+*/
+static std::string quote(const std::string & text)
+{
+    std::string out = "\"";
+
+    for (char symbol : text)
+    {
+        if (symbol == '"' || symbol == '\\') {
+            out += '\\';
+            out += symbol;
+        } else if (static_cast<uint8_t>(symbol) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<int>(symbol));
+        } else {
+            out += symbol;
+        }
+    }
+
+    return out + "\"";
+}
+
+
+/*
+    Read manifest
+*/
+Batch::Batch(const std::string & manifest, uint64_t cycles, Cpu::Engine engine) : engine(engine)
+{
+    std::ifstream file(manifest);
+
+    if (!file.is_open())
+        throw std::runtime_error(fmt::format("File not found {}", manifest));
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+
+        Job job { "", cycles };
+
+        if (!(fields >> job.path) || job.path[0] == '#')
+            continue;
+
+        if (!(fields >> job.cycles))
+            job.cycles = cycles;
+
+        jobs.push_back(job);
+    }
+}
+
+
+/*
+    Print report line
+*/
+void Batch::report(const std::string & line)
+{
+    std::lock_guard<std::mutex> guard(output);
+
+    fmt::print("{}\n", line);
+    std::fflush(stdout);
+}
+
+
+/*
+    Run all jobs
+*/
+void Batch::run(unsigned threads)
+{
+    Pool pool(threads);
+
+    std::atomic<uint64_t> instructions { 0 };
+    std::atomic<uint32_t> failed { 0 };
+
+    for (size_t index = 0; index < jobs.size(); index++)
+    {
+        pool.submit([this, index, &instructions, &failed]
+        {
+            auto & job = jobs[index];
+            auto start = std::chrono::steady_clock::now();
+
+            try
+            {
+                // Whole instance in one allocation rather than on worker stack
+                auto machine = std::make_unique<Machine>(job.path);
+
+                auto & cpu = machine -> getCpu();
+                cpu.setEngine(engine);
+
+                auto stop = machine -> run(cpu.getCycles() + job.cycles);
+
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                instructions += cpu.getCounter();
+
+                report(fmt::format(
+                    "{{\"job\": {}, \"rom\": {}, \"stop\": \"{}\", \"pc\": {}, \"cycles\": {}, "
+                    "\"instructions\": {}, \"frames\": {}, \"seconds\": {:.6f}}}",
+                    index, quote(job.path), Cpu::getReason(stop), cpu.getPc(), cpu.getCycles(),
+                    cpu.getCounter(), machine -> getFrames(), elapsed.count()));
+            }
+            catch (const std::exception & e)
+            {
+                failed++;
+
+                report(fmt::format("{{\"job\": {}, \"rom\": {}, \"error\": {}}}",
+                    index, quote(job.path), quote(e.what())));
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pool.run();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    report(fmt::format(
+        "{{\"jobs\": {}, \"failed\": {}, \"threads\": {}, \"instructions\": {}, "
+        "\"seconds\": {:.6f}, \"instructions_per_second\": {:.0f}}}",
+        jobs.size(), failed.load(), pool.size(), instructions.load(),
+        elapsed.count(), instructions.load() / elapsed.count()));
+}
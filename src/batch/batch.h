@@ -0,0 +1,82 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cpu/cpu.h"
+
+//
+// Batch runner
+//
+//      Runs every job of a manifest in its own Machine on a work-stealing
+//      Pool and reports one JSON line per job as it completes, followed
+//      by a summary line with aggregate instructions per second.
+//
+//      Manifest holds one job per line: ROM path (iNES image or raw
+//      binary) and optional cycle budget. Blank lines and lines starting
+//      with # are skipped. Every job runs on the same dispatch engine.
+//
+//          {"job": 0, "rom": "a.nes", "stop": "budget", "pc": 49178, "cycles": 1000000,
+//           "instructions": 331021, "frames": 33, "seconds": 0.004}
+//          {"job": 1, "rom": "b.bin", "error": "File not found b.bin"}
+//          {"jobs": 2, "failed": 1, "threads": 8, "instructions": 331021,
+//           "seconds": 0.004, "instructions_per_second": 82755250}
+//
+
+class Batch
+{
+private:
+
+    struct Job
+    {
+        std::string path;
+        uint64_t cycles;
+    };
+
+    std::vector<Job> jobs;
+
+    // Dispatch engine of job CPUs
+    Cpu::Engine engine;
+
+    // Serializes report lines of workers
+    std::mutex output;
+
+    /*
+        Print report line
+    */
+    void report(const std::string & line);
+
+public:
+
+    /*
+        Read manifest, cycles is budget of jobs without one
+    */
+    Batch(const std::string & manifest, uint64_t cycles, Cpu::Engine engine);
+
+    /*
+        Run all jobs on threads workers
+    */
+    void run(unsigned threads);
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pool.h"
+
+#include <algorithm>
+#include <thread>
+
+
+/*
+    Create worker queues
+*/
+Pool::Pool(unsigned workers)
+{
+    for (unsigned index = 0; index < std::max(workers, 1u); index++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+}
+
+
+/*
+    Queue task round-robin
+*/
+void Pool::submit(std::function<void()> task)
+{
+    auto & queue = *queues[next];
+
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    next = (next + 1) % queues.size();
+}
+
+
+/*
+    Take task from front of own queue,
+    otherwise steal from back of next non-empty one
+*/
+bool Pool::take(size_t worker, std::function<void()> & task)
+{
+    for (size_t offset = 0; offset < queues.size(); offset++)
+    {
+        auto & queue = *queues[(worker + offset) % queues.size()];
+
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if (queue.tasks.empty())
+            continue;
+
+        if (offset == 0)
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+/*
+    Worker loop
+*/
+void Pool::work(size_t worker)
+{
+    std::function<void()> task;
+
+    while (take(worker, task)) {
+        task();
+    }
+}
+
+
+/*
+    Run tasks on all workers
+*/
+void Pool::run()
+{
+    std::vector<std::thread> threads;
+
+    for (size_t worker = 1; worker < queues.size(); worker++) {
+        threads.emplace_back(&Pool::work, this, worker);
+    }
+
+    work(0);
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
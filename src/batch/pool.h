@@ -0,0 +1,88 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//
+// Work-stealing thread pool
+//
+//      Every worker owns a queue of tasks. It takes work from the front
+//      of its own queue and, once that is empty, steals from the back of
+//      the others, so a worker stuck on a long job does not hold up the
+//      jobs queued behind it.
+//
+//      Tasks are submitted before run() and do not submit new ones,
+//      so a worker finishes as soon as every queue is empty.
+//
+
+class Pool
+{
+private:
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    // Queue of next submitted task
+    size_t next = 0;
+
+    /*
+        Take task from own queue or steal one
+        Returns false when all queues are empty
+    */
+    bool take(size_t worker, std::function<void()> & task);
+
+    /*
+        Run tasks of worker until all queues are empty
+    */
+    void work(size_t worker);
+
+public:
+
+    /*
+        Pool of workers, at least one
+    */
+    explicit Pool(unsigned workers);
+
+    /*
+        Queue task, tasks are spread over workers round-robin
+    */
+    void submit(std::function<void()> task);
+
+    /*
+        Run all tasks, calling thread is one of workers
+    */
+    void run();
+
+    size_t size() const {
+        return queues.size();
+    }
+};
+
+#endif
@@ -15,19 +15,268 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "bus.h"
+#include "state.h"
 
 #include "fmt/core.h"
 #include "fmt/color.h"
 
-uint8_t Bus::read (uint16_t index) const {
-    return ram[index];
+/*
+    Map whole address space to RAM
+*/
+Bus::Bus() : memory(std::make_unique<Memory>())
+{
+    for (unsigned index = 0; index < ram.size(); index++) {
+        ram[index] = &(*memory)[index];
+    }
+
+    mirror(0x00, 0xFF, 0x00);
+}
+
+
+/*
+    Share RAM blocks of parent
+    Blocks owned by parent are frozen, so both buses
+    copy a block before writing it from now on
+*/
+Bus::Bus(Bus & parent, std::nullptr_t) : ram(parent.ram)
+{
+    // Nothing owned since last fork, parent RAM is frozen already
+    if (parent.memory || !parent.copies.empty())
+    {
+        auto node = std::make_shared<Frozen>();
+
+        node -> base   = std::move(parent.frozen);
+        node -> memory = std::move(parent.memory);
+        node -> copies = std::move(parent.copies);
+
+        parent.frozen = std::move(node);
+        parent.copies.clear();
+    }
+
+    frozen = parent.frozen;
+
+    parent.shared.set();
+    shared.set();
+
+    for (unsigned index = 0; index < pages.size(); index++)
+    {
+        auto & page = parent.pages[index];
+
+        if (page.block >= 0)
+        {
+            pages[index] = page;
+            pages[index].write = nullptr;
+
+            page.write = nullptr;
+        }
+    }
+}
+
+
+/*
+    Fork bus
+*/
+std::unique_ptr<Bus> Bus::fork()
+{
+    return std::unique_ptr<Bus>(new Bus(*this, nullptr));
+}
+
+
+/*
+    Copy shared block and remap pages on it
+*/
+Bus::Block & Bus::own(uint8_t block)
+{
+    if (shared[block])
+    {
+        copies.push_back(std::make_unique<Block>(*ram[block]));
+
+        ram[block] = copies.back().get();
+        shared[block] = false;
+
+        for (auto & page : pages)
+        {
+            if (page.block == block)
+            {
+                page.read  = ram[block] -> data();
+                page.write = ram[block] -> data();
+            }
+        }
+    }
+
+    return *ram[block];
 }
 
-void Bus::write (uint16_t index, uint8_t data) {
-    ram[index] = data;
+
+/*
+    Write to shared block
+*/
+void Bus::copy(uint16_t index, uint8_t data)
+{
+    uint8_t block = pages[index >> 8].block;
+
+    own(block)[index & 0xFF] = data;
+
+    if (watched[block])
+        release(block);
 }
 
+
+/*
+    Stop watching block, pages on it get write pointer back
+*/
+void Bus::release(uint8_t block)
+{
+    watched[block] = false;
+
+    for (auto & page : pages)
+    {
+        if (page.block == block)
+            page.write = shared[block] ? nullptr : ram[block] -> data();
+    }
+
+    for (auto watcher : watchers) {
+        watcher -> written(block);
+    }
+}
+
+
+/*
+    Add observer of watched blocks
+*/
+void Bus::addWatcher(Watcher * watcher)
+{
+    watchers.push_back(watcher);
+}
+
+
+/*
+    Remove observer of watched blocks
+*/
+void Bus::removeWatcher(Watcher * watcher)
+{
+    watchers.erase(std::remove(watchers.begin(), watchers.end(), watcher), watchers.end());
+}
+
+
+/*
+    Watch RAM block behind page
+*/
+bool Bus::watch(uint8_t index)
+{
+    if (pages[index].block < 0)
+        return false;
+
+    uint8_t block = pages[index].block;
+
+    if (!watched[block])
+    {
+        watched[block] = true;
+
+        for (auto & page : pages)
+        {
+            if (page.block == block)
+                page.write = nullptr;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+    Map pages to host memory
+*/
+void Bus::map (uint8_t first, uint8_t last, const uint8_t * read, uint8_t * write, Device * device)
+{
+    for (unsigned index = first; index <= last; index++)
+    {
+        auto offset = (index - first) << 8;
+        auto & page = pages[index];
+
+        page.read   = read  ? read  + offset : nullptr;
+        page.write  = write ? write + offset : nullptr;
+        page.device = device;
+        page.block  = -1;
+    }
+}
+
+/*
+    Map pages to memory mapped device
+*/
+void Bus::map (uint8_t first, uint8_t last, Device * device)
+{
+    map(first, last, nullptr, nullptr, device);
+}
+
+/*
+    Map pages to RAM blocks
+*/
+void Bus::mirror (uint8_t first, uint8_t last, uint8_t source)
+{
+    for (unsigned index = first; index <= last; index++)
+    {
+        uint8_t block = source + (index - first);
+        auto & page = pages[index];
+
+        page.read   = ram[block] -> data();
+        page.write  = (shared[block] || watched[block]) ? nullptr : ram[block] -> data();
+        page.device = nullptr;
+        page.block  = block;
+    }
+}
+
+
+/*
+    Write bytes to RAM
+*/
+void Bus::poke (uint16_t address, const uint8_t * bytes, size_t size)
+{
+    for (size_t index = 0; index < size; index++, address++)
+    {
+        uint8_t block = address >> 8;
+
+        own(block)[address & 0xFF] = bytes[index];
+
+        if (watched[block])
+            release(block);
+    }
+}
+
+
+/*
+    Write RAM
+*/
+void Bus::save(State & state) const
+{
+    state.mark("BUS ");
+
+    for (auto block : ram) {
+        state.put(*block);
+    }
+}
+
+
+/*
+    Read RAM
+*/
+void Bus::load(State & state)
+{
+    state.check("BUS ");
+
+    for (unsigned index = 0; index < ram.size(); index++)
+    {
+        state.get(own(index));
+
+        if (watched[index])
+            release(index);
+    }
+}
+
+
 /*
     Print memory dump from custom range
     Default: 0x00 - 0xFF
@@ -19,40 +19,235 @@
 #define BUS_HPP
 
 #include <array>
+#include <bitset>
+#include <memory>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 
+#include "device.h"
+#include "watcher.h"
+
+class State;
+class Jit;
+class Aot;
+class Decoder;
+class Lockstep;
+class PageTracker;
+class Machine;
+
+//
+// Memory bus
+//
+//      Address space is split into 256 pages of 256 bytes. Each page
+//      points either directly to host memory (RAM, ROM) or to a device
+//      handling memory mapped I/O, so ordinary memory access is a single
+//      table lookup and devices pay for a virtual call only on their own pages.
+//
+//      RAM is kept in 256-byte blocks, so a forked bus shares all blocks
+//      with its parent. Shared pages are mapped without write pointer and
+//      the first write to one copies its block, forking costs the page
+//      table and then one block per page touched by either side.
+//
+//      Watched blocks are mapped without write pointer as well, so only
+//      writes to them take the slow path and notify the watchers.
+//
+
 class Bus
 {
 private:
-    using memory = std::array<uint8_t, 64 * 1024>;
 
-    // Temporary 64KB RAM
-    memory ram {};
+    friend class Jit;
+    friend class Aot;
+    friend class Decoder;
+    friend class Lockstep;
+    friend class PageTracker;
+    friend class Machine;
+
+    using Block = std::array<uint8_t, 256>;
+
+    /*
+        Memory page descriptor
+    */
+    struct Page
+    {
+        // Host memory to read from, nullptr if handled by device
+        const uint8_t * read = nullptr;
+
+        // Host memory to write to, nullptr if read-only or handled by device
+        uint8_t * write = nullptr;
+
+        // Memory mapped I/O device
+        Device * device = nullptr;
+
+        // RAM block behind page, -1 for host memory or device
+        int16_t block = -1;
+    };
+
+    using Memory = std::array<Block, 256>;
+
+    //
+    // RAM frozen by fork
+    //
+    //      Blocks owned by a bus move here when it is forked, so they
+    //      outlive the bus while any fork still reads them. Frozen RAM
+    //      of earlier forks is kept alive through base.
+    //
+
+    struct Frozen
+    {
+        std::shared_ptr<const Frozen> base;
+
+        std::unique_ptr<Memory> memory;
+        std::vector<std::unique_ptr<Block>> copies;
+    };
+
+    // Current block of each 256-byte RAM page
+    std::array<Block *, 256> ram {};
+
+    // Block is frozen and must be copied before write
+    std::bitset<256> shared;
+
+    // Initial 64KB RAM, null once frozen
+    std::unique_ptr<Memory> memory;
+
+    // Blocks copied since last fork
+    std::vector<std::unique_ptr<Block>> copies;
+
+    // RAM shared with forks
+    std::shared_ptr<const Frozen> frozen;
+
+    // Page table
+    std::array<Page, 256> pages {};
+
+    // Block is watched, first change notifies watchers
+    std::bitset<256> watched;
+
+    // Observers of watched blocks
+    std::vector<Watcher *> watchers;
+
+    /*
+        Share RAM blocks of parent, devices are not mapped
+    */
+    Bus(Bus & parent, std::nullptr_t);
+
+    /*
+        Copy shared block before write
+        Returns block owned by this bus
+    */
+    Block & own(uint8_t block);
+
+    /*
+        Write to page mapped on shared or watched block
+    */
+    void copy(uint16_t index, uint8_t data);
+
+    /*
+        Stop watching changed block and notify watchers
+    */
+    void release(uint8_t block);
 
 public:
 
+    /*
+        Map whole address space to RAM
+    */
+    Bus();
+
+    Bus(const Bus &) = delete;
+    Bus & operator= (const Bus &) = delete;
+
     /*
         Read byte on address
     */
-    uint8_t read (uint16_t index) const;
+    uint8_t read (uint16_t index) const
+    {
+        auto & page = pages[index >> 8];
+
+        if (page.read)
+            return page.read[index & 0xFF];
+
+        if (page.device)
+            return page.device -> read(index);
+
+        return 0x00;
+    }
     
     /*
         Write byte on address
     */
-    void write (uint16_t index, uint8_t data);
+    void write (uint16_t index, uint8_t data)
+    {
+        auto & page = pages[index >> 8];
+
+        if (page.write) {
+            page.write[index & 0xFF] = data;
+        } else if (page.device) {
+            page.device -> write(index, data);
+        } else if (page.block >= 0) {
+            copy(index, data);
+        }
+    }
+
+    /*
+        Page is mapped to host memory
+    */
+    bool isMemory (uint8_t page) const {
+        return pages[page].read;
+    }
+
+    /*
+        Map pages to host memory
+        Access without host memory pointer goes to device if any,
+        e.g. ROM with mapper registers is read directly and written to mapper
+    */
+    void map (uint8_t first, uint8_t last, const uint8_t * read, uint8_t * write, Device * device = nullptr);
+
+    /*
+        Map pages to memory mapped device
+    */
+    void map (uint8_t first, uint8_t last, Device * device);
+
+    /*
+        Map pages to RAM blocks starting at source block,
+        e.g. mirrors of 2KB internal RAM
+    */
+    void mirror (uint8_t first, uint8_t last, uint8_t source);
+
+    /*
+        Write bytes to RAM blocks bypassing devices and ROM
+    */
+    void poke (uint16_t address, const uint8_t * bytes, size_t size);
+
+    /*
+        Add/Remove observer of watched blocks
+    */
+    void addWatcher (Watcher * watcher);
+    void removeWatcher (Watcher * watcher);
+
+    /*
+        Watch RAM block behind page until it is changed
+        Returns false if page is not mapped to RAM
+    */
+    bool watch (uint8_t page);
+
+    /*
+        New bus sharing RAM copy-on-write with this one
+        Only RAM pages are mapped on it, caller attaches its own
+        devices and cartridge since those are not forked
+    */
+    std::unique_ptr<Bus> fork();
 
     /*
         Print memory dump
     */
     void printDump (uint16_t from = 0x00, uint16_t to = 0xFF) const;
 
-    memory::iterator begin() {
-        return ram.begin();
-    }
-    
-    memory::size_type size() {
-        return ram.size();
-    }
+    /*
+        Write/Read RAM, page table is wiring and is kept
+    */
+    void save (State & state) const;
+    void load (State & state);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <cstdint>
+
+//
+// Memory mapped device
+// Receives bus access for pages it is mapped on
+//
+
+class Device
+{
+public:
+
+    /*
+        Read byte on address
+    */
+    virtual uint8_t read (uint16_t index) = 0;
+
+    /*
+        Write byte on address
+    */
+    virtual void write (uint16_t index, uint8_t data) = 0;
+
+    virtual ~Device() = default;
+};
+
+#endif
\ No newline at end of file
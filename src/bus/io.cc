@@ -0,0 +1,52 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "io.h"
+
+
+/*
+    Attach device to register range
+*/
+void Io::attach (uint16_t first, uint16_t last, Device * device)
+{
+    for (uint16_t index = first; index <= last; index++) {
+        devices[index & 0x1F] = device;
+    }
+}
+
+
+/*
+    Read register
+*/
+uint8_t Io::read (uint16_t index)
+{
+    if (index < 0x4020 && devices[index & 0x1F])
+        return devices[index & 0x1F] -> read(index);
+
+    return 0x00;
+}
+
+
+/*
+    Write register
+*/
+void Io::write (uint16_t index, uint8_t data)
+{
+    if (index < 0x4020 && devices[index & 0x1F]) {
+        devices[index & 0x1F] -> write(index, data);
+    }
+}
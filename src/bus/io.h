@@ -0,0 +1,58 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IO_H
+#define IO_H
+
+#include <array>
+#include <cstdint>
+
+#include "device.h"
+
+//
+// I/O registers $4000 - $401F
+//
+//      APU, OAM DMA and controller registers share one bus page,
+//      so accesses are dispatched to devices register by register.
+//
+
+class Io : public Device
+{
+private:
+
+    // Device per register
+    std::array<Device *, 0x20> devices {};
+
+public:
+
+    /*
+        Attach device to register range
+    */
+    void attach (uint16_t first, uint16_t last, Device * device);
+
+    /*
+        Read register, unassigned registers read as zero
+    */
+    uint8_t read (uint16_t index) override;
+
+    /*
+        Write register, unassigned registers ignore writes
+    */
+    void write (uint16_t index, uint8_t data) override;
+};
+
+#endif
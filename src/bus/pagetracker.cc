@@ -0,0 +1,113 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pagetracker.h"
+
+// Writes dropping pages of RAM block before it is no longer validated
+static constexpr uint16_t churn = 64;
+
+// Lookups without write halving rewrites of RAM block
+static constexpr uint16_t decay = 4096;
+
+
+/*
+    Watch bus for writes to validated RAM
+*/
+PageTracker::PageTracker(Bus & bus) : bus(bus)
+{
+    bus.addWatcher(this);
+}
+
+
+PageTracker::~PageTracker()
+{
+    bus.removeWatcher(this);
+}
+
+
+/*
+    Validate page, drops it first if its host memory changed
+
+    Pages of host memory writable behind the bus, e.g. cartridge RAM,
+    and RAM rewritten too often are left to the interpreter. Block left
+    there is watched once its lookups reach decay and decays only if
+    no write reset them by the next round.
+*/
+bool PageTracker::validate (uint8_t index)
+{
+    auto & page = bus.pages[index];
+
+    if (!page.read)
+        return false;
+
+    if (page.block >= 0 && ++lookups[page.block] >= decay)
+    {
+        lookups[page.block] = 0;
+
+        if (rewrites[page.block] < churn || probed[page.block])
+        {
+            rewrites[page.block] >>= 1;
+        }
+        else
+        {
+            probed[page.block] = true;
+            bus.watch(index);
+        }
+    }
+
+    if (isValid(index))
+        return true;
+
+    if (page.block >= 0)
+    {
+        if (rewrites[page.block] >= churn)
+            return false;
+
+        bus.watch(index);
+    }
+    else if (page.write)
+    {
+        return false;
+    }
+
+    drop(index);
+    hosts[index] = page.read;
+
+    return true;
+}
+
+
+/*
+    Drop pages of written RAM block
+*/
+void PageTracker::written (uint8_t block)
+{
+    for (unsigned index = 0; index < bus.pages.size(); index++)
+    {
+        if (hosts[index] && bus.pages[index].block == block)
+        {
+            drop(index);
+            hosts[index] = nullptr;
+        }
+    }
+
+    if (rewrites[block] < churn)
+        rewrites[block]++;
+
+    lookups[block] = 0;
+    probed[block] = false;
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAGETRACKER_H
+#define PAGETRACKER_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+#include "bus.h"
+#include "watcher.h"
+
+//
+// Page validity tracker
+//
+//      Base of engines keeping work derived from memory pages, e.g.
+//      decoded commands or translated blocks. A page is valid while it
+//      has the host memory it was validated against and no write pointer.
+//
+//      Validating a RAM page watches its block on Bus, so the first write
+//      to it drops the page. RAM blocks rewritten too often, e.g. holding
+//      data next to code, are not validated and stay with the interpreter.
+//      Rewrites decay while the block is looked up without being written,
+//      so code patched once in a while, e.g. on level load, is taken back.
+//      Rejected blocks are watched for one round of lookups before decay,
+//      so their writes are counted at the cost of one slow write per round.
+//
+
+class PageTracker : public Watcher
+{
+protected:
+
+    Bus & bus;
+
+    // Host memory page was validated against, nullptr if none
+    std::array<const uint8_t *, 256> hosts {};
+
+    // Writes to RAM block that dropped its pages
+    std::array<uint16_t, 256> rewrites {};
+
+    // Lookups of RAM block pages since its last write
+    std::array<uint16_t, 256> lookups {};
+
+    // Rejected RAM block is watched for writes until next decay
+    std::bitset<256> probed;
+
+    /*
+        Page still has host memory it was validated against
+    */
+    bool isValid (uint8_t index) const
+    {
+        auto & page = bus.pages[index];
+        return hosts[index] == page.read && !page.write;
+    }
+
+    /*
+        Validate page, drops it first if its host memory changed
+        Returns false if page is not memory or is left to the interpreter
+    */
+    bool validate (uint8_t index);
+
+    /*
+        Drop work derived from page
+    */
+    virtual void drop (uint8_t index) = 0;
+
+public:
+
+    PageTracker(Bus & bus);
+
+    PageTracker(const PageTracker &) = delete;
+    PageTracker & operator= (const PageTracker &) = delete;
+
+    /*
+        Drop pages of written RAM block
+    */
+    void written (uint8_t block) override;
+
+    ~PageTracker();
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cart.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+
+/*
+    Load cartridge from file
+*/
+Cart::Cart(const std::string & path) : image(std::make_shared<const Image>(path))
+{
+    parse();
+}
+
+
+/*
+    Returns true if file starts with iNES signature
+*/
+bool Cart::isCart(const std::string & path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    char magic[4] {};
+    file.read(magic, sizeof(magic));
+
+    return file && magic[0] == 'N' && magic[1] == 'E' && magic[2] == 'S' && magic[3] == 0x1A;
+}
+
+
+/*
+    Parse header and locate PRG/CHR data
+
+    +------+--------------------------------------------------+
+    | byte | content                                          |
+    +------+--------------------------------------------------+
+    | 0-3  | "NES" $1A                                        |
+    | 4    | PRG ROM size LSB in 16KB units                   |
+    | 5    | CHR ROM size LSB in 8KB units                    |
+    | 6    | NNNN FTBM mapper D0..D3, four-screen, trainer,   |
+    |      |           battery, mirroring (1 - vertical)      |
+    | 7    | NNNN 10TT mapper D4..D7, NES 2.0 identifier      |
+    | 8    | SSSS NNNN submapper, mapper D8..D11  (NES 2.0)   |
+    | 9    | CCCC PPPP CHR/PRG ROM size MSB       (NES 2.0)   |
+    | 10   | pppp PPPP PRG NVRAM/RAM shift count  (NES 2.0)   |
+    +------+--------------------------------------------------+
+*/
+void Cart::parse()
+{
+    auto & rom = *image;
+
+    if (rom.size() < header || rom[0] != 'N' || rom[1] != 'E' || rom[2] != 'S' || rom[3] != 0x1A)
+        throw std::runtime_error("Invalid iNES header");
+
+    uint8_t flags6 = rom[6];
+    uint8_t flags7 = rom[7];
+
+    nes2    = (flags7 & 0x0C) == 0x08;
+    battery = flags6 & 0x02;
+    mapper  = (flags6 >> 4) | (flags7 & 0xF0);
+
+    if (flags6 & 0x08) {
+        mirroring = Mirroring::FourScreen;
+    } else {
+        mirroring = (flags6 & 0x01) ? Mirroring::Vertical : Mirroring::Horizontal;
+    }
+
+    uint32_t ram = 8 * 1024;
+
+    // Sizes are decoded wide, exponent notation overflows 32 bits
+    uint64_t prgBytes;
+    uint64_t chrBytes;
+
+    if (nes2)
+    {
+        mapper   |= (rom[8] & 0x0F) << 8;
+        submapper = rom[8] >> 4;
+
+        prgBytes = getSize(rom[4], rom[9] & 0x0F, 16 * 1024);
+        chrBytes = getSize(rom[5], rom[9] >> 4,   8 * 1024);
+
+        // Volatile and battery-backed RAM, 64 << shift bytes each
+        uint32_t volatileRam = (rom[10] & 0x0F) ? 64 << (rom[10] & 0x0F) : 0;
+        uint32_t batteryRam  = (rom[10] >> 4)   ? 64 << (rom[10] >> 4)   : 0;
+
+        if (volatileRam + batteryRam > 0)
+            ram = volatileRam + batteryRam;
+    }
+    else
+    {
+        prgBytes = rom[4] * 16 * 1024;
+        chrBytes = rom[5] * 8 * 1024;
+    }
+
+    // Mappers switch PRG in 8KB and CHR in 1KB banks
+    if (prgBytes % (8 * 1024) || chrBytes % 1024)
+        throw std::runtime_error("PRG/CHR ROM size is not a multiple of bank");
+
+    uint64_t offset = header;
+
+    prgRam.assign(ram < 8 * 1024 ? 8 * 1024 : ram, 0x00);
+
+    // Trainer is loaded to $7000 - $71FF
+    if (flags6 & 0x04)
+    {
+        if (rom.size() < offset + trainer)
+            throw std::runtime_error("Truncated trainer");
+
+        std::copy(rom.data() + offset, rom.data() + offset + trainer, prgRam.begin() + 0x1000);
+        offset += trainer;
+    }
+
+    if (prgBytes == 0 || rom.size() < offset + prgBytes + chrBytes)
+        throw std::runtime_error("Truncated PRG/CHR ROM");
+
+    // Banks are wrapped by signed size, larger images are not real cartridges
+    if (prgBytes > INT32_MAX || chrBytes > INT32_MAX)
+        throw std::runtime_error("ROM size out of range");
+
+    prgSize = (uint32_t) prgBytes;
+    chrSize = (uint32_t) chrBytes;
+
+    prg = rom.data() + offset;
+    chr = chrSize ? rom.data() + offset + prgSize : nullptr;
+
+    // Cartridge without CHR ROM has 8KB CHR RAM
+    if (chrSize == 0)
+        chrRam.assign(8 * 1024, 0x00);
+}
+
+
+/*
+    Decode NES 2.0 ROM size
+    MSB nibble $F means exponent-multiplier notation: 2^E * (MM * 2 + 1)
+*/
+uint64_t Cart::getSize(uint8_t lsb, uint8_t msb, uint32_t unit)
+{
+    if (msb == 0x0F)
+    {
+        uint32_t exponent   = lsb >> 2;
+        uint32_t multiplier = (lsb & 0x03) * 2 + 1;
+
+        if (exponent > 30)
+            throw std::runtime_error("ROM size out of range");
+
+        return (uint64_t(1) << exponent) * multiplier;
+    }
+
+    return uint64_t((msb << 8) | lsb) * unit;
+}
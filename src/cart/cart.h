@@ -0,0 +1,166 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CART_H
+#define CART_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image.h"
+
+//
+// Nametable mirroring
+//
+
+enum class Mirroring : uint8_t
+{
+    Horizontal,
+    Vertical,
+    SingleLow,
+    SingleHigh,
+    FourScreen
+};
+
+//
+// Cartridge
+//
+//      Parses iNES and NES 2.0 image and keeps PRG/CHR data.
+//      Banks are never copied, mappers point into mapped image.
+//      Copies of cartridge, e.g. of forked machine, share the image
+//      and have own cartridge RAM.
+//
+
+class Cart
+{
+private:
+
+    /*
+        iNES header size
+    */
+    static const uint32_t header = 16;
+
+    /*
+        Trainer size, loaded to $7000
+    */
+    static const uint32_t trainer = 512;
+
+    // Whole ROM image, memory mapped
+    std::shared_ptr<const Image> image;
+
+    // PRG ROM inside image
+    const uint8_t * prg = nullptr;
+    uint32_t prgSize = 0;
+
+    // CHR ROM inside image
+    const uint8_t * chr = nullptr;
+    uint32_t chrSize = 0;
+
+    // CHR RAM if cartridge has no CHR ROM
+    std::vector<uint8_t> chrRam;
+
+    // PRG RAM at $6000 - $7FFF
+    std::vector<uint8_t> prgRam;
+
+    uint16_t mapper = 0;
+    uint8_t submapper = 0;
+
+    Mirroring mirroring = Mirroring::Horizontal;
+
+    bool battery = false;
+    bool nes2 = false;
+
+    /*
+        Parse header and locate PRG/CHR data
+    */
+    void parse();
+
+    /*
+        Decode NES 2.0 ROM size
+    */
+    static uint64_t getSize(uint8_t lsb, uint8_t msb, uint32_t unit);
+
+public:
+
+    /*
+        Load cartridge from file
+    */
+    Cart(const std::string & path);
+
+    /*
+        Returns true if file starts with iNES signature
+    */
+    static bool isCart(const std::string & path);
+
+    const uint8_t * getPrg() const {
+        return prg;
+    }
+
+    uint32_t getPrgSize() const {
+        return prgSize;
+    }
+
+    /*
+        Returns CHR ROM or CHR RAM
+    */
+    const uint8_t * getChr() const {
+        return chrSize ? chr : chrRam.data();
+    }
+
+    uint32_t getChrSize() const {
+        return chrSize ? chrSize : (uint32_t) chrRam.size();
+    }
+
+    /*
+        Returns writable CHR memory, nullptr for CHR ROM
+    */
+    uint8_t * getChrRam() {
+        return chrSize ? nullptr : chrRam.data();
+    }
+
+    uint8_t * getPrgRam() {
+        return prgRam.data();
+    }
+
+    uint32_t getPrgRamSize() const {
+        return (uint32_t) prgRam.size();
+    }
+
+    uint16_t getMapper() const {
+        return mapper;
+    }
+
+    uint8_t getSubmapper() const {
+        return submapper;
+    }
+
+    Mirroring getMirroring() const {
+        return mirroring;
+    }
+
+    bool hasBattery() const {
+        return battery;
+    }
+
+    bool isNes2() const {
+        return nes2;
+    }
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cnrom.h"
+
+
+/*
+    Map initial banks
+*/
+void Cnrom::reset()
+{
+    mapPrg(0x8000, 0x4000, 0);
+    mapPrg(0xC000, 0x4000, -0x4000);
+
+    mapChr(0, 8, 0);
+}
+
+
+/*
+    Select 8KB CHR ROM bank
+*/
+void Cnrom::write(uint16_t, uint8_t data)
+{
+    mapChr(0, 8, data * 0x2000);
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CNROM_H
+#define CNROM_H
+
+#include "mapper.h"
+
+//
+// CNROM (mapper 3)
+//
+//      $8000 - $FFFF   16KB or 32KB PRG ROM (fixed)
+//      $8000 - $FFFF   Bank select register (write)
+//      PPU $0000       Switchable 8KB CHR ROM bank
+//
+
+class Cnrom : public Mapper
+{
+protected:
+
+    void reset() override;
+
+public:
+
+    using Mapper::Mapper;
+
+    void write(uint16_t index, uint8_t data) override;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "image.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+#ifndef WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+
+/*
+    Open image file
+*/
+Image::Image(const std::string & path)
+{
+    #ifdef WIN32
+
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+
+        if (!file.is_open())
+            throw std::runtime_error(fmt::format("File not found {}", path));
+
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        bytes  = buffer.data();
+        length = buffer.size();
+
+    #else
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd < 0)
+            throw std::runtime_error(fmt::format("File not found {}", path));
+
+        struct stat info;
+
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error(fmt::format("Unable to stat {}", path));
+        }
+
+        length = info.st_size;
+
+        if (length > 0)
+        {
+            mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+
+            if (mapping == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error(fmt::format("Unable to map {}", path));
+            }
+
+            bytes = static_cast<const uint8_t *>(mapping);
+        }
+
+        // Mapping stays valid after descriptor is closed
+        ::close(fd);
+
+    #endif
+}
+
+
+/*
+    Unmap image file
+*/
+Image::~Image()
+{
+    #ifndef WIN32
+
+        if (mapping) {
+            ::munmap(mapping, length);
+        }
+
+    #endif
+}
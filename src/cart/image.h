@@ -0,0 +1,72 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Read-only ROM image
+//
+//      File is memory mapped, so opening does not depend on ROM size
+//      and instances running the same ROM share page cache pages.
+//      Platforms without mmap read the file into memory.
+//
+
+class Image
+{
+private:
+
+    const uint8_t * bytes = nullptr;
+    size_t length = 0;
+
+    // File mapping, nullptr if image is read into buffer
+    void * mapping = nullptr;
+
+    // Fallback storage
+    std::vector<uint8_t> buffer;
+
+public:
+
+    /*
+        Open image file
+    */
+    Image(const std::string & path);
+
+    Image(const Image &) = delete;
+    Image & operator= (const Image &) = delete;
+
+    ~Image();
+
+    const uint8_t * data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    uint8_t operator[] (size_t index) const {
+        return bytes[index];
+    }
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapper.h"
+
+#include <stdexcept>
+
+#include "nrom.h"
+#include "mmc1.h"
+#include "uxrom.h"
+#include "cnrom.h"
+#include "mmc3.h"
+
+#include "bus/bus.h"
+#include "cpu/cpu.h"
+#include "state.h"
+#include "fmt/core.h"
+
+
+Mapper::Mapper(Cart & cart) :
+    cart      (cart),
+    chr       (cart.getChr()),
+    chrRam    (cart.getChrRam()),
+    mirroring (cart.getMirroring())
+{ }
+
+
+/*
+    Create mapper by cartridge mapper number
+*/
+std::unique_ptr<Mapper> Mapper::create(Cart & cart)
+{
+    switch (cart.getMapper())
+    {
+        case 0: return std::make_unique<Nrom>  (cart);
+        case 1: return std::make_unique<Mmc1>  (cart);
+        case 2: return std::make_unique<Uxrom> (cart);
+        case 3: return std::make_unique<Cnrom> (cart);
+        case 4: return std::make_unique<Mmc3>  (cart);
+    }
+
+    throw std::runtime_error(fmt::format("Unsupported mapper {}", cart.getMapper()));
+}
+
+
+/*
+    Map PRG ROM and PRG RAM into bus, connect IRQ line to CPU
+*/
+void Mapper::attach(Bus & value, Cpu & target)
+{
+    bus = &value;
+    cpu = &target;
+
+    // PRG RAM $6000 - $7FFF
+    bus -> map(0x60, 0x7F, cart.getPrgRam(), cart.getPrgRam());
+
+    reset();
+}
+
+
+/*
+    Assert or release mapper IRQ line
+*/
+void Mapper::setIrq(bool active)
+{
+    irq = active;
+
+    if (cpu) {
+        cpu -> irq(Cpu::MapperIrq, active);
+    }
+}
+
+
+/*
+    Map PRG ROM bank at CPU address
+*/
+void Mapper::mapPrg(uint16_t address, uint32_t size, int32_t offset)
+{
+    int32_t total = cart.getPrgSize();
+
+    // Wrap offset so that short ROM mirrors and -size is the last bank
+    uint32_t wrapped = ((offset % total) + total) % total;
+
+    // Pages wrap too, bank may be larger than what is left of ROM
+    for (uint32_t page = 0; page < (size >> 8); page++)
+    {
+        uint8_t index = (address >> 8) + page;
+        uint32_t at = (wrapped + (page << 8)) % total;
+
+        prgOffset[index - 0x80] = at;
+        bus -> map(index, index, cart.getPrg() + at, nullptr, this);
+    }
+}
+
+
+/*
+    Map CHR bank of 1KB units at slot
+*/
+void Mapper::mapChr(uint8_t slot, uint8_t count, uint32_t offset)
+{
+    for (uint8_t index = 0; index < count; index++) {
+        chrOffset[slot + index] = (offset + index * chrBank) % cart.getChrSize();
+    }
+}
+
+
+/*
+    Write bank mapping and cartridge RAM
+*/
+void Mapper::save(State & state) const
+{
+    state.mark("MAP ");
+
+    state.put(prgOffset);
+    state.put(chrOffset);
+    state.put(mirroring);
+    state.put(irq);
+
+    state.put(cart.getPrgRam(), cart.getPrgRamSize());
+
+    if (chrRam) {
+        state.put(chrRam, cart.getChrSize());
+    }
+}
+
+
+/*
+    Read bank mapping and cartridge RAM, remap PRG pages
+*/
+void Mapper::load(State & state)
+{
+    state.check("MAP ");
+
+    state.get(prgOffset);
+    state.get(chrOffset);
+    state.get(mirroring, Mirroring::FourScreen);
+    state.get(irq);
+
+    // Offsets index ROM directly, so corrupted ones must not reach the bus
+    for (uint32_t offset : prgOffset) {
+        if (offset >= cart.getPrgSize() || offset % 0x100)
+            throw std::runtime_error("Save-state PRG offset out of range");
+    }
+
+    for (uint32_t offset : chrOffset) {
+        if (offset >= cart.getChrSize() || offset % chrBank)
+            throw std::runtime_error("Save-state CHR offset out of range");
+    }
+
+    // Restore CPU IRQ line from mapper state
+    setIrq(irq);
+
+    state.get(cart.getPrgRam(), cart.getPrgRamSize());
+
+    if (chrRam) {
+        state.get(chrRam, cart.getChrSize());
+    }
+
+    for (uint16_t page = 0; page < prgOffset.size(); page++) {
+        bus -> map(0x80 + page, 0x80 + page, cart.getPrg() + prgOffset[page], nullptr, this);
+    }
+}
+
+
+/*
+    Read unmapped cartridge space (open bus)
+*/
+uint8_t Mapper::read(uint16_t)
+{
+    return 0x00;
+}
+
+
+/*
+    Write mapper register
+*/
+void Mapper::write(uint16_t, uint8_t)
+{ }
@@ -0,0 +1,168 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPER_H
+#define MAPPER_H
+
+#include <array>
+#include <memory>
+#include <cstdint>
+
+#include "cart.h"
+#include "bus/device.h"
+
+class Bus;
+class Cpu;
+class State;
+
+//
+// Cartridge mapper
+//
+//      Maps PRG banks into CPU address space and CHR banks into
+//      PPU pattern tables. Bank switching only swaps pointers in the
+//      bus page table and CHR bank table, ROM data is never copied.
+//
+//      PRG ROM pages are read directly by the bus, writes to them
+//      reach mapper registers through Device::write.
+//
+
+class Mapper : public Device
+{
+protected:
+
+    /*
+        CHR bank size, pattern tables are split into 8 banks
+    */
+    static const uint32_t chrBank = 1024;
+
+    Cart & cart;
+
+    // Bus mapper is attached to
+    Bus * bus = nullptr;
+
+    // CPU receiving mapper IRQ
+    Cpu * cpu = nullptr;
+
+    // PRG ROM offset of each CPU page $8000 - $FFFF
+    std::array<uint32_t, 128> prgOffset {};
+
+    // CHR memory and 1KB bank offsets
+    const uint8_t * chr;
+    uint8_t * chrRam;
+    std::array<uint32_t, 8> chrOffset {};
+
+    // Current nametable mirroring
+    Mirroring mirroring;
+
+    // IRQ line asserted by mapper
+    bool irq = false;
+
+    /*
+        Map PRG ROM bank at CPU address
+        Offset is wrapped by PRG size, negative offset counts from the end
+    */
+    void mapPrg(uint16_t address, uint32_t size, int32_t offset);
+
+    /*
+        Map CHR bank of 1KB units at slot
+        Offset is wrapped by CHR size
+    */
+    void mapChr(uint8_t slot, uint8_t count, uint32_t offset);
+
+    /*
+        Map initial banks
+    */
+    virtual void reset() = 0;
+
+    /*
+        Assert or release mapper IRQ line
+    */
+    void setIrq(bool active);
+
+public:
+
+    Mapper(Cart & cart);
+
+    /*
+        Create mapper by cartridge mapper number
+    */
+    static std::unique_ptr<Mapper> create(Cart & cart);
+
+    /*
+        Map PRG ROM and PRG RAM into bus, connect IRQ line to CPU
+    */
+    void attach(Bus & bus, Cpu & cpu);
+
+    /*
+        Read unmapped cartridge space (open bus)
+    */
+    uint8_t read(uint16_t index) override;
+
+    /*
+        Write mapper register
+    */
+    void write(uint16_t index, uint8_t data) override;
+
+    /*
+        Read pattern table byte
+    */
+    uint8_t readChr(uint16_t address) const {
+        return chr[chrOffset[(address >> 10) & 0x07] + (address & 0x3FF)];
+    }
+
+    /*
+        Write pattern table byte, ignored for CHR ROM
+    */
+    void writeChr(uint16_t address, uint8_t data)
+    {
+        if (chrRam) {
+            chrRam[chrOffset[(address >> 10) & 0x07] + (address & 0x3FF)] = data;
+        }
+    }
+
+    /*
+        Write/Read bank mapping, cartridge RAM and mapper registers
+        Banks are remapped into bus on read
+    */
+    virtual void save(State & state) const;
+    virtual void load(State & state);
+
+    /*
+        Scanline counter clock (PPU A12 rising edge)
+    */
+    virtual void scanline() { }
+
+    /*
+        Scanline counter clocks until mapper may raise IRQ, 0 if it never does
+        PPU stops CPU on that clock, so IRQ is taken on its scanline
+    */
+    virtual uint16_t getIrqClocks() const {
+        return 0;
+    }
+
+    Mirroring getMirroring() const {
+        return mirroring;
+    }
+
+    bool isIrq() const {
+        return irq;
+    }
+
+    virtual ~Mapper() = default;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mmc1.h"
+
+#include "state.h"
+
+
+/*
+    Map initial banks
+*/
+void Mmc1::reset()
+{
+    shift   = 0x10;
+    control = 0x0C;
+
+    update();
+}
+
+
+/*
+    Load shift register, write target register on fifth bit
+*/
+void Mmc1::write(uint16_t index, uint8_t data)
+{
+    if (data & 0x80)
+    {
+        shift = 0x10;
+        control |= 0x0C;
+
+        update();
+        return;
+    }
+
+    // Marker bit reaches bit 0 when four bits are already loaded
+    bool full = shift & 0x01;
+
+    shift = (shift >> 1) | ((data & 0x01) << 4);
+
+    if (!full)
+        return;
+
+    switch ((index >> 13) & 0x03)
+    {
+        case 0: control = shift; break;
+        case 1: chr0    = shift; break;
+        case 2: chr1    = shift; break;
+        case 3: prg     = shift; break;
+    }
+
+    shift = 0x10;
+    update();
+}
+
+
+/*
+    Remap banks after register change
+*/
+void Mmc1::update()
+{
+    switch (control & 0x03)
+    {
+        case 0: mirroring = Mirroring::SingleLow;  break;
+        case 1: mirroring = Mirroring::SingleHigh; break;
+        case 2: mirroring = Mirroring::Vertical;   break;
+        case 3: mirroring = Mirroring::Horizontal; break;
+    }
+
+    uint8_t bank = prg & 0x0F;
+
+    switch ((control >> 2) & 0x03)
+    {
+        // Switch 32KB at $8000, ignoring low bit of bank number
+        case 0:
+        case 1:
+            mapPrg(0x8000, 0x8000, (bank & 0x0E) * 0x4000);
+            break;
+
+        // Fix first bank at $8000 and switch 16KB bank at $C000
+        case 2:
+            mapPrg(0x8000, 0x4000, 0);
+            mapPrg(0xC000, 0x4000, bank * 0x4000);
+            break;
+
+        // Fix last bank at $C000 and switch 16KB bank at $8000
+        case 3:
+            mapPrg(0x8000, 0x4000, bank * 0x4000);
+            mapPrg(0xC000, 0x4000, -0x4000);
+            break;
+    }
+
+    if (control & 0x10)
+    {
+        // Two separate 4KB banks
+        mapChr(0, 4, chr0 * 0x1000);
+        mapChr(4, 4, chr1 * 0x1000);
+    }
+    else
+    {
+        // Single 8KB bank, ignoring low bit of bank number
+        mapChr(0, 8, (chr0 & 0x1E) * 0x1000);
+    }
+}
+
+
+/*
+    Write bank mapping and registers
+*/
+void Mmc1::save(State & state) const
+{
+    Mapper::save(state);
+
+    state.put(shift);
+    state.put(control);
+    state.put(chr0);
+    state.put(chr1);
+    state.put(prg);
+}
+
+
+/*
+    Read bank mapping and registers
+*/
+void Mmc1::load(State & state)
+{
+    Mapper::load(state);
+
+    state.get(shift);
+    state.get(control);
+    state.get(chr0);
+    state.get(chr1);
+    state.get(prg);
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MMC1_H
+#define MMC1_H
+
+#include "mapper.h"
+
+//
+// MMC1 (mapper 1)
+//
+//      Registers are loaded serially through 5-bit shift register,
+//      one bit per write; bit 7 set resets the shift register.
+//
+//      $8000 - $9FFF   Control (mirroring, PRG & CHR bank modes)
+//      $A000 - $BFFF   CHR bank 0
+//      $C000 - $DFFF   CHR bank 1
+//      $E000 - $FFFF   PRG bank
+//
+
+class Mmc1 : public Mapper
+{
+private:
+
+    uint8_t shift = 0x10;
+
+    uint8_t control = 0x0C;
+    uint8_t chr0 = 0x00;
+    uint8_t chr1 = 0x00;
+    uint8_t prg = 0x00;
+
+    /*
+        Remap banks after register change
+    */
+    void update();
+
+protected:
+
+    void reset() override;
+
+public:
+
+    using Mapper::Mapper;
+
+    void write(uint16_t index, uint8_t data) override;
+
+    void save(State & state) const override;
+    void load(State & state) override;
+};
+
+#endif
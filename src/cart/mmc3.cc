@@ -0,0 +1,187 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mmc3.h"
+
+#include "state.h"
+
+
+/*
+    Map initial banks
+*/
+void Mmc3::reset()
+{
+    banks  = { 0, 2, 4, 5, 6, 7, 0, 1 };
+    select = 0x00;
+
+    update();
+}
+
+
+/*
+    Write mapper register selected by address range and A0
+*/
+void Mmc3::write(uint16_t index, uint8_t data)
+{
+    bool odd = index & 0x01;
+
+    switch ((index >> 13) & 0x03)
+    {
+        // $8000 - $9FFF
+        case 0:
+            if (odd) {
+                banks[select & 0x07] = data;
+            } else {
+                select = data;
+            }
+
+            update();
+            break;
+
+        // $A000 - $BFFF
+        case 1:
+            if (!odd && mirroring != Mirroring::FourScreen) {
+                mirroring = (data & 0x01) ? Mirroring::Horizontal : Mirroring::Vertical;
+            }
+            break;
+
+        // $C000 - $DFFF
+        case 2:
+            if (odd) {
+                counter = 0x00;
+                reload  = true;
+            } else {
+                latch = data;
+            }
+            break;
+
+        // $E000 - $FFFF
+        case 3:
+            enabled = odd;
+
+            // Disabling acknowledges pending interrupt
+            if (!odd) {
+                setIrq(false);
+            }
+            break;
+    }
+}
+
+
+/*
+    Clock IRQ counter
+*/
+void Mmc3::scanline()
+{
+    if (counter == 0 || reload)
+    {
+        counter = latch;
+        reload  = false;
+    }
+    else
+    {
+        counter--;
+    }
+
+    if (counter == 0 && enabled)
+        setIrq(true);
+}
+
+
+/*
+    Counter clocks until IRQ
+
+    Disabled or acknowledged counter may be programmed again by any
+    write, so it is checked again on the next clock.
+*/
+uint16_t Mmc3::getIrqClocks() const
+{
+    if (!enabled || irq)
+        return 1;
+
+    // Counter reloads on next clock, latch of 0 raises IRQ on it
+    if (counter == 0 || reload)
+        return latch + 1;
+
+    return counter;
+}
+
+
+/*
+    Remap banks after register change
+*/
+void Mmc3::update()
+{
+    // PRG mode: swap $8000 and $C000
+    if (select & 0x40)
+    {
+        mapPrg(0x8000, 0x2000, -0x4000);
+        mapPrg(0xC000, 0x2000, banks[6] * 0x2000);
+    }
+    else
+    {
+        mapPrg(0x8000, 0x2000, banks[6] * 0x2000);
+        mapPrg(0xC000, 0x2000, -0x4000);
+    }
+
+    mapPrg(0xA000, 0x2000, banks[7] * 0x2000);
+    mapPrg(0xE000, 0x2000, -0x2000);
+
+    // CHR inversion: swap 2KB and 1KB halves
+    uint8_t big   = (select & 0x80) ? 4 : 0;
+    uint8_t small = (select & 0x80) ? 0 : 4;
+
+    mapChr(big + 0, 2, (banks[0] & 0xFE) * 0x400);
+    mapChr(big + 2, 2, (banks[1] & 0xFE) * 0x400);
+
+    mapChr(small + 0, 1, banks[2] * 0x400);
+    mapChr(small + 1, 1, banks[3] * 0x400);
+    mapChr(small + 2, 1, banks[4] * 0x400);
+    mapChr(small + 3, 1, banks[5] * 0x400);
+}
+
+
+/*
+    Write bank mapping and registers
+*/
+void Mmc3::save(State & state) const
+{
+    Mapper::save(state);
+
+    state.put(banks);
+    state.put(select);
+    state.put(latch);
+    state.put(counter);
+    state.put(reload);
+    state.put(enabled);
+}
+
+
+/*
+    Read bank mapping and registers
+*/
+void Mmc3::load(State & state)
+{
+    Mapper::load(state);
+
+    state.get(banks);
+    state.get(select);
+    state.get(latch);
+    state.get(counter);
+    state.get(reload);
+    state.get(enabled);
+}
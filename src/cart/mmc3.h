@@ -0,0 +1,83 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MMC3_H
+#define MMC3_H
+
+#include <array>
+
+#include "mapper.h"
+
+//
+// MMC3 (mapper 4)
+//
+//      $8000 - $9FFF   Bank select (even), bank data (odd)
+//      $A000 - $BFFF   Mirroring (even), PRG RAM protect (odd)
+//      $C000 - $DFFF   IRQ latch (even), IRQ reload (odd)
+//      $E000 - $FFFF   IRQ disable (even), IRQ enable (odd)
+//
+//      R0, R1 select 2KB CHR banks, R2 - R5 select 1KB CHR banks,
+//      R6, R7 select 8KB PRG banks.
+//
+
+class Mmc3 : public Mapper
+{
+private:
+
+    // Bank registers R0 - R7
+    std::array<uint8_t, 8> banks {};
+
+    // Bank select register
+    uint8_t select = 0x00;
+
+    // Scanline IRQ counter
+    uint8_t latch = 0x00;
+    uint8_t counter = 0x00;
+
+    bool reload = false;
+    bool enabled = false;
+
+    /*
+        Remap banks after register change
+    */
+    void update();
+
+protected:
+
+    void reset() override;
+
+public:
+
+    using Mapper::Mapper;
+
+    void write(uint16_t index, uint8_t data) override;
+
+    void save(State & state) const override;
+    void load(State & state) override;
+
+    /*
+        Clock IRQ counter
+    */
+    void scanline() override;
+
+    /*
+        Counter clocks until IRQ
+    */
+    uint16_t getIrqClocks() const override;
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NROM_H
+#define NROM_H
+
+#include "mapper.h"
+
+//
+// NROM (mapper 0)
+//
+//      $8000 - $BFFF   First 16KB of PRG ROM
+//      $C000 - $FFFF   Last 16KB of PRG ROM (mirror of first for NROM-128)
+//      PPU $0000       8KB CHR ROM
+//
+
+class Nrom : public Mapper
+{
+protected:
+
+    void reset() override;
+
+public:
+
+    using Mapper::Mapper;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UXROM_H
+#define UXROM_H
+
+#include "mapper.h"
+
+//
+// UxROM (mapper 2)
+//
+//      $8000 - $BFFF   Switchable 16KB PRG ROM bank
+//      $C000 - $FFFF   Last 16KB PRG ROM bank (fixed)
+//      $8000 - $FFFF   Bank select register (write)
+//      PPU $0000       8KB CHR RAM
+//
+
+class Uxrom : public Mapper
+{
+protected:
+
+    void reset() override;
+
+public:
+
+    using Mapper::Mapper;
+
+    void write(uint16_t index, uint8_t data) override;
+};
+
+#endif
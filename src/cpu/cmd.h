@@ -19,18 +19,86 @@
 #define CMD_HPP
 
 #include <cstdint>
-#include <string>
+#include <type_traits>
 
 #include "cpu.h"
 
+//
+// Command mnemonic
+// Index in command names table (see Map::getName)
+//
+
+enum class Mnemonic : uint8_t
+{
+    ADC, ALR, ANC, AND, ANE, ARR, ASL, BCC,
+    BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC,
+    BVS, CLC, CLD, CLI, CLV, CMP, CPX, CPY,
+    DCP, DEC, DEX, DEY, EOR, INC, INX, INY,
+    ISC, JAM, JMP, JSR, LAS, LAX, LDA, LDX,
+    LDY, LSR, LXA, NOP, ORA, PHA, PHP, PLA,
+    PLP, RLA, ROL, ROR, RRA, RTI, RTS, SAX,
+    SBC, SBX, SEC, SED, SEI, SHA, SHX, SHY,
+    SLO, SRE, STA, STX, STY, TAS, TAX, TAY,
+    TSX, TXA, TXS, TYA, USB
+};
+
+//
+// Addressing mode
+//
+
+enum class Mode : uint8_t
+{
+    IMP,  // implied
+    ACC,  // accumulator
+    IMM,  // immediate
+    ABS,  // absolute
+    ABSX, // absolute, X-indexed
+    ABSY, // absolute, Y-indexed
+    ZPG,  // zeropage
+    ZPGX, // zeropage, X-indexed
+    ZPGY, // zeropage, Y-indexed
+    IND,  // indirect
+    INDX, // X-indexed, indirect
+    INDY, // indirect, Y-indexed
+    REL   // relative
+};
+
+/*
+    Plain command descriptor fetched on every instruction.
+    All fields are known at compile time, see Map
+*/
+
 class Cmd
 {
 public:
 
+    using Handler = void (Cpu::*) (void);
+
+    /*
+        Command flags
+    */
+    enum Flags : uint8_t
+    {
+        None    = 0,
+        Cross   = 1 << 0, // One more cycle if indexing crosses page boundary
+        Illegal = 1 << 1  // Undocumented operation code
+    };
+
+    /*
+        Memory mode & command
+    */
+    Handler code;
+    Handler mode;
+
+    /*
+        Command mnemonic
+    */
+    Mnemonic mnemonic;
+
     /*
-        Command name (BRK, ORA etc)
+        Addressing mode
     */
-    std::string name;
+    Mode addressing;
 
     /*
         Programm cycles need to execute command
@@ -38,11 +106,25 @@ public:
     uint8_t cycles;
 
     /*
-        Memory mode & command
+        Command length in bytes
+    */
+    uint8_t bytes;
+
+    /*
+        Page-cross penalty & illegal flags
     */
-    void (Cpu::*code) (void);
-    void (Cpu::*mode) (void);
+    uint8_t flags;
+
 
+    constexpr Cmd (Mnemonic mnemonic, Handler code, Mode addressing, uint8_t cycles, uint8_t flags = None) :
+        code       (code),
+        mode       (getHandler(addressing)),
+        mnemonic   (mnemonic),
+        addressing (addressing),
+        cycles     (cycles),
+        bytes      (getBytes(addressing)),
+        flags      (flags)
+    { }
 
     /*
         Execute command
@@ -63,30 +145,88 @@ public:
     /*
         Command is Accumulator adressing
     */
-    bool isAcc() const {
-        return mode == &Cpu::ACC;
+    constexpr bool isAcc() const {
+        return addressing == Mode::ACC;
     };
 
     /*
         Command is relation adressing
     */
-    bool isRel() const {
-        return mode == &Cpu::REL;
+    constexpr bool isRel() const {
+        return addressing == Mode::REL;
+    }
+
+    /*
+        Command takes one more cycle when indexing crosses page
+    */
+    constexpr bool isCross() const {
+        return flags & Cross;
+    }
+
+    /*
+        Command is undocumented
+    */
+    constexpr bool isIllegal() const {
+        return flags & Illegal;
     }
 
     /*
         Command length in bytes
     */
-    uint8_t getBytes() const
-    {
-        if (isAcc() || mode == &Cpu::IMP)
-            return 1;
+    constexpr uint8_t getBytes() const {
+        return bytes;
+    }
 
-        if (mode == &Cpu::ABS || mode == &Cpu::ABSX || mode == &Cpu::ABSY)
-            return 3;
+private:
+
+    /*
+        Command length in bytes by addressing mode
+    */
+    static constexpr uint8_t getBytes(Mode addressing)
+    {
+        switch (addressing)
+        {
+            case Mode::IMP:
+            case Mode::ACC:
+                return 1;
+
+            case Mode::ABS:
+            case Mode::ABSX:
+            case Mode::ABSY:
+            case Mode::IND:
+                return 3;
+
+            default:
+                return 2;
+        }
+    }
 
-        return 2;
+    /*
+        Addressing mode handler
+    */
+    static constexpr Handler getHandler(Mode addressing)
+    {
+        switch (addressing)
+        {
+            case Mode::ACC:  return &Cpu::ACC;
+            case Mode::IMM:  return &Cpu::IMM;
+            case Mode::ABS:  return &Cpu::ABS;
+            case Mode::ABSX: return &Cpu::ABSX;
+            case Mode::ABSY: return &Cpu::ABSY;
+            case Mode::ZPG:  return &Cpu::ZPG;
+            case Mode::ZPGX: return &Cpu::ZPGX;
+            case Mode::ZPGY: return &Cpu::ZPGY;
+            case Mode::IND:  return &Cpu::IND;
+            case Mode::INDX: return &Cpu::INDX;
+            case Mode::INDY: return &Cpu::INDY;
+            case Mode::REL:  return &Cpu::REL;
+
+            default:
+                return &Cpu::IMP;
+        }
     }
 };
 
+static_assert(std::is_trivially_copyable<Cmd>::value, "Cmd must be trivially copyable");
+
 #endif
\ No newline at end of file
@@ -21,19 +21,22 @@
 #include "cpu/cpu.h"
 #include "cpu/map.h"
 #include "cpu/mem.h"
+#include "cpu/decoder.h"
+#include "aot/aot.h"
 #include "bus/bus.h"
+#include "state.h"
+
+#ifdef JIT
+    #include "jit/jit.h"
+#endif
 
 
 /*
     Default constructor
 */
 
-Cpu::Cpu(std::shared_ptr<Bus> bus)
-{
-    map = std::make_unique<Map>();
-    log = std::make_unique<Log>(bus);
-    mem = std::make_unique<Mem>(bus);
-}
+Cpu::Cpu(Bus & bus) : mem(bus), log(bus)
+{ }
 
 
 /*
@@ -49,10 +52,10 @@ Cpu::~Cpu() = default;
 
 uint8_t Cpu::read() const
 {
-    if (cmd -> isAcc())
+    if (acc)
         return a;
 
-    return mem -> read(op);
+    return mem.read(op);
 }
 
 
@@ -62,52 +65,1096 @@ uint8_t Cpu::read() const
 
 void Cpu::write (uint8_t data)
 {
-    if (cmd -> isAcc()) {
+    if (acc) {
         a = data;
     } else {
-        mem -> write(op, data);
+        mem.write(op, data);
     }
 }
 
 
 /*
-    Read operation code and execute command
+    Fetch and execute single command
+    Returns total programm cycles per operation
+*/
+
+template <Cpu::Variant V>
+uint8_t Cpu::step ()
+{
+    if (pending)
+    {
+        if (auto total = service())
+        {
+            cycles += total;
+            return total;
+        }
+    }
+
+    counter++;
+
+    auto code = mem.read(pc++);
+    auto & oper = Map::getCommand<V>(code);
+
+    penalty = 0;
+    crossed = false;
+
+    uint8_t total;
+
+    // Cache, Aot and Jit engines fetch commands they do not take
+    if (engine != Engine::Table)
+    {
+        execute<V>(code);
+        total = oper.cycles;
+    }
+    else
+    {
+        acc = oper.isAcc();
+
+        // Execute command and returns programm cycles
+        total = oper.execute(this);
+    }
+
+    // Page crossing counts only for read commands
+    if (crossed && oper.isCross())
+        total++;
+
+    total  += penalty;
+    cycles += total;
+
+    return total;
+}
+
+
+/*
+    Execute command predecoded with static operand address
     Returns total programm cycles per operation
+
+    Instantiated per operation code from its Map entry, so addressing
+    mode and command are called directly and length and cycles are
+    constants. Accumulator commands go through the switch of execute().
+*/
+
+template <Cpu::Variant V, uint8_t Code>
+uint8_t Cpu::predecoded (uint16_t operand)
+{
+    constexpr auto & oper = Map::getCommand<V>(Code);
+    constexpr auto mode = oper.addressing;
+
+    counter++;
+
+    penalty = 0;
+    crossed = false;
+
+    base = operand;
+    pc  += oper.getBytes();
+
+    if constexpr (mode == Mode::ACC)
+    {
+        execute<V, true>(Code);
+    }
+    else
+    {
+        if constexpr (mode == Mode::IMM)  IMM<true>();
+        if constexpr (mode == Mode::ABS)  ABS<true>();
+        if constexpr (mode == Mode::ABSX) ABSX<true>();
+        if constexpr (mode == Mode::ABSY) ABSY<true>();
+        if constexpr (mode == Mode::ZPG)  ZPG<true>();
+        if constexpr (mode == Mode::ZPGX) ZPGX<true>();
+        if constexpr (mode == Mode::ZPGY) ZPGY<true>();
+        if constexpr (mode == Mode::IND)  IND<true>();
+        if constexpr (mode == Mode::INDX) INDX<true>();
+        if constexpr (mode == Mode::INDY) INDY<true>();
+        if constexpr (mode == Mode::REL)  REL<true>();
+
+        (this ->* oper.code)();
+    }
+
+    uint8_t total = oper.cycles;
+
+    // Page crossing counts only for read commands
+    if (crossed && oper.isCross())
+        total++;
+
+    total  += penalty;
+    cycles += total;
+
+    return total;
+}
+
+
+/*
+    Returns handler of predecoded operation code for variant
+*/
+
+template <Cpu::Variant V, size_t... Codes>
+constexpr std::array<Cpu::Handler, 256> Cpu::getHandlers (std::index_sequence<Codes...>)
+{
+    return {{ &Cpu::predecoded<V, Codes>... }};
+}
+
+template <Cpu::Variant V>
+Cpu::Handler Cpu::getHandler (uint8_t code)
+{
+    static constexpr auto table = getHandlers<V>(std::make_index_sequence<256>());
+    return table[code];
+}
+
+template Cpu::Handler Cpu::getHandler<Cpu::Variant::Ricoh2A03> (uint8_t);
+template Cpu::Handler Cpu::getHandler<Cpu::Variant::Nmos6502> (uint8_t);
+
+
+/*
+    Execute predecoded command
+    Command is fetched by step() if not cached or interrupt is pending
+*/
+
+template <Cpu::Variant V>
+uint8_t Cpu::cached ()
+{
+    auto entry = pending ? nullptr : decoder -> find(pc);
+
+    if (!entry)
+        return step<V>();
+
+    return (this ->* entry -> handler)(entry -> base);
+}
+
+
+/*
+    Execute fused idiom predecoded at PC within cycle end
+    Returns address of last command run, tested for trap
+
+    Both commands take fixed operand addresses, so they run inline one
+    after another. Next command is left to the following round when the
+    first one raised an interrupt, reached cycle end or changed its page,
+    as it would run by itself.
 */
 
-void Cpu::clock ()
+template <Cpu::Variant V, Cpu::Fusion F>
+uint16_t Cpu::fuse (uint8_t code, uint16_t operand, uint8_t nextCode, uint16_t nextOperand, uint64_t end)
 {
+    auto temp  = pc;
+    auto & first = Map::getCommand<V>(code);
+
+    counter++;
+
+    op  = operand;
+    pc += first.getBytes();
+
+    if constexpr (F == Fusion::LdaSta) LDA();
+    if constexpr (F == Fusion::CmpBne) CMP();
+    if constexpr (F == Fusion::DexBne) DEX();
+    if constexpr (F == Fusion::DeyBne) DEY();
+    if constexpr (F == Fusion::IncBne) INC();
+
+    cycles += first.cycles;
+
+    if (pending || cycles >= end || !decoder -> isCurrent(temp))
+        return temp;
+
+    auto & second = Map::getCommand<V>(nextCode);
+
     counter++;
+    penalty = 0;
+
+    op  = nextOperand;
+    pc += second.getBytes();
+
+    if constexpr (F == Fusion::LdaSta) {
+        STA();
+    } else {
+        BNE();
+    }
+
+    cycles += second.cycles + penalty;
+    fusions[static_cast<uint8_t>(F)] += 2;
+
+    return temp + first.getBytes();
+}
+
+
+/*
+    Execute predecoded command or fused idiom until cycle end
+    Returns address of last command run, tested for trap
+
+    Idioms are called through table, so they stay out of the command
+    loop. Breakpoint runs are not fused, so each command stops on its
+    own address.
+*/
+
+template <Cpu::Variant V>
+uint16_t Cpu::fused (uint64_t end)
+{
+    static constexpr uint16_t (Cpu::*idioms[])(uint8_t, uint16_t, uint8_t, uint16_t, uint64_t)
+    {
+        nullptr,
+        &Cpu::fuse<V, Fusion::LdaSta>,
+        &Cpu::fuse<V, Fusion::CmpBne>,
+        &Cpu::fuse<V, Fusion::DexBne>,
+        &Cpu::fuse<V, Fusion::DeyBne>,
+        &Cpu::fuse<V, Fusion::IncBne>
+    };
+
+    auto temp  = pc;
+    auto entry = pending ? nullptr : decoder -> find(pc);
+
+    if (!entry)
+    {
+        step<V>();
+        return temp;
+    }
+
+    if (entry -> fusion == Fusion::None || breaks)
+    {
+        (this ->* entry -> handler)(entry -> base);
+        return temp;
+    }
+
+    return (this ->* idioms[static_cast<uint8_t>(entry -> fusion)])
+        (entry -> code, entry -> base, entry -> nextCode, entry -> nextBase, end);
+}
 
-    auto temp = pc;
 
-    auto code = mem -> read(pc++);  
-    auto oper = map -> getCommand(code);
+// Stepped by Aot and Jit between blocks
+template uint8_t Cpu::step<Cpu::Variant::Ricoh2A03> ();
+template uint8_t Cpu::step<Cpu::Variant::Nmos6502> ();
 
-    cmd = &oper;
 
-    // Execute command and returns programm cycles
-    oper.execute(this);
+/*
+    Read operation code and execute command
+    Returns total programm cycles per operation
+*/
+
+template <Cpu::Variant V>
+uint8_t Cpu::clock ()
+{
+    auto temp  = pc;
+    auto total = (engine == Engine::Cache) ? cached<V>() : step<V>();
 
     // Disassembled output
-    if (counter > 26764002)
-        log -> step(counter, temp, oper, this);
+    if (counter > trace)
+        log.step(counter, temp, Map::getCommand<V>(mem.read(temp)), this);
+
+    return total;
+}
+
+// Same for selected variant
+uint8_t Cpu::clock ()
+{
+    if (variant == Variant::Nmos6502)
+        return clock<Variant::Nmos6502>();
+
+    return clock<Variant::Ricoh2A03>();
 }
 
 
 /*
-    Reset CPU and clear all registers & flags
+    Execute commands until cycle or stop condition
+
+    Disassembly is resolved at compile time, so untraced
+    loop only fetches, executes and tests stop conditions.
 */
 
-void Cpu::reset ()
+template <bool Trace, Cpu::Variant V, bool Cached>
+Cpu::Stop Cpu::loop (uint64_t end)
+{
+    while (cycles < end)
+    {
+        auto temp = pc;
+
+        if (Trace) {
+            clock<V>();
+        } else if (Cached) {
+            temp = fused<V>(end);
+        } else {
+            step<V>();
+        }
+
+        if (jammed)
+            return Stop::Jam;
+
+        if (traps && pc == temp)
+            return Stop::Trap;
+
+        if (breaks && breakpoints[pc])
+            return Stop::Breakpoint;
+    }
+
+    return Stop::Budget;
+}
+
+
+/*
+    Run commands for cycle budget or until stop condition
+*/
+
+Cpu::Stop Cpu::run (uint64_t budget)
+{
+    if (jammed)
+        return Stop::Jam;
+
+    auto end = cycles + budget;
+
+    // Traced and breakpoint runs stay in the interpreter
+    if (engine == Engine::Aot && trace == UINT64_MAX && !breaks)
+    {
+        if (!aot)
+            aot = std::make_unique<Aot>(*this, mem.getBus());
+
+        if (variant == Variant::Nmos6502)
+            return aot -> run<Variant::Nmos6502>(end);
+
+        return aot -> run<Variant::Ricoh2A03>(end);
+    }
+
+    #ifdef JIT
+    if (engine == Engine::Jit && trace == UINT64_MAX && !breaks)
+    {
+        if (!jit)
+            jit = std::make_unique<Jit>(*this, mem.getBus());
+
+        if (variant == Variant::Nmos6502)
+            return jit -> run<Variant::Nmos6502>(end);
+
+        return jit -> run<Variant::Ricoh2A03>(end);
+    }
+    #endif
+
+    if (variant == Variant::Nmos6502)
+    {
+        if (trace != UINT64_MAX)
+            return loop<true, Variant::Nmos6502>(end);
+
+        if (engine == Engine::Cache)
+            return loop<false, Variant::Nmos6502, true>(end);
+
+        return loop<false, Variant::Nmos6502>(end);
+    }
+
+    if (trace != UINT64_MAX)
+        return loop<true, Variant::Ricoh2A03>(end);
+
+    if (engine == Engine::Cache)
+        return loop<false, Variant::Ricoh2A03, true>(end);
+
+    return loop<false, Variant::Ricoh2A03>(end);
+}
+
+
+/*
+    Run commands until cycle counter reaches value
+*/
+
+Cpu::Stop Cpu::until (uint64_t cycle)
+{
+    if (cycle <= cycles)
+        return Stop::Budget;
+
+    return run(cycle - cycles);
+}
+
+
+/*
+    Print disassembly after command number
+*/
+
+void Cpu::setTrace (uint64_t from)
+{
+    trace = from;
+}
+
+
+/*
+    Set/Unset breakpoint on address
+*/
+
+void Cpu::setBreakpoint (uint16_t address, bool enabled)
+{
+    if (breakpoints[address] != enabled)
+    {
+        breakpoints[address] = enabled;
+
+        if (enabled) {
+            breaks++;
+        } else {
+            breaks--;
+        }
+    }
+}
+
+
+/*
+    Returns program counter
+*/
+
+uint16_t Cpu::getPc () const
+{
+    return pc;
+}
+
+
+/*
+    Set program counter
+*/
+
+void Cpu::setPc (uint16_t address)
+{
+    pc = address;
+}
+
+
+/*
+    Stop or not run() when command jumps to itself
+    Disabled when interrupts can leave the loop
+*/
+
+void Cpu::setTraps (bool enabled)
+{
+    traps = enabled;
+}
+
+
+/*
+    Set NMI line level, interrupt is taken on active edge
+*/
+
+void Cpu::nmi (bool active)
+{
+    if (active && !nmiLine)
+        pending |= PendingNmi;
+
+    nmiLine = active;
+}
+
+
+/*
+    Hold/Release interrupt request line of source
+*/
+
+void Cpu::irq (Irq source, bool active)
+{
+    if (active) {
+        irqLines |= source;
+    } else {
+        irqLines &= ~source;
+    }
+
+    if (irqLines) {
+        pending |= PendingIrq;
+    } else {
+        pending &= ~PendingIrq;
+    }
+}
+
+
+/*
+    Halt CPU for cycles (e.g. DMA)
+*/
+
+void Cpu::stall (uint16_t value)
+{
+    cycles += value;
+}
+
+
+/*
+    Push PC and status, jump to interrupt vector
+    Break flag is pushed clear to tell hardware interrupt from BRK
+*/
+
+void Cpu::interrupt (uint16_t vector)
+{
+    mem.push(s, (pc & 0xFF00) >> 8);
+    mem.push(s, (pc & 0x00FF));
+    mem.push(s, p & ~0x10);
+
+    p.setInterrupt(true);
+
+    pc  = mem.read(vector);
+    pc |= mem.read(vector + 1) << 8;
+}
+
+
+/*
+    Write registers, cycle counter and interrupt lines
+    Engine, trace and breakpoints are configuration and are kept
+*/
+
+void Cpu::save (State & state) const
+{
+    state.mark("CPU ");
+
+    state.put(a);
+    state.put(x);
+    state.put(y);
+    state.put(s);
+    state.put(uint8_t(p));
+    state.put(pc);
+
+    state.put(counter);
+    state.put(cycles);
+    state.put(jammed);
+
+    state.put(pending);
+    state.put(nmiLine);
+    state.put(irqLines);
+}
+
+
+/*
+    Read registers, cycle counter and interrupt lines
+*/
+
+void Cpu::load (State & state)
+{
+    state.check("CPU ");
+
+    uint8_t status;
+
+    state.get(a);
+    state.get(x);
+    state.get(y);
+    state.get(s);
+    state.get(status);
+    state.get(pc);
+
+    state.get(counter);
+    state.get(cycles);
+    state.get(jammed);
+
+    state.get(pending);
+    state.get(nmiLine);
+    state.get(irqLines);
+
+    p = status;
+}
+
+
+/*
+    Fork CPU on other bus, e.g. forked with Bus::fork()
+    Operand and penalty of current command are not carried,
+    fork happens between commands
+*/
+
+std::unique_ptr<Cpu> Cpu::fork (Bus & bus) const
+{
+    auto cpu = std::make_unique<Cpu>(bus);
+    cpu -> assign(*this);
+
+    return cpu;
+}
+
+
+/*
+    Take registers, interrupt lines and configuration of other CPU
+    Bus and engine caches are kept, caches of engine are per bus
+*/
+
+void Cpu::assign (const Cpu & other)
+{
+    a  = other.a;
+    x  = other.x;
+    y  = other.y;
+    s  = other.s;
+    p  = other.p;
+    pc = other.pc;
+
+    counter = other.counter;
+    trace   = other.trace;
+    jammed  = other.jammed;
+    traps   = other.traps;
+
+    pending  = other.pending;
+    nmiLine  = other.nmiLine;
+    irqLines = other.irqLines;
+
+    breakpoints = other.breakpoints;
+    breaks = other.breaks;
+    cycles = other.cycles;
+
+    setVariant(other.variant);
+    setEngine(other.engine);
+}
+
+
+/*
+    Take pending reset or interrupt
+
+    +----------+--------+--------------------------------------------+
+    | priority | vector | sequence (7 cycles)                        |
+    +----------+--------+--------------------------------------------+
+    | RESET    | $FFFC  | S decremented by 3 without writes, I set   |
+    | NMI      | $FFFA  | push PC and P (B clear), I set             |
+    | IRQ      | $FFFE  | as NMI, only while I is clear              |
+    +----------+--------+--------------------------------------------+
+
+    Held IRQ with I set stays pending and is taken once I is cleared
+*/
+
+uint8_t Cpu::service ()
 {
-    x = 0x00;
-    y = 0x00;
-    p = 0x00;
-    s = 0x00;
-    a = 0x00;
+    if (pending & PendingReset)
+    {
+        pending &= ~(PendingReset | PendingNmi);
+
+        s -= 3;
+        p.setInterrupt(true);
+
+        pc  = mem.read(0xFFFC);
+        pc |= mem.read(0xFFFD) << 8;
+
+        return 7;
+    }
+
+    if (pending & PendingNmi)
+    {
+        pending &= ~PendingNmi;
+        interrupt(0xFFFA);
+
+        return 7;
+    }
+
+    if ((pending & PendingIrq) && !p.getInterrupt())
+    {
+        interrupt(0xFFFE);
+        return 7;
+    }
+
+    return 0;
+}
+
+
+/*
+    Returns elapsed CPU cycles
+*/
+
+uint64_t Cpu::getCycles () const
+{
+    return cycles;
+}
+
+
+/*
+    Returns executed commands
+*/
+
+uint64_t Cpu::getCounter () const
+{
+    return counter;
+}
 
-    pc = 0x0000;
+
+/*
+    Returns number of commands run fused as idiom
+*/
+
+uint64_t Cpu::getFused (Fusion idiom) const
+{
+    return fusions[static_cast<uint8_t>(idiom)];
+}
+
+
+/*
+    Returns name of stop reason
+*/
+
+const char * Cpu::getReason (Stop stop)
+{
+    static const char * reasons[] = { "budget", "trap", "jam", "breakpoint" };
+    return reasons[static_cast<uint8_t>(stop)];
+}
+
+
+/*
+    Execute operation code with fused addressing mode
+
+    Mirrors Map entry by entry. Accumulator commands work
+    on register A directly, so read() and write() never have
+    to test addressing mode here.
+*/
+
+template <Cpu::Variant V, bool Decoded>
+void Cpu::execute (uint8_t code)
+{
+    switch (code)
+    {
+        // 0x00 - 0x0F
+
+        case 0x00: BRK();                       break;
+        case 0x01: INDX<Decoded>(); ORA();      break;
+        case 0x02: JAM();                       break; // *
+        case 0x03: INDX<Decoded>(); SLO();      break; // *
+        case 0x04: ZPG<Decoded>(); NOP();       break; // *
+        case 0x05: ZPG<Decoded>(); ORA();       break;
+        case 0x06: ZPG<Decoded>(); ASL();       break;
+        case 0x07: ZPG<Decoded>(); SLO();       break; // *
+        case 0x08: PHP();                       break;
+        case 0x09: IMM<Decoded>(); ORA();       break;
+        case 0x0A: ACC(); a = ASL(a);           break;
+        case 0x0B: IMM<Decoded>(); ANC();       break; // *
+        case 0x0C: ABS<Decoded>(); NOP();       break; // *
+        case 0x0D: ABS<Decoded>(); ORA();       break;
+        case 0x0E: ABS<Decoded>(); ASL();       break;
+        case 0x0F: ABS<Decoded>(); SLO();       break; // *
+
+
+        // 0x10 - 0x1F
+
+        case 0x10: REL<Decoded>(); BPL();       break;
+        case 0x11: INDY<Decoded>(); ORA();      break;
+        case 0x12: JAM();                       break; // *
+        case 0x13: INDY<Decoded>(); SLO();      break; // *
+        case 0x14: ZPGX<Decoded>(); NOP();      break; // *
+        case 0x15: ZPGX<Decoded>(); ORA();      break;
+        case 0x16: ZPGX<Decoded>(); ASL();      break;
+        case 0x17: ZPGX<Decoded>(); SLO();      break; // *
+        case 0x18: CLC();                       break;
+        case 0x19: ABSY<Decoded>(); ORA();      break;
+        case 0x1A: NOP();                       break; // *
+        case 0x1B: ABSY<Decoded>(); SLO();      break; // *
+        case 0x1C: ABSX<Decoded>(); NOP();      break; // *
+        case 0x1D: ABSX<Decoded>(); ORA();      break;
+        case 0x1E: ABSX<Decoded>(); ASL();      break;
+        case 0x1F: ABSX<Decoded>(); SLO();      break; // *
+
+
+        // 0x20 - 0x2F
+
+        case 0x20: ABS<Decoded>(); JSR();       break;
+        case 0x21: INDX<Decoded>(); AND();      break;
+        case 0x22: JAM();                       break; // *
+        case 0x23: INDX<Decoded>(); RLA();      break; // *
+        case 0x24: ZPG<Decoded>(); BIT();       break;
+        case 0x25: ZPG<Decoded>(); AND();       break;
+        case 0x26: ZPG<Decoded>(); ROL();       break;
+        case 0x27: ZPG<Decoded>(); RLA();       break; // *
+        case 0x28: PLP();                       break;
+        case 0x29: IMM<Decoded>(); AND();       break;
+        case 0x2A: ACC(); a = ROL(a);           break;
+        case 0x2B: IMM<Decoded>(); ANC();       break; // *
+        case 0x2C: ABS<Decoded>(); BIT();       break;
+        case 0x2D: ABS<Decoded>(); AND();       break;
+        case 0x2E: ABS<Decoded>(); ROL();       break;
+        case 0x2F: ABS<Decoded>(); RLA();       break; // *
+
+
+        // 0x30 - 0x3F
+
+        case 0x30: REL<Decoded>(); BMI();       break;
+        case 0x31: INDY<Decoded>(); AND();      break;
+        case 0x32: JAM();                       break; // *
+        case 0x33: INDY<Decoded>(); RLA();      break; // *
+        case 0x34: ZPGX<Decoded>(); NOP();      break; // *
+        case 0x35: ZPGX<Decoded>(); AND();      break;
+        case 0x36: ZPGX<Decoded>(); ROL();      break;
+        case 0x37: ZPGX<Decoded>(); RLA();      break; // *
+        case 0x38: SEC();                       break;
+        case 0x39: ABSY<Decoded>(); AND();      break;
+        case 0x3A: NOP();                       break; // *
+        case 0x3B: ABSY<Decoded>(); RLA();      break; // *
+        case 0x3C: ABSX<Decoded>(); NOP();      break; // *
+        case 0x3D: ABSX<Decoded>(); AND();      break;
+        case 0x3E: ABSX<Decoded>(); ROL();      break;
+        case 0x3F: ABSX<Decoded>(); RLA();      break; // *
+
+
+        // 0x40 - 0x4F
+
+        case 0x40: RTI();                       break;
+        case 0x41: INDX<Decoded>(); EOR();      break;
+        case 0x42: JAM();                       break; // *
+        case 0x43: INDX<Decoded>(); SRE();      break; // *
+        case 0x44: ZPG<Decoded>(); NOP();       break; // *
+        case 0x45: ZPG<Decoded>(); EOR();       break;
+        case 0x46: ZPG<Decoded>(); LSR();       break;
+        case 0x47: ZPG<Decoded>(); SRE();       break; // *
+        case 0x48: PHA();                       break;
+        case 0x49: IMM<Decoded>(); EOR();       break;
+        case 0x4A: ACC(); a = LSR(a);           break;
+        case 0x4B: IMM<Decoded>(); ALR();       break; // *
+        case 0x4C: ABS<Decoded>(); JMP();       break;
+        case 0x4D: ABS<Decoded>(); EOR();       break;
+        case 0x4E: ABS<Decoded>(); LSR();       break;
+        case 0x4F: ABS<Decoded>(); SRE();       break; // *
+
+
+        // 0x50 - 0x5F
+
+        case 0x50: REL<Decoded>(); BVC();       break;
+        case 0x51: INDY<Decoded>(); EOR();      break;
+        case 0x52: JAM();                       break; // *
+        case 0x53: INDY<Decoded>(); SRE();      break; // *
+        case 0x54: ZPGX<Decoded>(); NOP();      break; // *
+        case 0x55: ZPGX<Decoded>(); EOR();      break;
+        case 0x56: ZPGX<Decoded>(); LSR();      break;
+        case 0x57: ZPGX<Decoded>(); SRE();      break; // *
+        case 0x58: CLI();                       break;
+        case 0x59: ABSY<Decoded>(); EOR();      break;
+        case 0x5A: NOP();                       break; // *
+        case 0x5B: ABSY<Decoded>(); SRE();      break; // *
+        case 0x5C: ABSX<Decoded>(); NOP();      break; // *
+        case 0x5D: ABSX<Decoded>(); EOR();      break;
+        case 0x5E: ABSX<Decoded>(); LSR();      break;
+        case 0x5F: ABSX<Decoded>(); SRE();      break; // *
+
+
+        // 0x60 - 0x6F
+
+        case 0x60: RTS();                       break;
+        case 0x61: INDX<Decoded>(); ADC<V>();   break;
+        case 0x62: JAM();                       break; // *
+        case 0x63: INDX<Decoded>(); RRA();      break; // *
+        case 0x64: ZPG<Decoded>(); NOP();       break; // *
+        case 0x65: ZPG<Decoded>(); ADC<V>();    break;
+        case 0x66: ZPG<Decoded>(); ROR();       break;
+        case 0x67: ZPG<Decoded>(); RRA();       break; // *
+        case 0x68: PLA();                       break;
+        case 0x69: IMM<Decoded>(); ADC<V>();    break;
+        case 0x6A: ACC(); a = ROR(a);           break;
+        case 0x6B: IMM<Decoded>(); ARR();       break; // *
+        case 0x6C: IND<Decoded>(); JMP();       break;
+        case 0x6D: ABS<Decoded>(); ADC<V>();    break;
+        case 0x6E: ABS<Decoded>(); ROR();       break;
+        case 0x6F: ABS<Decoded>(); RRA();       break; // *
+
+
+        // 0x70 - 0x7F
+
+        case 0x70: REL<Decoded>(); BVS();       break;
+        case 0x71: INDY<Decoded>(); ADC<V>();   break;
+        case 0x72: JAM();                       break; // *
+        case 0x73: INDY<Decoded>(); RRA();      break; // *
+        case 0x74: ZPGX<Decoded>(); NOP();      break; // *
+        case 0x75: ZPGX<Decoded>(); ADC<V>();   break;
+        case 0x76: ZPGX<Decoded>(); ROR();      break;
+        case 0x77: ZPGX<Decoded>(); RRA();      break; // *
+        case 0x78: SEI();                       break;
+        case 0x79: ABSY<Decoded>(); ADC<V>();   break;
+        case 0x7A: NOP();                       break; // *
+        case 0x7B: ABSY<Decoded>(); RRA();      break; // *
+        case 0x7C: ABSX<Decoded>(); NOP();      break; // *
+        case 0x7D: ABSX<Decoded>(); ADC<V>();   break;
+        case 0x7E: ABSX<Decoded>(); ROR();      break;
+        case 0x7F: ABSX<Decoded>(); RRA();      break; // *
+
+
+        // 0x80 - 0x8F
+
+        case 0x80: IMM<Decoded>(); NOP();       break; // *
+        case 0x81: INDX<Decoded>(); STA();      break;
+        case 0x82: IMM<Decoded>(); NOP();       break; // *
+        case 0x83: INDX<Decoded>(); SAX();      break; // *
+        case 0x84: ZPG<Decoded>(); STY();       break;
+        case 0x85: ZPG<Decoded>(); STA();       break;
+        case 0x86: ZPG<Decoded>(); STX();       break;
+        case 0x87: ZPG<Decoded>(); SAX();       break; // *
+        case 0x88: DEY();                       break;
+        case 0x89: IMM<Decoded>(); NOP();       break; // *
+        case 0x8A: TXA();                       break;
+        case 0x8B: IMM<Decoded>(); ANE();       break; // *
+        case 0x8C: ABS<Decoded>(); STY();       break;
+        case 0x8D: ABS<Decoded>(); STA();       break;
+        case 0x8E: ABS<Decoded>(); STX();       break;
+        case 0x8F: ABS<Decoded>(); SAX();       break; // *
+
+
+        // 0x90 - 0x9F
+
+        case 0x90: REL<Decoded>(); BCC();       break;
+        case 0x91: INDY<Decoded>(); STA();      break;
+        case 0x92: JAM();                       break; // *
+        case 0x93: INDY<Decoded>(); SHA();      break; // *
+        case 0x94: ZPGX<Decoded>(); STY();      break;
+        case 0x95: ZPGX<Decoded>(); STA();      break;
+        case 0x96: ZPGY<Decoded>(); STX();      break;
+        case 0x97: ZPGY<Decoded>(); SAX();      break; // *
+        case 0x98: TYA();                       break;
+        case 0x99: ABSY<Decoded>(); STA();      break;
+        case 0x9A: TXS();                       break;
+        case 0x9B: ABSY<Decoded>(); TAS();      break; // *
+        case 0x9C: ABSX<Decoded>(); SHY();      break; // *
+        case 0x9D: ABSX<Decoded>(); STA();      break;
+        case 0x9E: ABSY<Decoded>(); SHX();      break; // *
+        case 0x9F: ABSY<Decoded>(); SHA();      break; // *
+
+
+        // 0xA0 - 0xAF
+
+        case 0xA0: IMM<Decoded>(); LDY();       break;
+        case 0xA1: INDX<Decoded>(); LDA();      break;
+        case 0xA2: IMM<Decoded>(); LDX();       break;
+        case 0xA3: INDX<Decoded>(); LAX();      break; // *
+        case 0xA4: ZPG<Decoded>(); LDY();       break;
+        case 0xA5: ZPG<Decoded>(); LDA();       break;
+        case 0xA6: ZPG<Decoded>(); LDX();       break;
+        case 0xA7: ZPG<Decoded>(); LAX();       break; // *
+        case 0xA8: TAY();                       break;
+        case 0xA9: IMM<Decoded>(); LDA();       break;
+        case 0xAA: TAX();                       break;
+        case 0xAB: IMM<Decoded>(); LXA();       break; // *
+        case 0xAC: ABS<Decoded>(); LDY();       break;
+        case 0xAD: ABS<Decoded>(); LDA();       break;
+        case 0xAE: ABS<Decoded>(); LDX();       break;
+        case 0xAF: ABS<Decoded>(); LAX();       break; // *
+
+
+        // 0xB0 - 0xBF
+
+        case 0xB0: REL<Decoded>(); BCS();       break;
+        case 0xB1: INDY<Decoded>(); LDA();      break;
+        case 0xB2: JAM();                       break; // *
+        case 0xB3: INDY<Decoded>(); LAX();      break; // *
+        case 0xB4: ZPGX<Decoded>(); LDY();      break;
+        case 0xB5: ZPGX<Decoded>(); LDA();      break;
+        case 0xB6: ZPGY<Decoded>(); LDX();      break;
+        case 0xB7: ZPGY<Decoded>(); LAX();      break; // *
+        case 0xB8: CLV();                       break;
+        case 0xB9: ABSY<Decoded>(); LDA();      break;
+        case 0xBA: TSX();                       break;
+        case 0xBB: ABSY<Decoded>(); LAS();      break; // *
+        case 0xBC: ABSX<Decoded>(); LDY();      break;
+        case 0xBD: ABSX<Decoded>(); LDA();      break;
+        case 0xBE: ABSY<Decoded>(); LDX();      break;
+        case 0xBF: ABSY<Decoded>(); LAX();      break; // *
+
+
+        // 0xC0 - 0xCF
+
+        case 0xC0: IMM<Decoded>(); CPY();       break;
+        case 0xC1: INDX<Decoded>(); CMP();      break;
+        case 0xC2: IMM<Decoded>(); NOP();       break; // *
+        case 0xC3: INDX<Decoded>(); DCP();      break; // *
+        case 0xC4: ZPG<Decoded>(); CPY();       break;
+        case 0xC5: ZPG<Decoded>(); CMP();       break;
+        case 0xC6: ZPG<Decoded>(); DEC();       break;
+        case 0xC7: ZPG<Decoded>(); DCP();       break; // *
+        case 0xC8: INY();                       break;
+        case 0xC9: IMM<Decoded>(); CMP();       break;
+        case 0xCA: DEX();                       break;
+        case 0xCB: IMM<Decoded>(); SBX();       break; // *
+        case 0xCC: ABS<Decoded>(); CPY();       break;
+        case 0xCD: ABS<Decoded>(); CMP();       break;
+        case 0xCE: ABS<Decoded>(); DEC();       break;
+        case 0xCF: ABS<Decoded>(); DCP();       break; // *
+
+
+        // 0xD0 - 0xDF
+
+        case 0xD0: REL<Decoded>(); BNE();       break;
+        case 0xD1: INDY<Decoded>(); CMP();      break;
+        case 0xD2: JAM();                       break; // *
+        case 0xD3: INDY<Decoded>(); DCP();      break; // *
+        case 0xD4: ZPGX<Decoded>(); NOP();      break; // *
+        case 0xD5: ZPGX<Decoded>(); CMP();      break;
+        case 0xD6: ZPGX<Decoded>(); DEC();      break;
+        case 0xD7: ZPGX<Decoded>(); DCP();      break; // *
+        case 0xD8: CLD();                       break;
+        case 0xD9: ABSY<Decoded>(); CMP();      break;
+        case 0xDA: NOP();                       break; // *
+        case 0xDB: ABSY<Decoded>(); DCP();      break; // *
+        case 0xDC: ABSX<Decoded>(); NOP();      break; // *
+        case 0xDD: ABSX<Decoded>(); CMP();      break;
+        case 0xDE: ABSX<Decoded>(); DEC();      break;
+        case 0xDF: ABSX<Decoded>(); DCP();      break; // *
+
+
+        // 0xE0 - 0xEF
+
+        case 0xE0: IMM<Decoded>(); CPX();       break;
+        case 0xE1: INDX<Decoded>(); SBC<V>();   break;
+        case 0xE2: IMM<Decoded>(); NOP();       break; // *
+        case 0xE3: INDX<Decoded>(); ISC();      break; // *
+        case 0xE4: ZPG<Decoded>(); CPX();       break;
+        case 0xE5: ZPG<Decoded>(); SBC<V>();    break;
+        case 0xE6: ZPG<Decoded>(); INC();       break;
+        case 0xE7: ZPG<Decoded>(); ISC();       break; // *
+        case 0xE8: INX();                       break;
+        case 0xE9: IMM<Decoded>(); SBC<V>();    break;
+        case 0xEA: NOP();                       break;
+        case 0xEB: IMM<Decoded>(); USB();       break; // *
+        case 0xEC: ABS<Decoded>(); CPX();       break;
+        case 0xED: ABS<Decoded>(); SBC<V>();    break;
+        case 0xEE: ABS<Decoded>(); INC();       break;
+        case 0xEF: ABS<Decoded>(); ISC();       break; // *
+
+
+        // 0xF0 - 0xFF
+
+        case 0xF0: REL<Decoded>(); BEQ();       break;
+        case 0xF1: INDY<Decoded>(); SBC<V>();   break;
+        case 0xF2: JAM();                       break; // *
+        case 0xF3: INDY<Decoded>(); ISC();      break; // *
+        case 0xF4: ZPGX<Decoded>(); NOP();      break; // *
+        case 0xF5: ZPGX<Decoded>(); SBC<V>();   break;
+        case 0xF6: ZPGX<Decoded>(); INC();      break;
+        case 0xF7: ZPGX<Decoded>(); ISC();      break; // *
+        case 0xF8: SED();                       break;
+        case 0xF9: ABSY<Decoded>(); SBC<V>();   break;
+        case 0xFA: NOP();                       break; // *
+        case 0xFB: ABSY<Decoded>(); ISC();      break; // *
+        case 0xFC: ABSX<Decoded>(); NOP();      break; // *
+        case 0xFD: ABSX<Decoded>(); SBC<V>();   break;
+        case 0xFE: ABSX<Decoded>(); INC();      break;
+        case 0xFF: ABSX<Decoded>(); ISC();      break; // *
+    }
+}
+
+
+/*
+    Select instruction dispatch engine
+*/
+
+void Cpu::setEngine (Engine value)
+{
+    engine = value;
+    acc = false;
+
+    if (engine == Engine::Cache && !decoder)
+        decoder = std::make_unique<Decoder>(mem.getBus(), variant);
+}
+
+
+/*
+    Select processor variant
+*/
+
+void Cpu::setVariant (Variant value)
+{
+    // Linked blocks and predecoded handlers are kept for running variant
+    if (variant != value)
+    {
+        aot.reset();
+        decoder.reset();
+    }
+
+    variant = value;
+
+    if (engine == Engine::Cache && !decoder)
+        decoder = std::make_unique<Decoder>(mem.getBus(), variant);
+}
+
+
+/*
+    Returns processor variant
+*/
+
+Cpu::Variant Cpu::getVariant () const
+{
+    return variant;
+}
+
+
+/*
+    Assert RESET
+
+    Registers keep their values, reset sequence runs before
+    next command and also releases CPU frozen by JAM
+*/
+
+void Cpu::reset ()
+{
+    pending |= PendingReset;
+    jammed = false;
 }
 
 
@@ -119,12 +1166,17 @@ void Cpu::reset ()
     ing is required.
 */
 
+template <bool Decoded>
 void Cpu::IMM () 
 { 
     // OPC #$BB
     // Operand is byte BB
 
-    op = pc++;
+    if constexpr (Decoded) {
+        op = base;
+    } else {
+        op = pc++;
+    }
 }
 
 
@@ -138,12 +1190,13 @@ void Cpu::IMM ()
     64K bytes of addressable memory.
 */
 
+template <bool Decoded>
 void Cpu::ABS () 
 {
     // OPC $LLHH	
     // Operand is address $HHLL
 
-    op = mem -> abs(pc);
+    op = Decoded ? base : mem.abs(pc);
 }
 
 
@@ -162,23 +1215,25 @@ void Cpu::ABS ()
     time. 
 */
 
+template <bool Decoded>
 void Cpu::ABSX () 
 { 
     // OPC $LLHH,X	
     // Operand is address; 
     // Effective address is address incremented by X with carry
 
-    op = mem -> abs(pc, x);
+    index(Decoded ? base : mem.abs(pc), x);
 }
 
 
+template <bool Decoded>
 void Cpu::ABSY () 
 { 
     // OPC $LLHH,Y	
     // Operand is address; 
     // Effective address is address incremented by Y with carry
 
-    op = mem -> abs(pc, y);
+    index(Decoded ? base : mem.abs(pc), y);
 }
 
 
@@ -192,12 +1247,13 @@ void Cpu::ABSY ()
     code efficiency. 
 */
 
+template <bool Decoded>
 void Cpu::ZPG () 
 {
     // OPC $LL
     // Operand is zeropage address (hi-byte is zero, address = $00LL)
 
-    op = mem -> zpg(pc);
+    op = Decoded ? base : mem.zpg(pc);
 }
 
 
@@ -215,23 +1271,25 @@ void Cpu::ZPG ()
     crossing of page boundaries does not occur. 
 */
 
+template <bool Decoded>
 void Cpu::ZPGX () 
 { 
     // OPC $LL,X	
     // Operand is zeropage address; 
     // Effective address is address incremented by X without carry
 
-    op = mem -> zpg(pc, x);
+    op = Decoded ? 0x00FF & (base + x) : mem.zpg(pc, x);
 }
 
 
+template <bool Decoded>
 void Cpu::ZPGY () 
 { 
     // OPC $LL,Y	
     // Operand is zeropage address; 
     // Effective address is address incremented by Y without carry
 
-    op = mem -> zpg(pc, y);
+    op = Decoded ? 0x00FF & (base + y) : mem.zpg(pc, y);
 }
 
 
@@ -278,13 +1336,19 @@ void Cpu::ACC ()
     counter. 
 */
 
+template <bool Decoded>
 void Cpu::IND () 
 {
     // OPC ($LLHH)	
     // Operand is address; 
     // Effective address is contents of word at address: C.w($HHLL)
 
-    op = mem -> indirect(pc);
+    if constexpr (Decoded) {
+        auto index = base;
+        op = mem.direct(index);
+    } else {
+        op = mem.indirect(pc);
+    }
 }
 
 
@@ -299,13 +1363,14 @@ void Cpu::IND ()
     order eight bits of the effective address. 
 */
 
+template <bool Decoded>
 void Cpu::INDX () 
 { 
     // OPC ($LL,X)	
     // Operand is zeropage address; 
     // Effective address is word in (LL + X, LL + X + 1), inc. without carry: C.w($00LL + X)
 
-    op = mem -> indexed(pc, x);
+    op = Decoded ? mem.pointer(base + x) : mem.indexed(pc, x);
 }
 
 
@@ -322,13 +1387,14 @@ void Cpu::INDX ()
     eight bits of the effective address. 
 */
 
+template <bool Decoded>
 void Cpu::INDY () 
 {
     // OPC ($LL),Y	
     // Operand is zeropage address; 
     // Effective address is word in (LL, LL + 1) incremented by Y with carry: C.w($00LL) + Y
 
-    op = mem -> indexed(pc) + y;
+    index(Decoded ? mem.pointer(base) : mem.indexed(pc), y);
 }
 
 
@@ -344,9 +1410,35 @@ void Cpu::INDY ()
     from the next instruction. 
 */
 
+template <bool Decoded>
 void Cpu::REL () 
 { 
-    IMM();
+    IMM<Decoded>();
+}
+
+
+// Fetching modes are taken by Cmd
+template void Cpu::IMM<false>();
+template void Cpu::ABS<false>();
+template void Cpu::ABSX<false>();
+template void Cpu::ABSY<false>();
+template void Cpu::ZPG<false>();
+template void Cpu::ZPGX<false>();
+template void Cpu::ZPGY<false>();
+template void Cpu::IND<false>();
+template void Cpu::INDX<false>();
+template void Cpu::INDY<false>();
+template void Cpu::REL<false>();
+
+
+/*
+    Set indexed operand address and test page crossing
+*/
+
+void Cpu::index (uint16_t base, uint8_t rg)
+{
+    op = base + rg;
+    crossed = (base ^ op) & 0xFF00;
 }
 
 
@@ -357,14 +1449,43 @@ void Cpu::ADC (uint8_t arg)
 {
     uint16_t sum = (uint16_t) a + (uint16_t) arg + p.getCarry();
 
-    p.setNegative (sum);
-    p.setZero     (sum);
+    p.setNegativeZero (sum);
     p.setCarry    ((bool) (sum > 255));
     p.setOverflow ((bool) (~(a ^ arg) & (a ^ sum) & 0x80));
 
     a = 0x00FF & sum;
 }
 
+/*
+    Decimal mode ADC of NMOS 6502
+
+    Digits are adjusted one by one. Z is taken from binary sum,
+    N and V from sum with only low digit adjusted, C from result.
+*/
+
+void Cpu::ADCD (uint8_t arg)
+{
+    uint8_t carry = p.getCarry();
+
+    uint16_t low = (a & 0x0F) + (arg & 0x0F) + carry;
+
+    if (low > 0x09)
+        low = ((low + 0x06) & 0x0F) + 0x10;
+
+    uint16_t sum = (a & 0xF0) + (arg & 0xF0) + low;
+
+    p.setZero     ((uint8_t) (a + arg + carry));
+    p.setNegative ((uint8_t) sum);
+    p.setOverflow ((bool) (~(a ^ arg) & (a ^ sum) & 0x80));
+
+    if (sum > 0x9F)
+        sum += 0x60;
+
+    p.setCarry ((bool) (sum > 255));
+
+    a = 0x00FF & sum;
+}
+
 /*
     ADC
     Add Memory to Accumulator with Carry
@@ -384,12 +1505,24 @@ void Cpu::ADC (uint8_t arg)
     | (indirect),Y | ADC (oper),Y | 71  | 2     | 5*     |
     +--------------+--------------+-----+-------+--------+
 */
+template <Cpu::Variant V>
 void Cpu::ADC() 
 { 
     auto data = read();
+
+    // Compiled out of 2A03 loop
+    if constexpr (V != Variant::Ricoh2A03)
+    {
+        if (p.isDecimal())
+            return ADCD(data);
+    }
+
     ADC(data); 
 }
 
+template void Cpu::ADC<Cpu::Variant::Ricoh2A03>();
+template void Cpu::ADC<Cpu::Variant::Nmos6502>();
+
 
 /*
     ALR (ASR)
@@ -449,8 +1582,7 @@ void Cpu::AND()
 { 
     a &= read();
 
-    p.setZero(a);
-    p.setNegative(a);
+    p.setNegativeZero(a);
 }
 
 
@@ -522,14 +1654,20 @@ void Cpu::ARR()
 */
 void Cpu::ASL() 
 {
-    uint8_t data  = read();
+    write(ASL(read()));
+}
+
+/*
+    Shift data left one bit and return result
+*/
+uint8_t Cpu::ASL(uint8_t data)
+{
     uint8_t shift = data << 1;
 
-    p.setNegative (shift);
-    p.setZero     (shift);
+    p.setNegativeZero (shift);
     p.setCarry    ((bool) (data & 0x80));
 
-    write(shift);
+    return shift;
 }
 
 
@@ -543,7 +1681,12 @@ void Cpu::ASL()
 */
 void Cpu::BRA()
 {
-    pc += (int8_t) read();
+    uint16_t next = pc + (int8_t) read();
+
+    // Taken branch adds a cycle, one more if it lands on another page
+    penalty += ((pc ^ next) & 0xFF00) ? 2 : 1;
+
+    pc = next;
 }
 
 
@@ -730,14 +1873,14 @@ void Cpu::BRK()
     uint8_t hi = (pc & 0xFF00) >> 8;
 
     // Push program counter
-    mem -> push(s, hi);
-    mem -> push(s, lo);
+    mem.push(s, hi);
+    mem.push(s, lo);
     
     // Push status register
-    mem -> push(s, p);
+    mem.push(s, p);
 
-    pc  = mem -> read(0xFFFE);
-    pc |= mem -> read(0xFFFF) << 8;
+    pc  = mem.read(0xFFFE);
+    pc |= mem.read(0xFFFF) << 8;
 
     p.setInterrupt (true);
 }
@@ -984,8 +2127,7 @@ void Cpu::DEC()
 
     data--;
 
-    p.setNegative (data);
-    p.setZero     (data);
+    p.setNegativeZero (data);
 
     write((uint8_t) data);
 }
@@ -1007,8 +2149,7 @@ void Cpu::DEX()
 { 
     x--;
 
-    p.setNegative (x);
-    p.setZero     (x);
+    p.setNegativeZero (x);
 }
 
 
@@ -1028,8 +2169,7 @@ void Cpu::DEY()
 { 
     y--;
 
-    p.setNegative (y);
-    p.setZero     (y); 
+    p.setNegativeZero (y); 
 }
 
 
@@ -1056,8 +2196,7 @@ void Cpu::EOR()
 { 
     a ^= read();
 
-    p.setNegative (a);
-    p.setZero     (a);
+    p.setNegativeZero (a);
 }
 
 
@@ -1082,8 +2221,7 @@ void Cpu::INC()
 
     data++;
 
-    p.setNegative (data);
-    p.setZero     (data);
+    p.setNegativeZero (data);
 
     write((uint8_t) data);
 }
@@ -1105,8 +2243,7 @@ void Cpu::INX()
 { 
     x++;
 
-    p.setNegative (x);
-    p.setZero     (x);
+    p.setNegativeZero (x);
 }
 
 
@@ -1126,8 +2263,7 @@ void Cpu::INY()
 { 
     y++;
 
-    p.setNegative (y);
-    p.setZero     (y);
+    p.setNegativeZero (y);
 }
 
 
@@ -1166,7 +2302,9 @@ void Cpu::ISC()
 */
 void Cpu::JAM() 
 { 
-    NOP();
+    // Stay on this command until reset
+    pc--;
+    jammed = true;
 }
 
 
@@ -1211,8 +2349,8 @@ void Cpu::JSR()
     uint8_t lo = (0x00FF & pc);
     uint8_t hi = (0xFF00 & pc) >> 8; 
 
-    mem -> push(s, hi);
-    mem -> push(s, lo);
+    mem.push(s, hi);
+    mem.push(s, lo);
 
     JMP();
 }
@@ -1282,8 +2420,7 @@ void Cpu::LDA()
 { 
     a = read();
 
-    p.setNegative (a);
-    p.setZero     (a);
+    p.setNegativeZero (a);
 }
 
 
@@ -1307,8 +2444,7 @@ void Cpu::LDX()
 { 
     x = read();
 
-    p.setNegative (x);
-    p.setZero     (x);
+    p.setNegativeZero (x);
 }
 
 
@@ -1332,8 +2468,7 @@ void Cpu::LDY()
 { 
     y = read();
 
-    p.setNegative (y);
-    p.setZero     (y);
+    p.setNegativeZero (y);
 }
 
 
@@ -1354,15 +2489,21 @@ void Cpu::LDY()
     +-------------+------------+-----+-------+--------+
 */
 void Cpu::LSR() 
-{ 
-    uint8_t data  = read();
+{
+    write(LSR(read()));
+}
+
+/*
+    Shift data right one bit and return result
+*/
+uint8_t Cpu::LSR(uint8_t data)
+{
     uint8_t shift = data >> 1; 
 
-    p.setNegative (shift);
-    p.setZero     (shift);
+    p.setNegativeZero (shift);
     p.setCarry    ((bool) (data & 0x01));
 
-    write (shift);
+    return shift;
 }
 
 
@@ -1423,8 +2564,7 @@ void Cpu::ORA()
 { 
     a |= read();
 
-    p.setNegative (a);
-    p.setZero     (a);
+    p.setNegativeZero (a);
 }
 
 
@@ -1442,7 +2582,7 @@ void Cpu::ORA()
 */
 void Cpu::PHA() 
 { 
-    mem -> push(s, a);
+    mem.push(s, a);
 }
 
 
@@ -1463,7 +2603,7 @@ void Cpu::PHA()
 */
 void Cpu::PHP() 
 { 
-    mem -> push(s, p);
+    mem.push(s, p);
 
     p.setBreak(false);
 }
@@ -1483,10 +2623,9 @@ void Cpu::PHP()
 */
 void Cpu::PLA() 
 { 
-    a = mem -> pop(s);
+    a = mem.pop(s);
 
-    p.setNegative (a);
-    p.setZero     (a);
+    p.setNegativeZero (a);
 }
 
 
@@ -1507,7 +2646,7 @@ void Cpu::PLA()
 */
 void Cpu::PLP() 
 { 
-    p = mem -> pop(s);
+    p = mem.pop(s);
 }
 
 
@@ -1552,15 +2691,21 @@ void Cpu::RLA()
     +-------------+------------+-----+-------+--------+
 */
 void Cpu::ROL() 
-{ 
-    uint8_t data  = read();
+{
+    write(ROL(read()));
+}
+
+/*
+    Rotate data left one bit through carry and return result
+*/
+uint8_t Cpu::ROL(uint8_t data)
+{
     uint8_t shift = (data << 1) | p.getCarry();
 
-    p.setNegative (shift);
-    p.setZero     (shift);
+    p.setNegativeZero (shift);
     p.setCarry    ((bool) (data & 0x80));
 
-    write (shift);
+    return shift;
 }
 
 
@@ -1581,15 +2726,21 @@ void Cpu::ROL()
     +-------------+------------+-----+-------+--------+
 */
 void Cpu::ROR() 
-{ 
-    uint8_t data  = read();
+{
+    write(ROR(read()));
+}
+
+/*
+    Rotate data right one bit through carry and return result
+*/
+uint8_t Cpu::ROR(uint8_t data)
+{
     uint8_t shift = (data >> 1) | (p.getCarry() << 7);
 
-    p.setNegative (shift);
-    p.setZero     (shift);
+    p.setNegativeZero (shift);
     p.setCarry    ((bool) (data & 0x01));
 
-    write (shift);
+    return shift;
 }
 
 
@@ -1636,10 +2787,10 @@ void Cpu::RRA()
 */
 void Cpu::RTI() 
 { 
-    p   = mem -> pop(s); 
+    p   = mem.pop(s); 
 
-    pc  = mem -> pop(s);
-    pc |= mem -> pop(s) << 8;
+    pc  = mem.pop(s);
+    pc |= mem.pop(s) << 8;
 
     p.setBreak(false);
 }
@@ -1659,8 +2810,8 @@ void Cpu::RTI()
 */
 void Cpu::RTS() 
 { 
-    pc  = mem -> pop(s);
-    pc |= mem -> pop(s) << 8;
+    pc  = mem.pop(s);
+    pc |= mem.pop(s) << 8;
 
     pc++;   
 }
@@ -1707,12 +2858,49 @@ void Cpu::SAX()
     | (indirect),Y | SBC (oper),Y | F1  | 2     | 5*     |
     +--------------+--------------+-----+-------+--------+
 */
+template <Cpu::Variant V>
 void Cpu::SBC() 
 { 
     auto data = read();
+
+    // Compiled out of 2A03 loop
+    if constexpr (V != Variant::Ricoh2A03)
+    {
+        if (p.isDecimal())
+            return SBCD(data);
+    }
+
     ADC(~data); 
 }
 
+template void Cpu::SBC<Cpu::Variant::Ricoh2A03>();
+template void Cpu::SBC<Cpu::Variant::Nmos6502>();
+
+
+/*
+    Decimal mode SBC of NMOS 6502
+
+    Flags are the same as of binary subtraction,
+    only accumulator is decimal adjusted.
+*/
+
+void Cpu::SBCD (uint8_t arg)
+{
+    int low = (a & 0x0F) - (arg & 0x0F) + p.getCarry() - 1;
+
+    if (low < 0)
+        low = ((low - 0x06) & 0x0F) - 0x10;
+
+    int diff = (a & 0xF0) - (arg & 0xF0) + low;
+
+    if (diff < 0)
+        diff -= 0x60;
+
+    ADC(~arg);
+
+    a = 0x00FF & diff;
+}
+
 
 /*
     SBX (AXS, SAX)
@@ -2004,8 +3192,7 @@ void Cpu::TAX()
 { 
     x = a;
 
-    p.setNegative(x);
-    p.setZero    (x);
+    p.setNegativeZero(x);
 }
 
 
@@ -2025,8 +3212,7 @@ void Cpu::TAY()
 {
     y = a;
 
-    p.setNegative(y);
-    p.setZero    (y);
+    p.setNegativeZero(y);
 }
 
 
@@ -2046,8 +3232,7 @@ void Cpu::TSX()
 { 
     x = s;
 
-    p.setNegative(x);
-    p.setZero    (x);
+    p.setNegativeZero(x);
 }
 
 
@@ -2067,8 +3252,7 @@ void Cpu::TXA()
 { 
     a = x;
 
-    p.setNegative(a);
-    p.setZero    (a);
+    p.setNegativeZero(a);
 }
 
 
@@ -2106,8 +3290,7 @@ void Cpu::TYA()
 { 
     a = y;
 
-    p.setNegative(a);
-    p.setZero    (a);
+    p.setNegativeZero(a);
 }
 
 
@@ -20,16 +20,25 @@
 
 #include <memory>
 #include <array>
+#include <bitset>
 #include <cstdint>
 #include <string>
+#include <utility>
 
+#include "log.h"
+#include "lazy.h"
 #include "status.h"
+#include "cpu/mem.h"
 
 class Cmd;
-class Log;
+class State;
 class Map;
-class Mem;
-class Bus;
+class Jit;
+class Aot;
+class Decoder;
+class Lockstep;
+
+template <uint32_t Rom> class Compiled;
 
 //
 // MOS Technology 6502
@@ -42,6 +51,126 @@ private:
     friend class Cmd;
     friend class Log;
     friend class Map;
+    friend class Jit;
+    friend class Aot;
+    friend class Lockstep;
+
+    // Blocks of ROM translated by nes-aot
+    template <uint32_t Rom> friend class Compiled;
+
+public:
+
+    //
+    // Instruction dispatch engine
+    //
+    //      Table   Opcode is looked up in Map and executed through the
+    //              addressing mode and command pointers of Cmd
+    //
+    //      Switch  Opcode is dispatched by a single switch where addressing
+    //              mode and command are fused per opcode, so both calls can
+    //              be inlined by the compiler
+    //
+    //      Cache   Commands predecoded per address keep handler of their
+    //              operation code, so a command running again skips fetch,
+    //              operand decoding and dispatch switch
+    //
+    //      Aot     Blocks translated to C++ by nes-aot and linked into the
+    //              executable, other commands and traced or breakpoint runs
+    //              are left to Switch
+    //
+    //      Jit     Basic blocks are translated to host code, other commands
+    //              and traced or breakpoint runs are left to Switch
+    //
+
+    enum class Engine : uint8_t
+    {
+        Table,
+        Switch,
+        Cache,
+        Aot,
+
+        #ifdef JIT
+        Jit
+        #endif
+    };
+
+    //
+    // Processor variant, fixed per instantiation of the command loop
+    //
+    //      Ricoh2A03   NES CPU, decimal flag is kept but ADC/SBC are always
+    //                  binary, so BCD path is not compiled into its loop
+    //
+    //      Nmos6502    Generic NMOS 6502 with decimal mode ADC/SBC
+    //
+
+    enum class Variant : uint8_t
+    {
+        Ricoh2A03,
+        Nmos6502
+    };
+
+    //
+    // Reason of run() return
+    //
+    //      Budget      Cycle budget is exhausted
+    //      Trap        Command jumped to itself (e.g. JMP * or BNE *)
+    //      Jam         CPU is frozen by JAM, reset required
+    //      Breakpoint  PC reached breakpoint address
+    //
+
+    enum class Stop : uint8_t
+    {
+        Budget,
+        Trap,
+        Jam,
+        Breakpoint
+    };
+
+    //
+    // Interrupt request sources
+    //
+    //      IRQ line is wired-OR, so each source holds its own bit
+    //      and interrupt is taken while any bit is set and I is clear
+    //
+
+    enum Irq : uint8_t
+    {
+        FrameIrq  = 1 << 0,
+        DmcIrq    = 1 << 1,
+        MapperIrq = 1 << 2
+    };
+
+    //
+    // Command pairs run by Cache engine as one fused handler
+    //
+    //      Most frequent pairs of guest loops, both commands are predecoded
+    //      together and counted, timed and flagged as if run one by one
+    //
+    //      LdaSta  LDA #, zeropage or absolute, then STA zeropage or absolute
+    //      CmpBne  CMP #, zeropage or absolute, then BNE
+    //      DexBne  DEX, then BNE
+    //      DeyBne  DEY, then BNE
+    //      IncBne  INC zeropage, then BNE
+    //
+
+    enum class Fusion : uint8_t
+    {
+        None,
+        LdaSta,
+        CmpBne,
+        DexBne,
+        DeyBne,
+        IncBne
+    };
+
+    // Predecoded command of Cache engine, takes static operand address and returns cycles
+    using Handler = uint8_t (Cpu::*) (uint16_t);
+
+    /*
+        Returns handler of predecoded operation code for variant
+    */
+    template <Variant V>
+    static Handler getHandler (uint8_t code);
 
 private:
     //
@@ -101,8 +230,15 @@ private:
     //      instructions. Setting the flags is possible by pulling the P register from stack
     //      or by using the flag set or clear instructions.
     //
+    //      With LAZY_FLAGS the register keeps flag sources and
+    //      derives N, Z, C and V only when they are read.
+    //
 
-    Status p {};
+    #ifdef LAZY_FLAGS
+        LazyStatus p {};
+    #else
+        Status p {};
+    #endif
 
     //
     // OP   Current operand (Example: ADD #OP)
@@ -126,38 +262,116 @@ private:
     uint16_t pc = 0x0400;
 
 
-    // 6502 instruction mapping (mnemonic table)
-    // Includes all common/undocumented instructions
-    std::unique_ptr<Map> map;
-
     // Addressing memory
-    std::unique_ptr<Mem> mem;
+    Mem mem;
 
     // Disassembler
-    std::unique_ptr<Log> log;
+    Log log;
+
+    // Current command uses accumulator addressing
+    bool acc = false;
 
-    // Current processed command
-    const Cmd * cmd;
+    // Selected dispatch engine
+    Engine engine = Engine::Table;
 
-    uint32_t counter = 0;
+    // Selected processor variant
+    Variant variant = Variant::Ricoh2A03;
+
+    // Predecoded commands of Cache engine
+    std::unique_ptr<Decoder> decoder;
+
+    // Linked blocks of running variant, created on first run of Aot engine
+    std::unique_ptr<Aot> aot;
+
+    #ifdef JIT
+    // Block translator, created on first run of Jit engine
+    std::unique_ptr<Jit> jit;
+    #endif
+
+    // Commands run since power on
+    uint64_t counter = 0;
+
+    // Commands run fused per idiom
+    std::array<uint64_t, 6> fusions {};
+
+    // Print disassembly after this command number
+    uint64_t trace = UINT64_MAX;
+
+    // CPU is frozen by JAM command
+    bool jammed = false;
+
+    // Stop run() when command jumps to itself
+    bool traps = true;
+
+    //
+    // Pending interrupt work
+    //
+    //      Lines are asserted by devices at any time and only fold into this
+    //      word, so the command loop tests a single value per command
+    //
+    //      Reset   RESET was asserted
+    //      Nmi     NMI line went from inactive to active (edge)
+    //      Irq     Any IRQ source holds the line (level, masked by I)
+    //
+
+    enum Pending : uint8_t
+    {
+        PendingReset = 1 << 0,
+        PendingNmi   = 1 << 1,
+        PendingIrq   = 1 << 2
+    };
+
+    uint8_t pending = 0;
+
+    // NMI line level
+    bool nmiLine = false;
+
+    // Active interrupt request sources
+    uint8_t irqLines = 0;
+
+    // Breakpoint addresses
+    std::bitset<0x10000> breakpoints;
+
+    // Number of breakpoints set
+    uint32_t breaks = 0;
+
+    //
+    // Elapsed CPU cycles since power on
+    //
+    //      Advanced by base cycles of each command plus penalties:
+    //      +1 when indexed read crosses a page boundary,
+    //      +1 when branch is taken and +1 more when it lands on another page
+    //
+
+    uint64_t cycles = 0;
+
+    // Additional cycles of current command
+    uint8_t penalty = 0;
+
+    // Indexed address of current command crossed a page boundary
+    bool crossed = false;
+
+    // Static part of effective address of predecoded command
+    uint16_t base = 0x0000;
 
     //
     // Addressing modes
+    // Decoded modes take operand from base instead of fetching it
     //
 
-    void IMM();  // immediate
-    void ABS();  // absolute
-    void ABSX(); // absolute, X-indexed
-    void ABSY(); // absolute, Y-indexed
-    void ZPG();  // zeropage
-    void ZPGX(); // zeropage, X-indexed
-    void ZPGY(); // zeropage, Y-indexed
+    template <bool Decoded = false> void IMM();  // immediate
+    template <bool Decoded = false> void ABS();  // absolute
+    template <bool Decoded = false> void ABSX(); // absolute, X-indexed
+    template <bool Decoded = false> void ABSY(); // absolute, Y-indexed
+    template <bool Decoded = false> void ZPG();  // zeropage
+    template <bool Decoded = false> void ZPGX(); // zeropage, X-indexed
+    template <bool Decoded = false> void ZPGY(); // zeropage, Y-indexed
     void IMP();  // implied
     void ACC();  // accumulator
-    void IND();  // indirect
-    void INDX(); // X-indexed, indirect
-    void INDY(); // indirect, Y-indexed
-    void REL();  // relative
+    template <bool Decoded = false> void IND();  // indirect
+    template <bool Decoded = false> void INDX(); // X-indexed, indirect
+    template <bool Decoded = false> void INDY(); // indirect, Y-indexed
+    template <bool Decoded = false> void REL();  // relative
 
     //
     // Instruction set
@@ -166,7 +380,16 @@ private:
     void ADC(uint8_t arg);
     void CMP(uint8_t arg);
 
-    void ADC(); // Add Memory to Accumulator with Carry
+    // Decimal mode ADC/SBC of NMOS 6502
+    void ADCD(uint8_t arg);
+    void SBCD(uint8_t arg);
+
+    uint8_t ASL(uint8_t data);
+    uint8_t LSR(uint8_t data);
+    uint8_t ROL(uint8_t data);
+    uint8_t ROR(uint8_t data);
+
+    template <Variant V> void ADC(); // Add Memory to Accumulator with Carry
     void ALR();  // AND opration and LSR
     void ANC();  // AND opration and set C as ASL
     void AND();  // AND Memory with Accumulator
@@ -223,7 +446,7 @@ private:
     void RTI();  // Return from Interrupt
     void RTS();  // Return from Subroutine
     void SAX();  // A and X are put on the bus at the same time and stored in M
-    void SBC();  // Subtract Memory from Accumulator with Borrow
+    template <Variant V> void SBC(); // Subtract Memory from Accumulator with Borrow
     void SBX();  // CMP and DEX at once, sets flags like CMP
     void SEC();  // Set Carry Flag
     void SED();  // Set Decimal Mode
@@ -253,13 +476,121 @@ private:
     // Write data to memory or accumulator
     void write (uint8_t data);
 
+    // Execute operation code with fused addressing mode
+    template <Variant V, bool Decoded = false>
+    void execute (uint8_t code);
+
+    // Set indexed operand address and test page crossing
+    void index (uint16_t base, uint8_t rg);
+
+    // Fetch and execute single command without disassembly
+    template <Variant V>
+    uint8_t step ();
+
+    // Execute command predecoded with static operand address, one per operation code
+    template <Variant V, uint8_t Code>
+    uint8_t predecoded (uint16_t operand);
+
+    // Handlers of predecoded operation codes
+    template <Variant V, size_t... Codes>
+    static constexpr std::array<Handler, 256> getHandlers (std::index_sequence<Codes...>);
+
+    // Execute predecoded command of Cache engine, steps if not cached
+    template <Variant V>
+    uint8_t cached ();
+
+    // Same with fused idioms within cycle end, returns address of last command
+    template <Variant V>
+    uint16_t fused (uint64_t end);
+
+    // Execute fused idiom predecoded at PC within cycle end, returns address of last command
+    template <Variant V, Fusion F>
+    uint16_t fuse (uint8_t code, uint16_t operand, uint8_t nextCode, uint16_t nextOperand, uint64_t end);
+
+    // Fetch and execute single command with disassembly
+    template <Variant V>
+    uint8_t clock ();
+
+    // Push PC and status, jump to interrupt vector
+    void interrupt (uint16_t vector);
+
+    // Take pending reset or interrupt, returns cycles or 0 if none taken
+    uint8_t service ();
+
+    // Execute commands until cycle or stop condition
+    template <bool Trace, Variant V, bool Cached = false>
+    Stop loop (uint64_t end);
+
 
 public:
-    Cpu(std::shared_ptr<Bus> bus);
+    Cpu(Bus & bus);
 
-    void clock();
+    uint8_t clock();
+
+    // Assert RESET, CPU starts from reset vector before next command
     void reset();
 
+    // Run commands for cycle budget or until stop condition
+    Stop run(uint64_t budget);
+
+    // Run commands until cycle counter reaches value
+    Stop until(uint64_t cycle);
+
+    // Print disassembly after command number
+    void setTrace(uint64_t from);
+
+    // Set/Unset breakpoint on address
+    void setBreakpoint(uint16_t address, bool enabled = true);
+
+    // Returns program counter
+    uint16_t getPc() const;
+
+    // Set program counter
+    void setPc(uint16_t address);
+
+    // Stop or not run() when command jumps to itself
+    void setTraps(bool enabled);
+
+    // Set NMI line level, interrupt is taken on active edge
+    void nmi(bool active);
+
+    // Hold/Release interrupt request line of source
+    void irq(Irq source, bool active);
+
+    // Halt CPU for cycles (e.g. DMA)
+    void stall(uint16_t cycles);
+
+    // Returns elapsed CPU cycles
+    uint64_t getCycles() const;
+
+    // Returns number of executed commands
+    uint64_t getCounter() const;
+
+    // Returns number of commands run fused as idiom
+    uint64_t getFused(Fusion idiom) const;
+
+    // Returns name of run() stop reason
+    static const char * getReason(Stop stop);
+
+    // Select instruction dispatch engine
+    void setEngine(Engine engine);
+
+    // Select processor variant
+    void setVariant(Variant variant);
+
+    // Returns processor variant
+    Variant getVariant() const;
+
+    // Write/Read registers, cycle counter and interrupt lines
+    void save(State & state) const;
+    void load(State & state);
+
+    // New CPU on bus with copy of registers, interrupt lines and configuration
+    std::unique_ptr<Cpu> fork(Bus & bus) const;
+
+    // Take registers, interrupt lines and configuration of other CPU, e.g. on forked bus
+    void assign(const Cpu & other);
+
     ~Cpu();
 };
 
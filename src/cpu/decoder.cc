@@ -0,0 +1,154 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "decoder.h"
+
+#include "cpu/cmd.h"
+#include "cpu/map.h"
+
+#include <algorithm>
+
+
+/*
+    Returns idiom started by command, sets opcode and static operand of its next command
+
+    Next command must follow on the same page. Opcodes of both
+    are the same on every processor variant.
+*/
+static Cpu::Fusion fuse (uint16_t pc, const uint8_t * bytes, uint8_t size, Decoder::Entry & entry)
+{
+    Cpu::Fusion fusion;
+
+    switch (bytes[0])
+    {
+        case 0xA9: case 0xA5: case 0xAD: fusion = Cpu::Fusion::LdaSta; break;
+        case 0xC9: case 0xC5: case 0xCD: fusion = Cpu::Fusion::CmpBne; break;
+        case 0xCA: fusion = Cpu::Fusion::DexBne; break;
+        case 0x88: fusion = Cpu::Fusion::DeyBne; break;
+        case 0xE6: fusion = Cpu::Fusion::IncBne; break;
+
+        default:
+            return Cpu::Fusion::None;
+    }
+
+    auto room   = 0x100 - (pc & 0xFF) - size;
+    auto second = bytes + size;
+
+    if (fusion == Cpu::Fusion::LdaSta)
+    {
+        // STA zeropage
+        if (room >= 2 && second[0] == 0x85)
+        {
+            entry.nextBase = second[1];
+            entry.nextCode = second[0];
+            return fusion;
+        }
+
+        // STA absolute
+        if (room >= 3 && second[0] == 0x8D)
+        {
+            entry.nextBase = second[1] | (second[2] << 8);
+            entry.nextCode = second[0];
+            return fusion;
+        }
+
+        return Cpu::Fusion::None;
+    }
+
+    // BNE, operand is offset address
+    if (room >= 2 && second[0] == 0xD0)
+    {
+        entry.nextBase = pc + size + 1;
+        entry.nextCode = second[0];
+        return fusion;
+    }
+
+    return Cpu::Fusion::None;
+}
+
+
+Decoder::Decoder(Bus & bus, Cpu::Variant variant) : PageTracker(bus), entries(0x10000), variant(variant)
+{ }
+
+
+/*
+    Validate page and decode command at address
+*/
+const Decoder::Entry * Decoder::miss (uint16_t pc)
+{
+    auto & page = bus.pages[pc >> 8];
+
+    if (!validate(pc >> 8))
+        return nullptr;
+
+    auto bytes = page.read + (pc & 0xFF);
+    auto & cmd = Map::getCommand(bytes[0]);
+
+    // Operand on next page is fetched every time
+    if ((pc & 0xFF) + cmd.getBytes() > 0x100)
+        return nullptr;
+
+    auto & entry = entries[pc];
+
+    switch (cmd.addressing)
+    {
+        case Mode::IMP:
+        case Mode::ACC:
+            entry.base = 0x0000;
+            break;
+
+        // Operand address
+        case Mode::IMM:
+        case Mode::REL:
+            entry.base = pc + 1;
+            break;
+
+        // Operand word
+        case Mode::ABS:
+        case Mode::ABSX:
+        case Mode::ABSY:
+        case Mode::IND:
+            entry.base = bytes[1] | (bytes[2] << 8);
+            break;
+
+        // Zeropage operand
+        default:
+            entry.base = bytes[1];
+            break;
+    }
+
+    entry.code = bytes[0];
+    entry.fusion = fuse(pc, bytes, cmd.getBytes(), entry);
+
+    if (variant == Cpu::Variant::Nmos6502) {
+        entry.handler = Cpu::getHandler<Cpu::Variant::Nmos6502>(bytes[0]);
+    } else {
+        entry.handler = Cpu::getHandler<Cpu::Variant::Ricoh2A03>(bytes[0]);
+    }
+
+    return &entry;
+}
+
+
+/*
+    Drop entries of page
+*/
+void Decoder::drop (uint8_t index)
+{
+    auto first = entries.begin() + (index << 8);
+    std::fill(first, first + 0x100, Entry());
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bus/bus.h"
+#include "bus/pagetracker.h"
+#include "cpu/cpu.h"
+
+//
+// Predecoded command cache
+//
+//      Keeps handler and static operand of every executed address, so a
+//      command running again skips fetch, operand decoding and dispatch.
+//      Handlers are picked for processor variant the decoder was made for.
+//      Commands are cached only on memory pages and within their page.
+//
+//      Page entries are dropped when host memory behind the page changes,
+//      e.g. on bank switch, and when its RAM block is written. RAM blocks
+//      rewritten too often, e.g. holding data next to code, are not cached.
+//
+//      Command starting a fused idiom, see Cpu::Fusion, keeps opcode and
+//      static operand of the next command too. Both are on the same page,
+//      so they are dropped together.
+//
+
+class Decoder : public PageTracker
+{
+public:
+
+    struct Entry
+    {
+        // Command handler, nullptr if not decoded
+        Cpu::Handler handler = nullptr;
+
+        // Static part of effective address, see Cpu::base
+        uint16_t base = 0;
+
+        // Operation code
+        uint8_t code = 0;
+
+        // Idiom started by command
+        Cpu::Fusion fusion = Cpu::Fusion::None;
+
+        // Operation code of next command of idiom
+        uint8_t nextCode = 0;
+
+        // Static part of effective address of next command of idiom
+        uint16_t nextBase = 0;
+    };
+
+private:
+
+    // Entry per address
+    std::vector<Entry> entries;
+
+    // Processor variant of handlers
+    Cpu::Variant variant;
+
+    /*
+        Drop entries of page
+    */
+    void drop (uint8_t index) override;
+
+    /*
+        Validate page and decode command at address
+    */
+    const Entry * miss (uint16_t pc);
+
+public:
+
+    Decoder(Bus & bus, Cpu::Variant variant);
+
+    /*
+        Page of address still has entries decoded from its host memory
+    */
+    bool isCurrent (uint16_t pc) const {
+        return isValid(pc >> 8);
+    }
+
+    /*
+        Returns predecoded command at address,
+        nullptr if it is not cached and must be fetched
+
+        Cached page has the same host memory as when decoded and no
+        write pointer, RAM pages get it back only after being written.
+    */
+    const Entry * find (uint16_t pc)
+    {
+        auto & entry = entries[pc];
+
+        if (entry.handler && isCurrent(pc))
+            return &entry;
+
+        return miss(pc);
+    }
+};
+
+#endif
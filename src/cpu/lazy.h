@@ -0,0 +1,243 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LAZY_H
+#define LAZY_H
+
+#include <cstdint>
+
+//
+// 6502 Status Register with lazy flag evaluation
+//
+//      Same interface as Status, but N, Z and C keep the value they were
+//      set from and V keeps its condition, so setting them is a plain
+//      store. Flags are derived only when read by a branch, by PHP, BRK
+//      or an interrupt pushing the register, or by the disassembler.
+//
+//      N   bit 7 of last value
+//      Z   last value is zero (low byte)
+//      C   bit 8 of last value
+//
+//      I, D and B are rarely changed and stay in a status byte.
+//
+
+class LazyStatus
+{
+private:
+
+    enum Flags : uint8_t
+    {
+        Carry     = 1 << 0,
+        Zero      = 1 << 1,
+        Interrupt = 1 << 2,
+        Decimal   = 1 << 3,
+        Break     = 1 << 4,
+        Default   = 1 << 5,
+        Overflow  = 1 << 6,
+        Negative  = 1 << 7
+    };
+
+    // Interrupt, Decimal, Break and Default flags
+    uint8_t status = Flags::Default;
+
+    // Sources of N, Z and C
+    uint8_t  negative = 0x00;
+    uint8_t  zero     = 0x01;
+    uint16_t carry    = 0x0000;
+
+    bool overflow = false;
+
+    /*
+        Set/Unset flag kept in status byte
+    */
+    void setFlag(Flags flag, bool value) {
+        status = (status & ~flag) | (-value & flag);
+    }
+
+    /*
+        Get flag kept in status byte as integer value
+    */
+    uint8_t getFlag(Flags flag) const {
+        return !!(status & flag);
+    }
+
+public:
+
+    LazyStatus() = default;
+
+    /*
+        Restore status from uint8_t
+    */
+    LazyStatus(uint8_t value) :
+        status   ((value & (Flags::Interrupt | Flags::Decimal | Flags::Break)) | Flags::Default),
+        negative (value & Flags::Negative),
+        zero     (~value & Flags::Zero),
+        carry    ((value & Flags::Carry) << 8),
+        overflow (value & Flags::Overflow)
+    { }
+
+    /*
+        Test Carry flag by value
+    */
+    template<typename T>
+    void setCarry(const T & value) {
+        carry = static_cast<uint16_t>(value);
+    }
+
+    /*
+        Set/Unset Carry flag
+    */
+    void setCarry(bool isSet) {
+        carry = isSet << 8;
+    }
+
+    /*
+        Test Negative flag by value
+    */
+    template<typename T>
+    void setNegative(const T & value) {
+        negative = static_cast<uint8_t>(value);
+    }
+
+    /*
+        Set/Unset Negative flag
+    */
+    void setNegative(bool isSet) {
+        negative = isSet << 7;
+    }
+
+    /*
+        Test Zero flag by value
+    */
+    template<typename T>
+    void setZero(const T & value) {
+        zero = static_cast<uint8_t>(value);
+    }
+
+    /*
+        Set/Unset Zero flag
+    */
+    void setZero(bool isSet) {
+        zero = !isSet;
+    }
+
+    /*
+        Test Negative and Zero flags by value
+    */
+    template<typename T>
+    void setNegativeZero(const T & value) {
+        negative = zero = static_cast<uint8_t>(value);
+    }
+
+    /*
+        Set/Unset Overflow flag
+    */
+    void setOverflow(bool isSet) {
+        overflow = isSet;
+    }
+
+    /*
+        Set/Unset Decimal flag
+    */
+    void setDecimal(bool isSet) {
+        setFlag(Flags::Decimal, isSet);
+    }
+
+    /*
+        Set/Unset Interrupt flag
+    */
+    void setInterrupt(bool isSet) {
+        setFlag(Flags::Interrupt, isSet);
+    }
+
+    /*
+        Set/Unset Break flag
+    */
+    void setBreak(bool isSet) {
+        setFlag(Flags::Break, isSet);
+    }
+
+    uint8_t getCarry() const {
+        return (carry >> 8) & 1;
+    }
+
+    uint8_t getNegative() const {
+        return negative >> 7;
+    }
+
+    uint8_t getOverflow() const {
+        return overflow;
+    }
+
+    uint8_t getBreak() const {
+        return getFlag(Flags::Break);
+    }
+
+    uint8_t getInterrupt() const {
+        return getFlag(Flags::Interrupt);
+    }
+
+    uint8_t getDecimal() const {
+        return getFlag(Flags::Decimal);
+    }
+
+    uint8_t getZero() const {
+        return zero == 0;
+    }
+
+    uint8_t getDefault() const {
+        return getFlag(Flags::Default);
+    }
+
+    bool isDecimal() const {
+        return status & Flags::Decimal;
+    }
+
+    bool isCarry() const {
+        return carry & 0x100;
+    }
+
+    bool isBreak() const {
+        return status & Flags::Break;
+    }
+
+    bool isNegative() const {
+        return negative & 0x80;
+    }
+
+    bool isOverflow() const {
+        return overflow;
+    }
+
+    bool isZero() const {
+        return zero == 0;
+    }
+
+    /*
+        Materialize all flags
+    */
+    operator uint8_t() const
+    {
+        return status | Flags::Break | Flags::Default
+            | (negative & Flags::Negative)
+            | (overflow << 6)
+            | ((zero == 0) << 1)
+            | getCarry();
+    }
+};
+
+#endif
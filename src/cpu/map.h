@@ -34,16 +34,343 @@ private:
     //
     // 6502 Instruction set
     // Includes all common/undocumented instructions
+    // Built at compile time and shared by all CPU instances,
+    // variants differ only in ADC/SBC handlers
     //
 
-    std::array<Cmd, 256> cmd;
+    template <Cpu::Variant V>
+    static constexpr std::array<Cmd, 256> cmd
+    {{
+        // 0x00 - 0x0F
 
-public:
+        { Mnemonic::BRK, &Cpu::BRK, Mode::IMP,  7                            }, // 0x00
+        { Mnemonic::ORA, &Cpu::ORA, Mode::INDX, 6                            }, // 0x01
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x02
+        { Mnemonic::SLO, &Cpu::SLO, Mode::INDX, 8, Cmd::Illegal              }, // 0x03
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPG,  3, Cmd::Illegal              }, // 0x04
+        { Mnemonic::ORA, &Cpu::ORA, Mode::ZPG,  3                            }, // 0x05
+        { Mnemonic::ASL, &Cpu::ASL, Mode::ZPG,  5                            }, // 0x06
+        { Mnemonic::SLO, &Cpu::SLO, Mode::ZPG,  5, Cmd::Illegal              }, // 0x07
+        { Mnemonic::PHP, &Cpu::PHP, Mode::IMP,  3                            }, // 0x08
+        { Mnemonic::ORA, &Cpu::ORA, Mode::IMM,  2                            }, // 0x09
+        { Mnemonic::ASL, &Cpu::ASL, Mode::ACC,  2                            }, // 0x0A
+        { Mnemonic::ANC, &Cpu::ANC, Mode::IMM,  2, Cmd::Illegal              }, // 0x0B
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABS,  4, Cmd::Illegal              }, // 0x0C
+        { Mnemonic::ORA, &Cpu::ORA, Mode::ABS,  4                            }, // 0x0D
+        { Mnemonic::ASL, &Cpu::ASL, Mode::ABS,  6                            }, // 0x0E
+        { Mnemonic::SLO, &Cpu::SLO, Mode::ABS,  6, Cmd::Illegal              }, // 0x0F
+
+
+        // 0x10 - 0x1F
+
+        { Mnemonic::BPL, &Cpu::BPL, Mode::REL,  2                            }, // 0x10
+        { Mnemonic::ORA, &Cpu::ORA, Mode::INDY, 5, Cmd::Cross                }, // 0x11
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x12
+        { Mnemonic::SLO, &Cpu::SLO, Mode::INDY, 8, Cmd::Illegal              }, // 0x13
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0x14
+        { Mnemonic::ORA, &Cpu::ORA, Mode::ZPGX, 4                            }, // 0x15
+        { Mnemonic::ASL, &Cpu::ASL, Mode::ZPGX, 6                            }, // 0x16
+        { Mnemonic::SLO, &Cpu::SLO, Mode::ZPGX, 6, Cmd::Illegal              }, // 0x17
+        { Mnemonic::CLC, &Cpu::CLC, Mode::IMP,  2                            }, // 0x18
+        { Mnemonic::ORA, &Cpu::ORA, Mode::ABSY, 4, Cmd::Cross                }, // 0x19
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0x1A
+        { Mnemonic::SLO, &Cpu::SLO, Mode::ABSY, 7, Cmd::Illegal              }, // 0x1B
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0x1C
+        { Mnemonic::ORA, &Cpu::ORA, Mode::ABSX, 4, Cmd::Cross                }, // 0x1D
+        { Mnemonic::ASL, &Cpu::ASL, Mode::ABSX, 7                            }, // 0x1E
+        { Mnemonic::SLO, &Cpu::SLO, Mode::ABSX, 7, Cmd::Illegal              }, // 0x1F
+
+
+        // 0x20 - 0x2F
+
+        { Mnemonic::JSR, &Cpu::JSR, Mode::ABS,  6                            }, // 0x20
+        { Mnemonic::AND, &Cpu::AND, Mode::INDX, 6                            }, // 0x21
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x22
+        { Mnemonic::RLA, &Cpu::RLA, Mode::INDX, 8, Cmd::Illegal              }, // 0x23
+        { Mnemonic::BIT, &Cpu::BIT, Mode::ZPG,  3                            }, // 0x24
+        { Mnemonic::AND, &Cpu::AND, Mode::ZPG,  3                            }, // 0x25
+        { Mnemonic::ROL, &Cpu::ROL, Mode::ZPG,  5                            }, // 0x26
+        { Mnemonic::RLA, &Cpu::RLA, Mode::ZPG,  5, Cmd::Illegal              }, // 0x27
+        { Mnemonic::PLP, &Cpu::PLP, Mode::IMP,  4                            }, // 0x28
+        { Mnemonic::AND, &Cpu::AND, Mode::IMM,  2                            }, // 0x29
+        { Mnemonic::ROL, &Cpu::ROL, Mode::ACC,  2                            }, // 0x2A
+        { Mnemonic::ANC, &Cpu::ANC, Mode::IMM,  2, Cmd::Illegal              }, // 0x2B
+        { Mnemonic::BIT, &Cpu::BIT, Mode::ABS,  4                            }, // 0x2C
+        { Mnemonic::AND, &Cpu::AND, Mode::ABS,  4                            }, // 0x2D
+        { Mnemonic::ROL, &Cpu::ROL, Mode::ABS,  6                            }, // 0x2E
+        { Mnemonic::RLA, &Cpu::RLA, Mode::ABS,  6, Cmd::Illegal              }, // 0x2F
+
+
+        // 0x30 - 0x3F
+
+        { Mnemonic::BMI, &Cpu::BMI, Mode::REL,  2                            }, // 0x30
+        { Mnemonic::AND, &Cpu::AND, Mode::INDY, 5, Cmd::Cross                }, // 0x31
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x32
+        { Mnemonic::RLA, &Cpu::RLA, Mode::INDY, 8, Cmd::Illegal              }, // 0x33
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0x34
+        { Mnemonic::AND, &Cpu::AND, Mode::ZPGX, 4                            }, // 0x35
+        { Mnemonic::ROL, &Cpu::ROL, Mode::ZPGX, 6                            }, // 0x36
+        { Mnemonic::RLA, &Cpu::RLA, Mode::ZPGX, 6, Cmd::Illegal              }, // 0x37
+        { Mnemonic::SEC, &Cpu::SEC, Mode::IMP,  2                            }, // 0x38
+        { Mnemonic::AND, &Cpu::AND, Mode::ABSY, 4, Cmd::Cross                }, // 0x39
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0x3A
+        { Mnemonic::RLA, &Cpu::RLA, Mode::ABSY, 7, Cmd::Illegal              }, // 0x3B
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0x3C
+        { Mnemonic::AND, &Cpu::AND, Mode::ABSX, 4, Cmd::Cross                }, // 0x3D
+        { Mnemonic::ROL, &Cpu::ROL, Mode::ABSX, 7                            }, // 0x3E
+        { Mnemonic::RLA, &Cpu::RLA, Mode::ABSX, 7, Cmd::Illegal              }, // 0x3F
+
+
+        // 0x40 - 0x4F
+
+        { Mnemonic::RTI, &Cpu::RTI, Mode::IMP,  6                            }, // 0x40
+        { Mnemonic::EOR, &Cpu::EOR, Mode::INDX, 6                            }, // 0x41
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x42
+        { Mnemonic::SRE, &Cpu::SRE, Mode::INDX, 8, Cmd::Illegal              }, // 0x43
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPG,  3, Cmd::Illegal              }, // 0x44
+        { Mnemonic::EOR, &Cpu::EOR, Mode::ZPG,  3                            }, // 0x45
+        { Mnemonic::LSR, &Cpu::LSR, Mode::ZPG,  5                            }, // 0x46
+        { Mnemonic::SRE, &Cpu::SRE, Mode::ZPG,  5, Cmd::Illegal              }, // 0x47
+        { Mnemonic::PHA, &Cpu::PHA, Mode::IMP,  3                            }, // 0x48
+        { Mnemonic::EOR, &Cpu::EOR, Mode::IMM,  2                            }, // 0x49
+        { Mnemonic::LSR, &Cpu::LSR, Mode::ACC,  2                            }, // 0x4A
+        { Mnemonic::ALR, &Cpu::ALR, Mode::IMM,  2, Cmd::Illegal              }, // 0x4B
+        { Mnemonic::JMP, &Cpu::JMP, Mode::ABS,  3                            }, // 0x4C
+        { Mnemonic::EOR, &Cpu::EOR, Mode::ABS,  4                            }, // 0x4D
+        { Mnemonic::LSR, &Cpu::LSR, Mode::ABS,  6                            }, // 0x4E
+        { Mnemonic::SRE, &Cpu::SRE, Mode::ABS,  6, Cmd::Illegal              }, // 0x4F
+
+
+        // 0x50 - 0x5F
+
+        { Mnemonic::BVC, &Cpu::BVC, Mode::REL,  2                            }, // 0x50
+        { Mnemonic::EOR, &Cpu::EOR, Mode::INDY, 5, Cmd::Cross                }, // 0x51
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x52
+        { Mnemonic::SRE, &Cpu::SRE, Mode::INDY, 8, Cmd::Illegal              }, // 0x53
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0x54
+        { Mnemonic::EOR, &Cpu::EOR, Mode::ZPGX, 4                            }, // 0x55
+        { Mnemonic::LSR, &Cpu::LSR, Mode::ZPGX, 6                            }, // 0x56
+        { Mnemonic::SRE, &Cpu::SRE, Mode::ZPGX, 6, Cmd::Illegal              }, // 0x57
+        { Mnemonic::CLI, &Cpu::CLI, Mode::IMP,  2                            }, // 0x58
+        { Mnemonic::EOR, &Cpu::EOR, Mode::ABSY, 4, Cmd::Cross                }, // 0x59
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0x5A
+        { Mnemonic::SRE, &Cpu::SRE, Mode::ABSY, 7, Cmd::Illegal              }, // 0x5B
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0x5C
+        { Mnemonic::EOR, &Cpu::EOR, Mode::ABSX, 4, Cmd::Cross                }, // 0x5D
+        { Mnemonic::LSR, &Cpu::LSR, Mode::ABSX, 7                            }, // 0x5E
+        { Mnemonic::SRE, &Cpu::SRE, Mode::ABSX, 7, Cmd::Illegal              }, // 0x5F
+
+
+        // 0x60 - 0x6F
+
+        { Mnemonic::RTS, &Cpu::RTS, Mode::IMP,  6                            }, // 0x60
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::INDX, 6                         }, // 0x61
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x62
+        { Mnemonic::RRA, &Cpu::RRA, Mode::INDX, 8, Cmd::Illegal              }, // 0x63
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPG,  3, Cmd::Illegal              }, // 0x64
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::ZPG,  3                         }, // 0x65
+        { Mnemonic::ROR, &Cpu::ROR, Mode::ZPG,  5                            }, // 0x66
+        { Mnemonic::RRA, &Cpu::RRA, Mode::ZPG,  5, Cmd::Illegal              }, // 0x67
+        { Mnemonic::PLA, &Cpu::PLA, Mode::IMP,  4                            }, // 0x68
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::IMM,  2                         }, // 0x69
+        { Mnemonic::ROR, &Cpu::ROR, Mode::ACC,  2                            }, // 0x6A
+        { Mnemonic::ARR, &Cpu::ARR, Mode::IMM,  2, Cmd::Illegal              }, // 0x6B
+        { Mnemonic::JMP, &Cpu::JMP, Mode::IND,  5                            }, // 0x6C
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::ABS,  4                         }, // 0x6D
+        { Mnemonic::ROR, &Cpu::ROR, Mode::ABS,  6                            }, // 0x6E
+        { Mnemonic::RRA, &Cpu::RRA, Mode::ABS,  6, Cmd::Illegal              }, // 0x6F
+
+
+        // 0x70 - 0x7F
+
+        { Mnemonic::BVS, &Cpu::BVS, Mode::REL,  2                            }, // 0x70
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::INDY, 5, Cmd::Cross             }, // 0x71
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x72
+        { Mnemonic::RRA, &Cpu::RRA, Mode::INDY, 8, Cmd::Illegal              }, // 0x73
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0x74
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::ZPGX, 4                         }, // 0x75
+        { Mnemonic::ROR, &Cpu::ROR, Mode::ZPGX, 6                            }, // 0x76
+        { Mnemonic::RRA, &Cpu::RRA, Mode::ZPGX, 6, Cmd::Illegal              }, // 0x77
+        { Mnemonic::SEI, &Cpu::SEI, Mode::IMP,  2                            }, // 0x78
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::ABSY, 4, Cmd::Cross             }, // 0x79
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0x7A
+        { Mnemonic::RRA, &Cpu::RRA, Mode::ABSY, 7, Cmd::Illegal              }, // 0x7B
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0x7C
+        { Mnemonic::ADC, &Cpu::ADC<V>, Mode::ABSX, 4, Cmd::Cross             }, // 0x7D
+        { Mnemonic::ROR, &Cpu::ROR, Mode::ABSX, 7                            }, // 0x7E
+        { Mnemonic::RRA, &Cpu::RRA, Mode::ABSX, 7, Cmd::Illegal              }, // 0x7F
+
+
+        // 0x80 - 0x8F
 
-    Map();
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMM,  2, Cmd::Illegal              }, // 0x80
+        { Mnemonic::STA, &Cpu::STA, Mode::INDX, 6                            }, // 0x81
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMM,  2, Cmd::Illegal              }, // 0x82
+        { Mnemonic::SAX, &Cpu::SAX, Mode::INDX, 6, Cmd::Illegal              }, // 0x83
+        { Mnemonic::STY, &Cpu::STY, Mode::ZPG,  3                            }, // 0x84
+        { Mnemonic::STA, &Cpu::STA, Mode::ZPG,  3                            }, // 0x85
+        { Mnemonic::STX, &Cpu::STX, Mode::ZPG,  3                            }, // 0x86
+        { Mnemonic::SAX, &Cpu::SAX, Mode::ZPG,  3, Cmd::Illegal              }, // 0x87
+        { Mnemonic::DEY, &Cpu::DEY, Mode::IMP,  2                            }, // 0x88
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMM,  2, Cmd::Illegal              }, // 0x89
+        { Mnemonic::TXA, &Cpu::TXA, Mode::IMP,  2                            }, // 0x8A
+        { Mnemonic::ANE, &Cpu::ANE, Mode::IMM,  2, Cmd::Illegal              }, // 0x8B
+        { Mnemonic::STY, &Cpu::STY, Mode::ABS,  4                            }, // 0x8C
+        { Mnemonic::STA, &Cpu::STA, Mode::ABS,  4                            }, // 0x8D
+        { Mnemonic::STX, &Cpu::STX, Mode::ABS,  4                            }, // 0x8E
+        { Mnemonic::SAX, &Cpu::SAX, Mode::ABS,  4, Cmd::Illegal              }, // 0x8F
+
+
+        // 0x90 - 0x9F
+
+        { Mnemonic::BCC, &Cpu::BCC, Mode::REL,  2                            }, // 0x90
+        { Mnemonic::STA, &Cpu::STA, Mode::INDY, 6                            }, // 0x91
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0x92
+        { Mnemonic::SHA, &Cpu::SHA, Mode::INDY, 6, Cmd::Illegal              }, // 0x93
+        { Mnemonic::STY, &Cpu::STY, Mode::ZPGX, 4                            }, // 0x94
+        { Mnemonic::STA, &Cpu::STA, Mode::ZPGX, 4                            }, // 0x95
+        { Mnemonic::STX, &Cpu::STX, Mode::ZPGY, 4                            }, // 0x96
+        { Mnemonic::SAX, &Cpu::SAX, Mode::ZPGY, 4, Cmd::Illegal              }, // 0x97
+        { Mnemonic::TYA, &Cpu::TYA, Mode::IMP,  2                            }, // 0x98
+        { Mnemonic::STA, &Cpu::STA, Mode::ABSY, 5                            }, // 0x99
+        { Mnemonic::TXS, &Cpu::TXS, Mode::IMP,  2                            }, // 0x9A
+        { Mnemonic::TAS, &Cpu::TAS, Mode::ABSY, 5, Cmd::Illegal              }, // 0x9B
+        { Mnemonic::SHY, &Cpu::SHY, Mode::ABSX, 5, Cmd::Illegal              }, // 0x9C
+        { Mnemonic::STA, &Cpu::STA, Mode::ABSX, 5                            }, // 0x9D
+        { Mnemonic::SHX, &Cpu::SHX, Mode::ABSY, 5, Cmd::Illegal              }, // 0x9E
+        { Mnemonic::SHA, &Cpu::SHA, Mode::ABSY, 5, Cmd::Illegal              }, // 0x9F
+
+
+        // 0xA0 - 0xAF
+
+        { Mnemonic::LDY, &Cpu::LDY, Mode::IMM,  2                            }, // 0xA0
+        { Mnemonic::LDA, &Cpu::LDA, Mode::INDX, 6                            }, // 0xA1
+        { Mnemonic::LDX, &Cpu::LDX, Mode::IMM,  2                            }, // 0xA2
+        { Mnemonic::LAX, &Cpu::LAX, Mode::INDX, 6, Cmd::Illegal              }, // 0xA3
+        { Mnemonic::LDY, &Cpu::LDY, Mode::ZPG,  3                            }, // 0xA4
+        { Mnemonic::LDA, &Cpu::LDA, Mode::ZPG,  3                            }, // 0xA5
+        { Mnemonic::LDX, &Cpu::LDX, Mode::ZPG,  3                            }, // 0xA6
+        { Mnemonic::LAX, &Cpu::LAX, Mode::ZPG,  3, Cmd::Illegal              }, // 0xA7
+        { Mnemonic::TAY, &Cpu::TAY, Mode::IMP,  2                            }, // 0xA8
+        { Mnemonic::LDA, &Cpu::LDA, Mode::IMM,  2                            }, // 0xA9
+        { Mnemonic::TAX, &Cpu::TAX, Mode::IMP,  2                            }, // 0xAA
+        { Mnemonic::LXA, &Cpu::LXA, Mode::IMM,  2, Cmd::Illegal              }, // 0xAB
+        { Mnemonic::LDY, &Cpu::LDY, Mode::ABS,  4                            }, // 0xAC
+        { Mnemonic::LDA, &Cpu::LDA, Mode::ABS,  4                            }, // 0xAD
+        { Mnemonic::LDX, &Cpu::LDX, Mode::ABS,  4                            }, // 0xAE
+        { Mnemonic::LAX, &Cpu::LAX, Mode::ABS,  4, Cmd::Illegal              }, // 0xAF
+
+
+        // 0xB0 - 0xBF
+
+        { Mnemonic::BCS, &Cpu::BCS, Mode::REL,  2                            }, // 0xB0
+        { Mnemonic::LDA, &Cpu::LDA, Mode::INDY, 5, Cmd::Cross                }, // 0xB1
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0xB2
+        { Mnemonic::LAX, &Cpu::LAX, Mode::INDY, 5, Cmd::Cross | Cmd::Illegal }, // 0xB3
+        { Mnemonic::LDY, &Cpu::LDY, Mode::ZPGX, 4                            }, // 0xB4
+        { Mnemonic::LDA, &Cpu::LDA, Mode::ZPGX, 4                            }, // 0xB5
+        { Mnemonic::LDX, &Cpu::LDX, Mode::ZPGY, 4                            }, // 0xB6
+        { Mnemonic::LAX, &Cpu::LAX, Mode::ZPGY, 4, Cmd::Illegal              }, // 0xB7
+        { Mnemonic::CLV, &Cpu::CLV, Mode::IMP,  2                            }, // 0xB8
+        { Mnemonic::LDA, &Cpu::LDA, Mode::ABSY, 4, Cmd::Cross                }, // 0xB9
+        { Mnemonic::TSX, &Cpu::TSX, Mode::IMP,  2                            }, // 0xBA
+        { Mnemonic::LAS, &Cpu::LAS, Mode::ABSY, 4, Cmd::Cross | Cmd::Illegal }, // 0xBB
+        { Mnemonic::LDY, &Cpu::LDY, Mode::ABSX, 4, Cmd::Cross                }, // 0xBC
+        { Mnemonic::LDA, &Cpu::LDA, Mode::ABSX, 4, Cmd::Cross                }, // 0xBD
+        { Mnemonic::LDX, &Cpu::LDX, Mode::ABSY, 4, Cmd::Cross                }, // 0xBE
+        { Mnemonic::LAX, &Cpu::LAX, Mode::ABSY, 4, Cmd::Cross | Cmd::Illegal }, // 0xBF
+
+
+        // 0xC0 - 0xCF
+
+        { Mnemonic::CPY, &Cpu::CPY, Mode::IMM,  2                            }, // 0xC0
+        { Mnemonic::CMP, &Cpu::CMP, Mode::INDX, 6                            }, // 0xC1
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMM,  2, Cmd::Illegal              }, // 0xC2
+        { Mnemonic::DCP, &Cpu::DCP, Mode::INDX, 8, Cmd::Illegal              }, // 0xC3
+        { Mnemonic::CPY, &Cpu::CPY, Mode::ZPG,  3                            }, // 0xC4
+        { Mnemonic::CMP, &Cpu::CMP, Mode::ZPG,  3                            }, // 0xC5
+        { Mnemonic::DEC, &Cpu::DEC, Mode::ZPG,  5                            }, // 0xC6
+        { Mnemonic::DCP, &Cpu::DCP, Mode::ZPG,  5, Cmd::Illegal              }, // 0xC7
+        { Mnemonic::INY, &Cpu::INY, Mode::IMP,  2                            }, // 0xC8
+        { Mnemonic::CMP, &Cpu::CMP, Mode::IMM,  2                            }, // 0xC9
+        { Mnemonic::DEX, &Cpu::DEX, Mode::IMP,  2                            }, // 0xCA
+        { Mnemonic::SBX, &Cpu::SBX, Mode::IMM,  2, Cmd::Illegal              }, // 0xCB
+        { Mnemonic::CPY, &Cpu::CPY, Mode::ABS,  4                            }, // 0xCC
+        { Mnemonic::CMP, &Cpu::CMP, Mode::ABS,  4                            }, // 0xCD
+        { Mnemonic::DEC, &Cpu::DEC, Mode::ABS,  6                            }, // 0xCE
+        { Mnemonic::DCP, &Cpu::DCP, Mode::ABS,  6, Cmd::Illegal              }, // 0xCF
+
+
+        // 0xD0 - 0xDF
+
+        { Mnemonic::BNE, &Cpu::BNE, Mode::REL,  2                            }, // 0xD0
+        { Mnemonic::CMP, &Cpu::CMP, Mode::INDY, 5, Cmd::Cross                }, // 0xD1
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0xD2
+        { Mnemonic::DCP, &Cpu::DCP, Mode::INDY, 8, Cmd::Illegal              }, // 0xD3
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0xD4
+        { Mnemonic::CMP, &Cpu::CMP, Mode::ZPGX, 4                            }, // 0xD5
+        { Mnemonic::DEC, &Cpu::DEC, Mode::ZPGX, 6                            }, // 0xD6
+        { Mnemonic::DCP, &Cpu::DCP, Mode::ZPGX, 6, Cmd::Illegal              }, // 0xD7
+        { Mnemonic::CLD, &Cpu::CLD, Mode::IMP,  2                            }, // 0xD8
+        { Mnemonic::CMP, &Cpu::CMP, Mode::ABSY, 4, Cmd::Cross                }, // 0xD9
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0xDA
+        { Mnemonic::DCP, &Cpu::DCP, Mode::ABSY, 7, Cmd::Illegal              }, // 0xDB
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0xDC
+        { Mnemonic::CMP, &Cpu::CMP, Mode::ABSX, 4, Cmd::Cross                }, // 0xDD
+        { Mnemonic::DEC, &Cpu::DEC, Mode::ABSX, 7                            }, // 0xDE
+        { Mnemonic::DCP, &Cpu::DCP, Mode::ABSX, 7, Cmd::Illegal              }, // 0xDF
+
+
+        // 0xE0 - 0xEF
+
+        { Mnemonic::CPX, &Cpu::CPX, Mode::IMM,  2                            }, // 0xE0
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::INDX, 6                         }, // 0xE1
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMM,  2, Cmd::Illegal              }, // 0xE2
+        { Mnemonic::ISC, &Cpu::ISC, Mode::INDX, 8, Cmd::Illegal              }, // 0xE3
+        { Mnemonic::CPX, &Cpu::CPX, Mode::ZPG,  3                            }, // 0xE4
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::ZPG,  3                         }, // 0xE5
+        { Mnemonic::INC, &Cpu::INC, Mode::ZPG,  5                            }, // 0xE6
+        { Mnemonic::ISC, &Cpu::ISC, Mode::ZPG,  5, Cmd::Illegal              }, // 0xE7
+        { Mnemonic::INX, &Cpu::INX, Mode::IMP,  2                            }, // 0xE8
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::IMM,  2                         }, // 0xE9
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2                            }, // 0xEA
+        { Mnemonic::USB, &Cpu::USB, Mode::IMM,  2, Cmd::Illegal              }, // 0xEB
+        { Mnemonic::CPX, &Cpu::CPX, Mode::ABS,  4                            }, // 0xEC
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::ABS,  4                         }, // 0xED
+        { Mnemonic::INC, &Cpu::INC, Mode::ABS,  6                            }, // 0xEE
+        { Mnemonic::ISC, &Cpu::ISC, Mode::ABS,  6, Cmd::Illegal              }, // 0xEF
+
+
+        // 0xF0 - 0xFF
+
+        { Mnemonic::BEQ, &Cpu::BEQ, Mode::REL,  2                            }, // 0xF0
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::INDY, 5, Cmd::Cross             }, // 0xF1
+        { Mnemonic::JAM, &Cpu::JAM, Mode::IMP,  2, Cmd::Illegal              }, // 0xF2
+        { Mnemonic::ISC, &Cpu::ISC, Mode::INDY, 8, Cmd::Illegal              }, // 0xF3
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ZPGX, 4, Cmd::Illegal              }, // 0xF4
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::ZPGX, 4                         }, // 0xF5
+        { Mnemonic::INC, &Cpu::INC, Mode::ZPGX, 6                            }, // 0xF6
+        { Mnemonic::ISC, &Cpu::ISC, Mode::ZPGX, 6, Cmd::Illegal              }, // 0xF7
+        { Mnemonic::SED, &Cpu::SED, Mode::IMP,  2                            }, // 0xF8
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::ABSY, 4, Cmd::Cross             }, // 0xF9
+        { Mnemonic::NOP, &Cpu::NOP, Mode::IMP,  2, Cmd::Illegal              }, // 0xFA
+        { Mnemonic::ISC, &Cpu::ISC, Mode::ABSY, 7, Cmd::Illegal              }, // 0xFB
+        { Mnemonic::NOP, &Cpu::NOP, Mode::ABSX, 4, Cmd::Cross | Cmd::Illegal }, // 0xFC
+        { Mnemonic::SBC, &Cpu::SBC<V>, Mode::ABSX, 4, Cmd::Cross             }, // 0xFD
+        { Mnemonic::INC, &Cpu::INC, Mode::ABSX, 7                            }, // 0xFE
+        { Mnemonic::ISC, &Cpu::ISC, Mode::ABSX, 7, Cmd::Illegal              }  // 0xFF
+    }};
+
+public:
 
     // Returns command by operation code
-    const Cmd & getCommand(uint8_t opcode) const;
+    template <Cpu::Variant V = Cpu::Variant::Ricoh2A03>
+    static constexpr const Cmd & getCommand(uint8_t opcode) {
+        return cmd<V>[opcode];
+    }
+
+    // Returns command name by operation code
+    static const char * getName(uint8_t opcode);
 };
 
 #endif
\ No newline at end of file
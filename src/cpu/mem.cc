@@ -18,19 +18,10 @@
 #include "mem.h"
 #include "bus/bus.h"
 
-Mem::Mem(std::shared_ptr<Bus> bus) : bus(bus)
+Mem::Mem(Bus & bus) : bus(bus)
 { }
 
 
-/*
-    Read byte from bus
-*/
-uint8_t Mem::read(uint16_t index) const
-{
-    return bus -> read(index);
-}
-
-
 /* 
     Read 2-bytes address from memory direct 
     Shift program counter twice
@@ -87,21 +78,20 @@ uint8_t Mem::zpg(uint16_t & pc, uint8_t rg)
 
 uint16_t Mem::indexed(uint16_t & pc, uint8_t rg)
 {
-    uint16_t zp = zpg(pc);
-
-    uint16_t lo = read(0x00FF & (rg + zp++));
-    uint16_t hi = read(0x00FF & (rg + zp++));
-
-    return (hi << 8) | lo;
+    return pointer(zpg(pc, rg));
 }
 
 
 /*
-    Write byte to bus without carry
+    Read 2-bytes address from zeropage without carry
 */
-void Mem::write(uint16_t address, uint8_t data)
+
+uint16_t Mem::pointer(uint8_t zp)
 {
-    bus -> write(address, data);
+    uint16_t lo = read(zp);
+    uint16_t hi = read(0x00FF & (zp + 1));
+
+    return (hi << 8) | lo;
 }
 
 
@@ -18,10 +18,9 @@
 #ifndef MEM_H
 #define MEM_H
 
-#include <memory>
 #include <cstdint>
 
-class Bus;
+#include "bus/bus.h"
 
 class Mem
 {
@@ -36,7 +35,7 @@ private:
         Bus communication interface
         Interact with each other devices i.e. RAM, APU, PPU etc.
     */
-    std::shared_ptr<Bus> bus;
+    Bus & bus;
 
 
 public:
@@ -44,12 +43,21 @@ public:
     /*
         Initialize with bus
     */
-    Mem(std::shared_ptr<Bus> bus);
+    Mem(Bus & bus);
+
+    /*
+        Bus behind memory
+    */
+    Bus & getBus() const {
+        return bus;
+    }
 
     /*
         Read byte from bus
     */
-    uint8_t read(uint16_t index) const;
+    uint8_t read(uint16_t index) const {
+        return bus.read(index);
+    }
 
     /* 
         Read 2-bytes address from memory direct 
@@ -78,10 +86,17 @@ public:
     */
     uint16_t indexed(uint16_t & pc, uint8_t rg = 0x00);
 
+    /*
+        Read 2-bytes address from zeropage without carry
+    */
+    uint16_t pointer(uint8_t zp);
+
     /*
         Write byte to bus without carry
     */
-    void write(uint16_t address, uint8_t data);
+    void write(uint16_t address, uint8_t data) {
+        bus.write(address, data);
+    }
 
     /*
         Push data on stack
@@ -18,11 +18,17 @@
 #ifndef STATUS_H
 #define STATUS_H
 
+#include <array>
 #include <cstdint>
 
-/*
-    6502 Status Register (SR) flags
-*/
+//
+// 6502 Status Register (SR) flags
+//
+//      Flags are updated by mask arithmetic without branches and N, Z
+//      set from the same value come from a table of all 256 byte values,
+//      so an update is one load, one mask and one or. Everything is
+//      inline, commands pay for no calls.
+//
 
 class Status
 {
@@ -30,16 +36,30 @@ private:
 
     enum Flags : uint8_t
     {
-        Carry     = 1 << 0,       
-        Zero      = 1 << 1, 
+        Carry     = 1 << 0,
+        Zero      = 1 << 1,
         Interrupt = 1 << 2,
-        Decimal   = 1 << 3, 
-        Break     = 1 << 4, 
+        Decimal   = 1 << 3,
+        Break     = 1 << 4,
         Default   = 1 << 5,
-        Overflow  = 1 << 6, 
-        Negative  = 1 << 7  
+        Overflow  = 1 << 6,
+        Negative  = 1 << 7
     };
 
+    /*
+        N and Z flags of every byte value
+    */
+    static constexpr std::array<uint8_t, 256> nz = []
+    {
+        std::array<uint8_t, 256> table {};
+
+        for (unsigned value = 0; value < table.size(); value++) {
+            table[value] = (value & Flags::Negative) | (value ? 0 : Flags::Zero);
+        }
+
+        return table;
+    }();
+
     /*
         Status flags value
     */
@@ -48,164 +68,181 @@ private:
     /*
         Returns true if flag is set
     */
-    bool isSet(Flags flag) const;
+    bool isSet(Flags flag) const {
+        return status & flag;
+    }
 
     /*
         Set/Unset flag
     */
-    void setFlag(Flags flag, bool value);
+    void setFlag(Flags flag, bool value) {
+        status = (status & ~flag) | (-value & flag);
+    }
 
     /*
         Get flag as integer value
     */
-    uint8_t getFlag(Flags flag) const;
-
+    uint8_t getFlag(Flags flag) const {
+        return !!(status & flag);
+    }
 
 public:
 
     /*
         Default constructor
     */
-    Status();
+    Status() : status(Flags::Default)
+    { }
 
     /*
         Restore status from uint8_t
     */
-    Status(uint8_t status);
+    Status(uint8_t value) : status(value | Flags::Default)
+    { }
 
     /*
         Test Carry flag by value
     */
-    template<typename T> 
+    template<typename T>
     void setCarry(const T & value) {
-        setFlag(Flags::Carry, value & 0x100);
+        status = (status & ~Flags::Carry) | ((value >> 8) & Flags::Carry);
     }
 
     /*
         Set/Unset Carry flag
     */
-    void setCarry(bool isSet);
+    void setCarry(bool isSet) {
+        status = (status & ~Flags::Carry) | isSet;
+    }
 
     /*
         Test Negative flag by value
     */
-    template<typename T> 
+    template<typename T>
     void setNegative(const T & value) {
-        setFlag(Flags::Negative, value & 0x80);
+        status = (status & ~Flags::Negative) | (value & Flags::Negative);
     }
 
     /*
         Set/Unset Negative flag
     */
-    void setNegative(bool isSet);
+    void setNegative(bool isSet) {
+        status = (status & ~Flags::Negative) | (isSet << 7);
+    }
 
     /*
         Test Zero flag by value
     */
-    template<typename T> 
+    template<typename T>
     void setZero(const T & value) {
-        setFlag(Flags::Zero, (value & 0x00FF) == 0x00);
+        status = (status & ~Flags::Zero) | (nz[value & 0xFF] & Flags::Zero);
     }
 
     /*
         Set/Unset Zero flag
     */
-    void setZero(bool isSet);
-    
+    void setZero(bool isSet) {
+        status = (status & ~Flags::Zero) | (isSet << 1);
+    }
+
+    /*
+        Test Negative and Zero flags by value
+    */
+    template<typename T>
+    void setNegativeZero(const T & value) {
+        status = (status & ~(Flags::Negative | Flags::Zero)) | nz[value & 0xFF];
+    }
+
     /*
         Set/Unset Overflow flag
     */
-    void setOverflow(bool isSet);
+    void setOverflow(bool isSet) {
+        status = (status & ~Flags::Overflow) | (isSet << 6);
+    }
 
     /*
         Set/Unset Decimal flag
     */
-    void setDecimal(bool isSet);
+    void setDecimal(bool isSet) {
+        setFlag(Flags::Decimal, isSet);
+    }
 
     /*
         Set/Unset Interrupt flag
     */
-    void setInterrupt(bool isSet);
+    void setInterrupt(bool isSet) {
+        setFlag(Flags::Interrupt, isSet);
+    }
 
     /*
         Set/Unset Break flag
     */
-    void setBreak(bool isSet);
+    void setBreak(bool isSet) {
+        setFlag(Flags::Break, isSet);
+    }
 
-    /*
-        Returns Carry flag
-    */
-    uint8_t getCarry() const;
+    uint8_t getCarry() const {
+        return status & Flags::Carry;
+    }
 
-    /*
-        Returns Negative flag
-    */
-    uint8_t getNegative() const;
+    uint8_t getNegative() const {
+        return status >> 7;
+    }
 
-    /*
-        Returns Overflow flag
-    */
-    uint8_t getOverflow() const;
+    uint8_t getOverflow() const {
+        return getFlag(Flags::Overflow);
+    }
 
-    /*
-        Returns Break flag
-    */
-    uint8_t getBreak() const;
+    uint8_t getBreak() const {
+        return getFlag(Flags::Break);
+    }
 
-    /*
-        Returns Interrupt flag
-    */
-    uint8_t getInterrupt() const;
+    uint8_t getInterrupt() const {
+        return getFlag(Flags::Interrupt);
+    }
 
-    /*
-        Returns Decimal flag
-    */
-    uint8_t getDecimal() const;
+    uint8_t getDecimal() const {
+        return getFlag(Flags::Decimal);
+    }
 
-    /*
-        Returns Zero flag
-    */
-    uint8_t getZero() const;
+    uint8_t getZero() const {
+        return getFlag(Flags::Zero);
+    }
 
-    /*
-        Returns Default flag
-    */
-    uint8_t getDefault() const;
+    uint8_t getDefault() const {
+        return getFlag(Flags::Default);
+    }
 
-    /*
-        Returns true if Decimal flag is set
-    */
-    bool isDecimal() const;
+    bool isDecimal() const {
+        return isSet(Flags::Decimal);
+    }
 
-    /*
-        Returns true if Carry flag is set
-    */
-    bool isCarry() const;
+    bool isCarry() const {
+        return isSet(Flags::Carry);
+    }
 
-    /*
-        Returns true if Break flag is set
-    */
-    bool isBreak() const;
+    bool isBreak() const {
+        return isSet(Flags::Break);
+    }
 
-    /*
-        Returns true if Negative flag is set
-    */
-    bool isNegative() const;
+    bool isNegative() const {
+        return isSet(Flags::Negative);
+    }
 
-    /*
-        Returns true if Overflow flag is set
-    */
-    bool isOverflow() const;
+    bool isOverflow() const {
+        return isSet(Flags::Overflow);
+    }
 
-    /*
-        Returns true if Carry flag is set
-    */
-    bool isZero() const;
+    bool isZero() const {
+        return isSet(Flags::Zero);
+    }
 
     /*
         Explicit cast to uint8_t
     */
-    operator uint8_t() const;
+    operator uint8_t() const {
+        return status | Flags::Break | Flags::Default;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
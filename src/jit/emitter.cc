@@ -0,0 +1,412 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emitter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+
+/*
+    Byte register needs REX prefix to be addressed
+*/
+static bool isHigh (Emitter::Reg reg)
+{
+    return reg >= Emitter::RSP && reg <= Emitter::RDI;
+}
+
+static bool isByte (int32_t value)
+{
+    return value >= -128 && value <= 127;
+}
+
+
+void Emitter::byte (uint8_t value)
+{
+    code.push_back(value);
+}
+
+void Emitter::dword (uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        byte(value >> shift);
+    }
+}
+
+
+/*
+    REX prefix: W for 64-bit operand, R, X and B extend ModRM reg, SIB index and base
+*/
+void Emitter::rex (bool w, uint8_t reg, uint8_t index, uint8_t base, bool force)
+{
+    uint8_t value = 0x40 | (w << 3) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+
+    if (value != 0x40 || force)
+        byte(value);
+}
+
+
+/*
+    Register direct operand
+*/
+void Emitter::operand (uint8_t reg, Reg rm)
+{
+    byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+
+/*
+    Memory operand, RSP and R12 as base need SIB,
+    RBP and R13 as base always take displacement
+*/
+void Emitter::operand (uint8_t reg, const Mem & rm)
+{
+    uint8_t base = rm.base & 7;
+    bool sib = rm.index != NONE || base == RSP;
+
+    uint8_t mod = 2;
+
+    if (rm.disp == 0 && base != RBP) {
+        mod = 0;
+    } else if (isByte(rm.disp)) {
+        mod = 1;
+    }
+
+    byte((mod << 6) | ((reg & 7) << 3) | (sib ? uint8_t(RSP) : base));
+
+    if (sib)
+        byte((((rm.index == NONE) ? RSP : rm.index) & 7) << 3 | base);
+
+    if (mod == 1) {
+        byte(rm.disp);
+    } else if (mod == 2) {
+        dword(rm.disp);
+    }
+}
+
+
+void Emitter::emit (std::initializer_list<uint8_t> opcode, uint8_t reg, Reg rm, bool w, bool force)
+{
+    rex(w, reg, 0, rm, force);
+
+    for (auto value : opcode) {
+        byte(value);
+    }
+
+    operand(reg, rm);
+}
+
+void Emitter::emit (std::initializer_list<uint8_t> opcode, uint8_t reg, const Mem & rm, bool w, bool force)
+{
+    rex(w, reg, (rm.index == NONE) ? 0 : rm.index, rm.base, force);
+
+    for (auto value : opcode) {
+        byte(value);
+    }
+
+    operand(reg, rm);
+}
+
+
+/*
+    Labels
+*/
+Emitter::Label Emitter::label ()
+{
+    labels.push_back(SIZE_MAX);
+    return labels.size() - 1;
+}
+
+void Emitter::bind (Label label)
+{
+    labels[label] = code.size();
+}
+
+void Emitter::rel32 (Label label)
+{
+    fixups.emplace_back(code.size(), label);
+    dword(0);
+}
+
+
+/*
+    Moves
+*/
+void Emitter::mov (Reg dst, Reg src)
+{
+    emit({ 0x89 }, src, dst);
+}
+
+void Emitter::mov (Reg dst, uint32_t imm)
+{
+    rex(false, 0, 0, dst, false);
+    byte(0xB8 | (dst & 7));
+    dword(imm);
+}
+
+void Emitter::movq (Reg dst, Reg src)
+{
+    emit({ 0x89 }, src, dst, true);
+}
+
+void Emitter::movq (Reg dst, uint64_t imm)
+{
+    rex(true, 0, 0, dst, false);
+    byte(0xB8 | (dst & 7));
+    dword(imm);
+    dword(imm >> 32);
+}
+
+void Emitter::movq (Reg dst, const Mem & src)
+{
+    emit({ 0x8B }, dst, src, true);
+}
+
+void Emitter::movq (const Mem & dst, Reg src)
+{
+    emit({ 0x89 }, src, dst, true);
+}
+
+void Emitter::movzxb (Reg dst, Reg src)
+{
+    emit({ 0x0F, 0xB6 }, dst, src, false, isHigh(src));
+}
+
+void Emitter::movzxb (Reg dst, const Mem & src)
+{
+    emit({ 0x0F, 0xB6 }, dst, src);
+}
+
+void Emitter::movb (const Mem & dst, Reg src)
+{
+    emit({ 0x88 }, src, dst, false, isHigh(src));
+}
+
+void Emitter::movw (const Mem & dst, Reg src)
+{
+    byte(0x66);
+    emit({ 0x89 }, src, dst);
+}
+
+void Emitter::movw (const Mem & dst, uint16_t imm)
+{
+    byte(0x66);
+    emit({ 0xC7 }, 0, dst);
+    byte(imm);
+    byte(imm >> 8);
+}
+
+void Emitter::lea (Reg dst, const Mem & src)
+{
+    emit({ 0x8D }, dst, src);
+}
+
+
+/*
+    Arithmetic and logic
+*/
+void Emitter::alu (Alu op, Reg dst, Reg src)
+{
+    emit({ uint8_t((op << 3) | 0x01) }, src, dst);
+}
+
+void Emitter::alu (Alu op, Reg dst, int32_t imm)
+{
+    if (isByte(imm))
+    {
+        emit({ 0x83 }, op, dst);
+        byte(imm);
+    }
+    else
+    {
+        emit({ 0x81 }, op, dst);
+        dword(imm);
+    }
+}
+
+void Emitter::alub (Alu op, Reg dst, Reg src)
+{
+    emit({ uint8_t(op << 3) }, src, dst, false, isHigh(src) || isHigh(dst));
+}
+
+void Emitter::alub (Alu op, const Mem & dst, int8_t imm)
+{
+    emit({ 0x80 }, op, dst);
+    byte(imm);
+}
+
+void Emitter::alu (Alu op, const Mem & dst, int32_t imm)
+{
+    if (isByte(imm))
+    {
+        emit({ 0x83 }, op, dst);
+        byte(imm);
+    }
+    else
+    {
+        emit({ 0x81 }, op, dst);
+        dword(imm);
+    }
+}
+
+void Emitter::aluq (Alu op, const Mem & dst, int32_t imm)
+{
+    if (isByte(imm))
+    {
+        emit({ 0x83 }, op, dst, true);
+        byte(imm);
+    }
+    else
+    {
+        emit({ 0x81 }, op, dst, true);
+        dword(imm);
+    }
+}
+
+void Emitter::aluq (Alu op, const Mem & dst, Reg src)
+{
+    emit({ uint8_t((op << 3) | 0x01) }, src, dst, true);
+}
+
+void Emitter::aluq (Alu op, Reg dst, int32_t imm)
+{
+    if (isByte(imm))
+    {
+        emit({ 0x83 }, op, dst, true);
+        byte(imm);
+    }
+    else
+    {
+        emit({ 0x81 }, op, dst, true);
+        dword(imm);
+    }
+}
+
+void Emitter::shl (Reg dst, uint8_t count)
+{
+    emit({ 0xC1 }, 4, dst);
+    byte(count);
+}
+
+void Emitter::shr (Reg dst, uint8_t count)
+{
+    emit({ 0xC1 }, 5, dst);
+    byte(count);
+}
+
+void Emitter::test (Reg dst, Reg src)
+{
+    emit({ 0x85 }, src, dst);
+}
+
+void Emitter::testq (Reg dst, Reg src)
+{
+    emit({ 0x85 }, src, dst, true);
+}
+
+void Emitter::bt (Reg dst, uint8_t bit)
+{
+    emit({ 0x0F, 0xBA }, 4, dst);
+    byte(bit);
+}
+
+void Emitter::setcc (Cond cond, Reg dst)
+{
+    emit({ 0x0F, uint8_t(0x90 | cond) }, 0, dst, false, isHigh(dst));
+}
+
+void Emitter::incb (Reg dst)
+{
+    emit({ 0xFE }, 0, dst, false, isHigh(dst));
+}
+
+void Emitter::decb (Reg dst)
+{
+    emit({ 0xFE }, 1, dst, false, isHigh(dst));
+}
+
+void Emitter::notb (Reg dst)
+{
+    emit({ 0xF6 }, 2, dst, false, isHigh(dst));
+}
+
+
+/*
+    Stack and control flow
+*/
+void Emitter::push (Reg reg)
+{
+    rex(false, 0, 0, reg, false);
+    byte(0x50 | (reg & 7));
+}
+
+void Emitter::pop (Reg reg)
+{
+    rex(false, 0, 0, reg, false);
+    byte(0x58 | (reg & 7));
+}
+
+void Emitter::call (Reg target)
+{
+    emit({ 0xFF }, 2, target);
+}
+
+void Emitter::ret ()
+{
+    byte(0xC3);
+}
+
+void Emitter::jcc (Cond cond, Label target)
+{
+    byte(0x0F);
+    byte(0x80 | cond);
+    rel32(target);
+}
+
+void Emitter::jmp (Label target)
+{
+    byte(0xE9);
+    rel32(target);
+}
+
+
+/*
+    Resolve jumps
+*/
+const std::vector<uint8_t> & Emitter::finish ()
+{
+    for (auto [offset, label] : fixups)
+    {
+        if (labels[label] == SIZE_MAX)
+            throw std::runtime_error("Jump to unbound label");
+
+        int32_t rel = labels[label] - (offset + 4);
+        std::memcpy(&code[offset], &rel, sizeof(rel));
+    }
+
+    fixups.clear();
+
+    return code;
+}
+
+
+void Emitter::clear ()
+{
+    code.clear();
+    labels.clear();
+    fixups.clear();
+}
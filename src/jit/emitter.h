@@ -0,0 +1,166 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+//
+// x86-64 machine code emitter
+//
+//      Encodes the few instruction forms used by Jit into a byte buffer.
+//      Jumps are relative and calls go through a register, so the code
+//      can be copied anywhere once labels are resolved by finish().
+//
+//      Operations are 32-bit unless suffixed: b is 8-bit, w is 16-bit
+//      and q is 64-bit.
+//
+
+class Emitter
+{
+public:
+
+    enum Reg : uint8_t
+    {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8,  R9,  R10, R11, R12, R13, R14, R15,
+
+        // No index register in memory operand
+        NONE = 0xFF
+    };
+
+    enum Cond : uint8_t
+    {
+        O, NO, B, AE, E, NE, BE, A, S, NS, P, NP, L, GE, LE, G
+    };
+
+    enum Alu : uint8_t
+    {
+        ADD, OR, ADC, SBB, AND, SUB, XOR, CMP
+    };
+
+    /*
+        Memory operand [base + index + disp]
+    */
+    struct Mem
+    {
+        Reg base;
+        Reg index;
+        int32_t disp;
+
+        Mem(Reg base, int32_t disp = 0) : base(base), index(NONE), disp(disp) {}
+        Mem(Reg base, Reg index, int32_t disp = 0) : base(base), index(index), disp(disp) {}
+    };
+
+    using Label = size_t;
+
+private:
+
+    std::vector<uint8_t> code;
+
+    // Bound offset of each label, SIZE_MAX until bound
+    std::vector<size_t> labels;
+
+    // Offset of rel32 field and its label
+    std::vector<std::pair<size_t, Label>> fixups;
+
+    void byte (uint8_t value);
+    void dword (uint32_t value);
+
+    /*
+        Optional REX prefix
+        Byte registers SPL, BPL, SIL and DIL need one even without extension bits
+    */
+    void rex (bool w, uint8_t reg, uint8_t index, uint8_t base, bool force);
+
+    /*
+        ModRM, SIB and displacement
+    */
+    void operand (uint8_t reg, Reg rm);
+    void operand (uint8_t reg, const Mem & rm);
+
+    /*
+        Opcode with register or memory operand
+    */
+    void emit (std::initializer_list<uint8_t> opcode, uint8_t reg, Reg rm, bool w = false, bool force = false);
+    void emit (std::initializer_list<uint8_t> opcode, uint8_t reg, const Mem & rm, bool w = false, bool force = false);
+
+    void rel32 (Label label);
+
+public:
+
+    Label label ();
+    void bind (Label label);
+
+    void mov (Reg dst, Reg src);
+    void mov (Reg dst, uint32_t imm);
+    void movq (Reg dst, Reg src);
+    void movq (Reg dst, uint64_t imm);
+    void movq (Reg dst, const Mem & src);
+    void movq (const Mem & dst, Reg src);
+    void movzxb (Reg dst, Reg src);
+    void movzxb (Reg dst, const Mem & src);
+    void movb (const Mem & dst, Reg src);
+    void movw (const Mem & dst, Reg src);
+    void movw (const Mem & dst, uint16_t imm);
+
+    void lea (Reg dst, const Mem & src);
+
+    void alu (Alu op, Reg dst, Reg src);
+    void alu (Alu op, Reg dst, int32_t imm);
+    void alub (Alu op, Reg dst, Reg src);
+    void alub (Alu op, const Mem & dst, int8_t imm);
+    void alu (Alu op, const Mem & dst, int32_t imm);
+    void aluq (Alu op, const Mem & dst, int32_t imm);
+    void aluq (Alu op, const Mem & dst, Reg src);
+    void aluq (Alu op, Reg dst, int32_t imm);
+
+    void shl (Reg dst, uint8_t count);
+    void shr (Reg dst, uint8_t count);
+    void test (Reg dst, Reg src);
+    void testq (Reg dst, Reg src);
+    void bt (Reg dst, uint8_t bit);
+    void setcc (Cond cond, Reg dst);
+    void incb (Reg dst);
+    void decb (Reg dst);
+    void notb (Reg dst);
+
+    void push (Reg reg);
+    void pop (Reg reg);
+    void call (Reg target);
+    void ret ();
+
+    void jcc (Cond cond, Label target);
+    void jmp (Label target);
+
+    /*
+        Resolve jumps, returns code
+    */
+    const std::vector<uint8_t> & finish ();
+
+    /*
+        Start new code
+    */
+    void clear ();
+};
+
+#endif
@@ -0,0 +1,1068 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jit.h"
+
+#include "cpu/cmd.h"
+#include "cpu/map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if !defined(__x86_64__)
+    #error "JIT translates to x86-64 only"
+#endif
+
+// Pinned 6502 registers
+static constexpr auto A = Emitter::RBX;
+static constexpr auto X = Emitter::R12;
+static constexpr auto Y = Emitter::R13;
+static constexpr auto S = Emitter::R14;
+
+// Pinned flags in LazyStatus form
+static constexpr auto N = Emitter::R8;
+static constexpr auto Z = Emitter::R9;
+static constexpr auto C = Emitter::R10;
+static constexpr auto V = Emitter::R11;
+
+// Running CPU and page table of its bus
+static constexpr auto CPU   = Emitter::R15;
+static constexpr auto PAGES = Emitter::RBP;
+
+// Scratch
+static constexpr auto RAX = Emitter::RAX;
+static constexpr auto RCX = Emitter::RCX;
+static constexpr auto RDX = Emitter::RDX;
+static constexpr auto RSI = Emitter::RSI;
+static constexpr auto RDI = Emitter::RDI;
+static constexpr auto RSP = Emitter::RSP;
+
+using Ptr = Emitter::Mem;
+
+// Page descriptor is 1 << 5 bytes
+static constexpr uint8_t pageShift = 5;
+
+// Executable memory, flushed when full
+static constexpr size_t arenaSize = 16 << 20;
+
+// Room kept for the largest block
+static constexpr size_t blockSize = 64 << 10;
+
+// Commands per block
+static constexpr uint32_t limit = 64;
+
+
+/*
+    Map executable memory
+*/
+Jit::Jit(Cpu & cpu, Bus & bus) : PageTracker(bus), cpu(cpu), cache(0x10000, nullptr)
+{
+    static_assert(sizeof(Bus::Page) == 1 << pageShift, "Page descriptor size");
+
+    void * memory = mmap(nullptr, arenaSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("Unable to map executable memory");
+
+    arena = static_cast<uint8_t *>(memory);
+
+    auto offset = [&cpu] (const void * field) {
+        return int32_t(static_cast<const uint8_t *>(field) - reinterpret_cast<const uint8_t *>(&cpu));
+    };
+
+    offA = offset(&cpu.a);
+    offX = offset(&cpu.x);
+    offY = offset(&cpu.y);
+    offS = offset(&cpu.s);
+    offPc = offset(&cpu.pc);
+    offCycles = offset(&cpu.cycles);
+    offCounter = offset(&cpu.counter);
+    offPending = offset(&cpu.pending);
+}
+
+
+Jit::~Jit()
+{
+    munmap(arena, arenaSize);
+}
+
+
+/*
+    Run commands until cycle or stop condition
+
+    Block runs only when no interrupt is pending and its worst case
+    fits in the budget, otherwise one command is interpreted.
+*/
+template <Cpu::Variant Variant>
+Cpu::Stop Jit::run (uint64_t end)
+{
+    auto stop = Cpu::Stop::Budget;
+
+    load();
+
+    while (cpu.cycles < end)
+    {
+        if (!cpu.pending)
+        {
+            auto block = find<Variant>(cpu.pc);
+
+            if (block && block -> code && cpu.cycles + block -> worst <= end)
+            {
+                // Block may be dropped by its own writes, so it is not used after
+                if (block -> code(&cpu, &flags) && cpu.traps)
+                {
+                    stop = Cpu::Stop::Trap;
+                    break;
+                }
+
+                continue;
+            }
+        }
+
+        save();
+
+        auto temp = cpu.pc;
+        cpu.step<Variant>();
+
+        load();
+
+        if (cpu.jammed)
+        {
+            stop = Cpu::Stop::Jam;
+            break;
+        }
+
+        if (cpu.traps && cpu.pc == temp)
+        {
+            stop = Cpu::Stop::Trap;
+            break;
+        }
+    }
+
+    save();
+
+    return stop;
+}
+
+template Cpu::Stop Jit::run<Cpu::Variant::Ricoh2A03> (uint64_t end);
+template Cpu::Stop Jit::run<Cpu::Variant::Nmos6502> (uint64_t end);
+
+
+/*
+    Load N, Z, C and V of running blocks from P
+*/
+void Jit::load ()
+{
+    flags.n = cpu.p.isNegative() ? 0x80 : 0x00;
+    flags.z = !cpu.p.isZero();
+    flags.c = cpu.p.isCarry();
+    flags.v = cpu.p.isOverflow();
+}
+
+
+/*
+    Store N, Z, C and V of running blocks to P
+*/
+void Jit::save ()
+{
+    cpu.p.setNegative ((bool) (flags.n & 0x80));
+    cpu.p.setZero     ((bool) (flags.z == 0));
+    cpu.p.setCarry    ((bool) flags.c);
+    cpu.p.setOverflow ((bool) flags.v);
+}
+
+
+/*
+    Returns block at address
+
+    Blocks of other host memory are kept on bank switch, only blocks
+    translated from RAM are dropped with their page.
+*/
+template <Cpu::Variant Variant>
+Jit::Block * Jit::find (uint16_t pc)
+{
+    auto & page = bus.pages[pc >> 8];
+
+    if (!page.read)
+        return nullptr;
+
+    auto block = cache[pc];
+
+    if (block && block -> host == page.read)
+        return block;
+
+    if (!validate(pc >> 8))
+        return nullptr;
+
+    Key key { pc, page.read };
+    auto found = blocks.find(key);
+
+    if (found == blocks.end())
+    {
+        found = blocks.emplace(key, translate<Variant>(pc, page.read)).first;
+
+        if (page.block >= 0)
+            watching[pc >> 8].push_back(key);
+    }
+
+    cache[pc] = &found -> second;
+
+    return cache[pc];
+}
+
+
+/*
+    Drop blocks translated from RAM page
+    Code stays in executable memory, the block may still be running
+*/
+void Jit::drop (uint8_t index)
+{
+    for (auto & key : watching[index])
+    {
+        auto found = blocks.find(key);
+
+        if (found != blocks.end())
+        {
+            if (cache[key.pc] == &found -> second)
+                cache[key.pc] = nullptr;
+
+            blocks.erase(found);
+        }
+    }
+
+    watching[index].clear();
+}
+
+
+/*
+    Drop all blocks and reuse executable memory
+*/
+void Jit::flush ()
+{
+    blocks.clear();
+    std::fill(cache.begin(), cache.end(), nullptr);
+
+    for (auto & keys : watching) {
+        keys.clear();
+    }
+
+    used = 0;
+}
+
+
+/*
+    Command is translated
+    Decimal mode is left to the interpreter on variants having it
+*/
+template <Cpu::Variant Variant>
+bool Jit::isSupported (const Cmd & cmd)
+{
+    if (cmd.isIllegal())
+        return false;
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::ADC:
+        case Mnemonic::SBC:
+            return Variant == Cpu::Variant::Ricoh2A03;
+
+        case Mnemonic::JMP:
+            return cmd.addressing == Mode::ABS;
+
+        case Mnemonic::LDA: case Mnemonic::LDX: case Mnemonic::LDY:
+        case Mnemonic::STA: case Mnemonic::STX: case Mnemonic::STY:
+        case Mnemonic::AND: case Mnemonic::ORA: case Mnemonic::EOR:
+        case Mnemonic::CMP: case Mnemonic::CPX: case Mnemonic::CPY:
+        case Mnemonic::BIT:
+        case Mnemonic::ASL: case Mnemonic::LSR: case Mnemonic::ROL: case Mnemonic::ROR:
+        case Mnemonic::INC: case Mnemonic::DEC:
+        case Mnemonic::INX: case Mnemonic::INY: case Mnemonic::DEX: case Mnemonic::DEY:
+        case Mnemonic::TAX: case Mnemonic::TAY: case Mnemonic::TXA: case Mnemonic::TYA:
+        case Mnemonic::TSX: case Mnemonic::TXS:
+        case Mnemonic::CLC: case Mnemonic::SEC: case Mnemonic::CLV: case Mnemonic::NOP:
+        case Mnemonic::PHA: case Mnemonic::PLA:
+        case Mnemonic::JSR: case Mnemonic::RTS:
+        case Mnemonic::BCC: case Mnemonic::BCS: case Mnemonic::BEQ: case Mnemonic::BNE:
+        case Mnemonic::BMI: case Mnemonic::BPL: case Mnemonic::BVC: case Mnemonic::BVS:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+/*
+    Translate commands from address up to end of block
+*/
+template <Cpu::Variant Variant>
+Jit::Block Jit::translate (uint16_t pc, const uint8_t * host)
+{
+    if (used + blockSize > arenaSize)
+        flush();
+
+    emitter.clear();
+    exits.clear();
+    stubs.clear();
+
+    epilogue = emitter.label();
+
+    prologue();
+
+    Step step { pc, pc, 0, 0, 0, false };
+    uint32_t worst = 0;
+
+    // Block ends on its page
+    while (step.count < limit && (step.next >> 8) == (pc >> 8))
+    {
+        uint8_t offset = step.next & 0xFF;
+        auto & cmd = Map::getCommand<Variant>(host[offset]);
+
+        if (!isSupported<Variant>(cmd) || offset + cmd.getBytes() > 0x100)
+            break;
+
+        step.at     = step.next;
+        step.next   = step.at + cmd.getBytes();
+        step.before = step.after;
+        step.after += cmd.cycles;
+        step.count++;
+
+        step.last = cmd.isRel()
+            || cmd.mnemonic == Mnemonic::JMP
+            || cmd.mnemonic == Mnemonic::JSR
+            || cmd.mnemonic == Mnemonic::RTS;
+
+        // Page crossing and taken branch
+        worst += cmd.cycles + (cmd.isCross() ? 1 : 0) + (cmd.isRel() ? 2 : 0);
+
+        command(cmd, step, host + offset);
+
+        if (step.last)
+            break;
+    }
+
+    if (step.count == 0)
+        return Block { host, nullptr, 0 };
+
+    if (!step.last)
+        leave(step);
+
+    finish();
+
+    auto & code = emitter.finish();
+
+    if (used + code.size() > arenaSize)
+        throw std::runtime_error("Translated block exceeds executable memory");
+
+    // Pages are writable only while block is copied
+    uintptr_t page  = sysconf(_SC_PAGESIZE);
+    uintptr_t first = reinterpret_cast<uintptr_t>(arena + used) & ~(page - 1);
+    uintptr_t last  = reinterpret_cast<uintptr_t>(arena + used + code.size() + page - 1) & ~(page - 1);
+
+    mprotect(reinterpret_cast<void *>(first), last - first, PROT_READ | PROT_WRITE);
+    std::memcpy(arena + used, code.data(), code.size());
+    mprotect(reinterpret_cast<void *>(first), last - first, PROT_READ | PROT_EXEC);
+
+    auto native = reinterpret_cast<Native>(arena + used);
+
+    // Next block starts aligned
+    used = (used + code.size() + 15) & ~size_t(15);
+
+    return Block { host, native, uint16_t(worst) };
+}
+
+
+/*
+    Save callee registers, load pinned registers
+*/
+void Jit::prologue ()
+{
+    auto & e = emitter;
+
+    e.push(Emitter::RBX);
+    e.push(Emitter::RBP);
+    e.push(Emitter::R12);
+    e.push(Emitter::R13);
+    e.push(Emitter::R14);
+    e.push(Emitter::R15);
+
+    // Flags pointer, keeps stack aligned for calls
+    e.aluq(Emitter::SUB, RSP, 24);
+    e.movq(Ptr(RSP), RSI);
+
+    e.movq(CPU, RDI);
+    e.movq(PAGES, reinterpret_cast<uint64_t>(bus.pages.data()));
+
+    e.movzxb(A, Ptr(CPU, offA));
+    e.movzxb(X, Ptr(CPU, offX));
+    e.movzxb(Y, Ptr(CPU, offY));
+    e.movzxb(S, Ptr(CPU, offS));
+
+    e.movzxb(N, Ptr(RSI, offsetof(Flags, n)));
+    e.movzxb(Z, Ptr(RSI, offsetof(Flags, z)));
+    e.movzxb(C, Ptr(RSI, offsetof(Flags, c)));
+    e.movzxb(V, Ptr(RSI, offsetof(Flags, v)));
+}
+
+
+/*
+    Emit out of line code, store pinned registers and return
+*/
+void Jit::finish ()
+{
+    auto & e = emitter;
+
+    for (auto & stub : stubs) {
+        stub();
+    }
+
+    for (auto & [label, step] : exits)
+    {
+        e.bind(label);
+        leave(step);
+    }
+
+    e.bind(epilogue);
+
+    e.movq(RSI, Ptr(RSP));
+
+    e.movb(Ptr(RSI, offsetof(Flags, n)), N);
+    e.movb(Ptr(RSI, offsetof(Flags, z)), Z);
+    e.movb(Ptr(RSI, offsetof(Flags, c)), C);
+    e.movb(Ptr(RSI, offsetof(Flags, v)), V);
+
+    e.movb(Ptr(CPU, offA), A);
+    e.movb(Ptr(CPU, offX), X);
+    e.movb(Ptr(CPU, offY), Y);
+    e.movb(Ptr(CPU, offS), S);
+
+    e.aluq(Emitter::ADD, RSP, 24);
+
+    e.pop(Emitter::R15);
+    e.pop(Emitter::R14);
+    e.pop(Emitter::R13);
+    e.pop(Emitter::R12);
+    e.pop(Emitter::RBP);
+    e.pop(Emitter::RBX);
+
+    e.ret();
+}
+
+
+/*
+    Leave block at address
+*/
+void Jit::leave (uint16_t pc, uint32_t cycles, uint32_t count, bool trap)
+{
+    auto & e = emitter;
+
+    e.aluq(Emitter::ADD, Ptr(CPU, offCycles), cycles);
+    e.aluq(Emitter::ADD, Ptr(CPU, offCounter), count);
+    e.movw(Ptr(CPU, offPc), pc);
+    e.mov(RAX, trap ? 1 : 0);
+    e.jmp(epilogue);
+}
+
+void Jit::leave (const Step & step)
+{
+    leave(step.next, step.after, step.count, false);
+}
+
+
+/*
+    Exit after command, emitted out of line
+*/
+Emitter::Label Jit::side (const Step & step)
+{
+    auto label = emitter.label();
+    exits.emplace_back(label, step);
+
+    return label;
+}
+
+
+/*
+    Call bus access helper out of line
+
+    Cycle counter is advanced to start of command meanwhile, so devices
+    see the same cycle as in the interpreter.
+*/
+void Jit::call (const Address & address, const Step & step, uint64_t helper)
+{
+    auto & e = emitter;
+
+    e.push(RSI);
+    e.push(RDI);
+    e.push(N);
+    e.push(Z);
+    e.push(C);
+    e.push(V);
+
+    if (step.before)
+        e.aluq(Emitter::ADD, Ptr(CPU, offCycles), step.before);
+
+    e.movq(RDI, CPU);
+
+    if (address.fixed)
+        e.mov(RSI, address.value);
+
+    e.movq(RAX, helper);
+    e.call(RAX);
+
+    if (step.before)
+        e.aluq(Emitter::SUB, Ptr(CPU, offCycles), step.before);
+
+    e.pop(V);
+    e.pop(C);
+    e.pop(Z);
+    e.pop(N);
+    e.pop(RDI);
+    e.pop(RSI);
+}
+
+
+/*
+    Read byte at address to EAX
+    Memory is read through page table, devices through fetch()
+*/
+void Jit::read (const Address & address, const Step & step)
+{
+    auto & e = emitter;
+
+    auto slow = e.label();
+    auto back = e.label();
+
+    int32_t read = offsetof(Bus::Page, read);
+
+    if (address.fixed) {
+        e.movq(RDX, Ptr(PAGES, ((address.value >> 8) << pageShift) + read));
+    } else if (address.page >= 0) {
+        e.movq(RDX, Ptr(PAGES, (address.page << pageShift) + read));
+    } else {
+        e.mov(RCX, RSI);
+        e.shr(RCX, 8);
+        e.shl(RCX, pageShift);
+        e.movq(RDX, Ptr(PAGES, RCX, read));
+    }
+
+    e.testq(RDX, RDX);
+    e.jcc(Emitter::E, slow);
+
+    if (address.fixed) {
+        e.movzxb(RAX, Ptr(RDX, address.value & 0xFF));
+    } else {
+        e.movzxb(RCX, RSI);
+        e.movzxb(RAX, Ptr(RDX, RCX));
+    }
+
+    e.bind(back);
+
+    stubs.push_back([=] {
+        emitter.bind(slow);
+        call(address, step, reinterpret_cast<uint64_t>(&Jit::fetch));
+        emitter.movzxb(RAX, RAX);
+        emitter.jmp(back);
+    });
+}
+
+
+/*
+    Write EAX to address
+    Devices and watched or shared RAM are written by store(),
+    block leaves after such write unless it ends anyway
+*/
+void Jit::write (const Address & address, const Step & step)
+{
+    auto & e = emitter;
+
+    auto slow = e.label();
+    auto back = e.label();
+
+    int32_t write = offsetof(Bus::Page, write);
+
+    if (address.fixed) {
+        e.movq(RCX, Ptr(PAGES, ((address.value >> 8) << pageShift) + write));
+    } else if (address.page >= 0) {
+        e.movq(RCX, Ptr(PAGES, (address.page << pageShift) + write));
+    } else {
+        e.mov(RCX, RSI);
+        e.shr(RCX, 8);
+        e.shl(RCX, pageShift);
+        e.movq(RCX, Ptr(PAGES, RCX, write));
+    }
+
+    e.testq(RCX, RCX);
+    e.jcc(Emitter::E, slow);
+
+    if (address.fixed) {
+        e.movb(Ptr(RCX, address.value & 0xFF), RAX);
+    } else {
+        e.movzxb(RDX, RSI);
+        e.movb(Ptr(RCX, RDX), RAX);
+    }
+
+    e.bind(back);
+
+    stubs.push_back([=] {
+        emitter.bind(slow);
+        emitter.mov(RDX, RAX);
+        call(address, step, reinterpret_cast<uint64_t>(&Jit::store));
+
+        if (step.last) {
+            emitter.jmp(back);
+        } else {
+            emitter.jmp(side(step));
+        }
+    });
+}
+
+
+/*
+    Bus access of translated code
+*/
+uint8_t Jit::fetch (Cpu * cpu, uint16_t index)
+{
+    return cpu -> mem.read(index);
+}
+
+void Jit::store (Cpu * cpu, uint16_t index, uint8_t data)
+{
+    cpu -> mem.write(index, data);
+}
+
+
+/*
+    Effective address of command
+    Dynamic address is computed to ESI, page crossing of read commands to EDI
+*/
+Jit::Address Jit::address (const Cmd & cmd, const Step & step, const uint8_t * bytes)
+{
+    auto & e = emitter;
+
+    uint16_t base = bytes[1] | (cmd.getBytes() > 2 ? bytes[2] << 8 : 0);
+
+    switch (cmd.addressing)
+    {
+        case Mode::ZPG:
+        case Mode::ABS:
+            return Address { true, base, -1 };
+
+        case Mode::ZPGX:
+        case Mode::ZPGY:
+            e.lea(RSI, Ptr(cmd.addressing == Mode::ZPGX ? X : Y, base));
+            e.movzxb(RSI, RSI);
+            return Address { false, 0, 0 };
+
+        case Mode::ABSX:
+        case Mode::ABSY:
+        {
+            auto index = (cmd.addressing == Mode::ABSX) ? X : Y;
+
+            e.lea(RSI, Ptr(index, base));
+            e.alu(Emitter::AND, RSI, 0xFFFF);
+
+            if (cmd.isCross())
+            {
+                e.lea(RDI, Ptr(index, base & 0xFF));
+                e.shr(RDI, 8);
+            }
+
+            return Address { false, 0, -1 };
+        }
+
+        case Mode::INDX:
+            e.lea(RSI, Ptr(X, base));
+            e.movzxb(RSI, RSI);
+            read(Address { false, 0, 0 }, step);
+            e.mov(RDI, RAX);
+
+            e.lea(RSI, Ptr(X, base + 1));
+            e.movzxb(RSI, RSI);
+            read(Address { false, 0, 0 }, step);
+            e.shl(RAX, 8);
+            e.alu(Emitter::OR, RAX, RDI);
+            e.mov(RSI, RAX);
+
+            return Address { false, 0, -1 };
+
+        case Mode::INDY:
+            read(Address { true, base, -1 }, step);
+            e.mov(RDI, RAX);
+
+            read(Address { true, uint16_t((base + 1) & 0xFF), -1 }, step);
+            e.shl(RAX, 8);
+            e.alu(Emitter::OR, RAX, RDI);
+
+            e.lea(RSI, Ptr(RAX, Y));
+            e.alu(Emitter::AND, RSI, 0xFFFF);
+
+            if (cmd.isCross())
+            {
+                e.lea(RDI, Ptr(RDI, Y));
+                e.shr(RDI, 8);
+            }
+
+            return Address { false, 0, -1 };
+
+        default:
+            throw std::runtime_error("Addressing mode is not translated");
+    }
+}
+
+
+/*
+    Read operand of command to EAX
+    Page crossing adds its cycle once command has read memory
+*/
+void Jit::operand (const Cmd & cmd, const Step & step, const uint8_t * bytes)
+{
+    if (cmd.addressing == Mode::IMM)
+    {
+        emitter.mov(RAX, bytes[1]);
+        return;
+    }
+
+    read(address(cmd, step, bytes), step);
+
+    if (cmd.isCross())
+        emitter.aluq(Emitter::ADD, Ptr(CPU, offCycles), RDI);
+}
+
+
+/*
+    N and Z by value
+*/
+void Jit::result (Emitter::Reg reg)
+{
+    emitter.mov(N, reg);
+    emitter.mov(Z, reg);
+}
+
+
+/*
+    Shift, rotate, increment or decrement register
+*/
+void Jit::modify (const Cmd & cmd, Emitter::Reg reg)
+{
+    auto & e = emitter;
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::ASL:
+            e.mov(C, reg);
+            e.shr(C, 7);
+            e.shl(reg, 1);
+            e.alu(Emitter::AND, reg, 0xFF);
+            break;
+
+        case Mnemonic::LSR:
+            e.mov(C, reg);
+            e.alu(Emitter::AND, C, 1);
+            e.shr(reg, 1);
+            break;
+
+        case Mnemonic::ROL:
+            e.mov(RCX, reg);
+            e.shl(reg, 1);
+            e.alu(Emitter::OR, reg, C);
+            e.alu(Emitter::AND, reg, 0xFF);
+            e.shr(RCX, 7);
+            e.mov(C, RCX);
+            break;
+
+        case Mnemonic::ROR:
+            e.mov(RCX, reg);
+            e.shr(reg, 1);
+            e.mov(RDX, C);
+            e.shl(RDX, 7);
+            e.alu(Emitter::OR, reg, RDX);
+            e.alu(Emitter::AND, RCX, 1);
+            e.mov(C, RCX);
+            break;
+
+        case Mnemonic::INC:
+            e.incb(reg);
+            break;
+
+        case Mnemonic::DEC:
+            e.decb(reg);
+            break;
+
+        default:
+            break;
+    }
+
+    result(reg);
+}
+
+
+/*
+    Compare EAX with register as Cpu::CMP does
+*/
+void Jit::compare (Emitter::Reg reg)
+{
+    auto & e = emitter;
+
+    e.alu(Emitter::CMP, RAX, reg);
+
+    e.setcc(Emitter::A, N);
+    e.setcc(Emitter::NE, Z);
+    e.setcc(Emitter::BE, C);
+
+    e.shl(N, 7);
+}
+
+
+/*
+    Add EAX to accumulator with carry, x86 ADC gives C and V
+*/
+void Jit::add ()
+{
+    auto & e = emitter;
+
+    e.bt(C, 0);
+    e.alub(Emitter::ADC, A, RAX);
+
+    e.setcc(Emitter::B, C);
+    e.setcc(Emitter::O, V);
+
+    result(A);
+}
+
+
+/*
+    Push EAX, stack pointer moves before write so write ends command
+*/
+void Jit::push (const Step & step)
+{
+    emitter.lea(RSI, Ptr(S, 0x100));
+    emitter.decb(S);
+
+    write(Address { false, 0, 1 }, step);
+}
+
+
+/*
+    Pull to EAX
+*/
+void Jit::pull (const Step & step)
+{
+    emitter.incb(S);
+    emitter.lea(RSI, Ptr(S, 0x100));
+
+    read(Address { false, 0, 1 }, step);
+}
+
+
+/*
+    Branch ends block on both paths
+*/
+void Jit::branch (const Cmd & cmd, const Step & step, const uint8_t * bytes)
+{
+    auto & e = emitter;
+
+    auto taken = e.label();
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::BPL: e.bt(N, 7);   e.jcc(Emitter::AE, taken); break;
+        case Mnemonic::BMI: e.bt(N, 7);   e.jcc(Emitter::B,  taken); break;
+        case Mnemonic::BVC: e.test(V, V); e.jcc(Emitter::E,  taken); break;
+        case Mnemonic::BVS: e.test(V, V); e.jcc(Emitter::NE, taken); break;
+        case Mnemonic::BCC: e.test(C, C); e.jcc(Emitter::E,  taken); break;
+        case Mnemonic::BCS: e.test(C, C); e.jcc(Emitter::NE, taken); break;
+        case Mnemonic::BNE: e.test(Z, Z); e.jcc(Emitter::NE, taken); break;
+        case Mnemonic::BEQ: e.test(Z, Z); e.jcc(Emitter::E,  taken); break;
+        default: break;
+    }
+
+    leave(step);
+
+    // Taken branch adds a cycle, one more if it lands on another page
+    uint16_t target = step.next + (int8_t) bytes[1];
+    uint32_t penalty = ((step.next ^ target) & 0xFF00) ? 2 : 1;
+
+    e.bind(taken);
+    leave(target, step.after + penalty, step.count, target == step.at);
+}
+
+
+/*
+    Translate command
+*/
+void Jit::command (const Cmd & cmd, const Step & step, const uint8_t * bytes)
+{
+    auto & e = emitter;
+
+    uint16_t target = bytes[1] | (cmd.getBytes() > 2 ? bytes[2] << 8 : 0);
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::LDA: operand(cmd, step, bytes); e.mov(A, RAX); result(A); break;
+        case Mnemonic::LDX: operand(cmd, step, bytes); e.mov(X, RAX); result(X); break;
+        case Mnemonic::LDY: operand(cmd, step, bytes); e.mov(Y, RAX); result(Y); break;
+
+        case Mnemonic::STA:
+        case Mnemonic::STX:
+        case Mnemonic::STY:
+        {
+            auto where = address(cmd, step, bytes);
+            auto reg = (cmd.mnemonic == Mnemonic::STA) ? A : (cmd.mnemonic == Mnemonic::STX) ? X : Y;
+
+            e.mov(RAX, reg);
+            write(where, step);
+            break;
+        }
+
+        case Mnemonic::ADC:
+            operand(cmd, step, bytes);
+            add();
+            break;
+
+        case Mnemonic::SBC:
+            operand(cmd, step, bytes);
+            e.notb(RAX);
+            add();
+            break;
+
+        case Mnemonic::AND: operand(cmd, step, bytes); e.alu(Emitter::AND, A, RAX); result(A); break;
+        case Mnemonic::ORA: operand(cmd, step, bytes); e.alu(Emitter::OR,  A, RAX); result(A); break;
+        case Mnemonic::EOR: operand(cmd, step, bytes); e.alu(Emitter::XOR, A, RAX); result(A); break;
+
+        case Mnemonic::CMP: operand(cmd, step, bytes); compare(A); break;
+        case Mnemonic::CPX: operand(cmd, step, bytes); compare(X); break;
+        case Mnemonic::CPY: operand(cmd, step, bytes); compare(Y); break;
+
+        case Mnemonic::BIT:
+            operand(cmd, step, bytes);
+            e.mov(N, RAX);
+            e.mov(V, RAX);
+            e.shr(V, 6);
+            e.alu(Emitter::AND, V, 1);
+            e.mov(Z, RAX);
+            e.alu(Emitter::AND, Z, A);
+            break;
+
+        case Mnemonic::ASL:
+        case Mnemonic::LSR:
+        case Mnemonic::ROL:
+        case Mnemonic::ROR:
+        case Mnemonic::INC:
+        case Mnemonic::DEC:
+        {
+            if (cmd.isAcc())
+            {
+                modify(cmd, A);
+                break;
+            }
+
+            auto where = address(cmd, step, bytes);
+
+            read(where, step);
+            modify(cmd, RAX);
+            write(where, step);
+            break;
+        }
+
+        case Mnemonic::INX: e.incb(X); result(X); break;
+        case Mnemonic::INY: e.incb(Y); result(Y); break;
+        case Mnemonic::DEX: e.decb(X); result(X); break;
+        case Mnemonic::DEY: e.decb(Y); result(Y); break;
+
+        case Mnemonic::TAX: e.mov(X, A); result(X); break;
+        case Mnemonic::TAY: e.mov(Y, A); result(Y); break;
+        case Mnemonic::TXA: e.mov(A, X); result(A); break;
+        case Mnemonic::TYA: e.mov(A, Y); result(A); break;
+        case Mnemonic::TSX: e.mov(X, S); result(X); break;
+        case Mnemonic::TXS: e.mov(S, X); break;
+
+        case Mnemonic::CLC: e.alu(Emitter::XOR, C, C); break;
+        case Mnemonic::SEC: e.mov(C, 1); break;
+        case Mnemonic::CLV: e.alu(Emitter::XOR, V, V); break;
+        case Mnemonic::NOP: break;
+
+        case Mnemonic::PHA:
+            e.mov(RAX, A);
+            push(step);
+            break;
+
+        case Mnemonic::PLA:
+            pull(step);
+            e.mov(A, RAX);
+            result(A);
+            break;
+
+        case Mnemonic::JMP:
+            leave(target, step.after, step.count, target == step.at);
+            break;
+
+        case Mnemonic::JSR:
+        {
+            // Return address is last byte of JSR
+            uint16_t last = step.at + 2;
+
+            e.mov(RAX, last >> 8);
+            push(step);
+            e.mov(RAX, last & 0xFF);
+            push(step);
+
+            leave(target, step.after, step.count, target == step.at);
+            break;
+        }
+
+        case Mnemonic::RTS:
+            pull(step);
+            e.mov(RDI, RAX);
+            pull(step);
+            e.shl(RAX, 8);
+            e.alu(Emitter::OR, RAX, RDI);
+            e.alu(Emitter::ADD, RAX, 1);
+            e.alu(Emitter::AND, RAX, 0xFFFF);
+
+            e.aluq(Emitter::ADD, Ptr(CPU, offCycles), step.after);
+            e.aluq(Emitter::ADD, Ptr(CPU, offCounter), step.count);
+            e.movw(Ptr(CPU, offPc), RAX);
+
+            // Returned to itself
+            e.alu(Emitter::CMP, RAX, step.at);
+            e.mov(RAX, 0);
+            e.setcc(Emitter::E, RAX);
+            e.jmp(epilogue);
+            break;
+
+        default:
+            if (cmd.isRel())
+                branch(cmd, step, bytes);
+            break;
+    }
+
+    // Device read may have raised an interrupt, taken before next command
+    bool reads = cmd.addressing != Mode::IMM
+        && cmd.addressing != Mode::IMP
+        && cmd.addressing != Mode::ACC
+        && cmd.addressing != Mode::REL;
+
+    if ((reads || cmd.mnemonic == Mnemonic::PLA) && !step.last)
+    {
+        e.alub(Emitter::CMP, Ptr(CPU, offPending), 0);
+        e.jcc(Emitter::NE, side(step));
+    }
+}
@@ -0,0 +1,239 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "emitter.h"
+#include "bus/bus.h"
+#include "bus/pagetracker.h"
+#include "cpu/cpu.h"
+
+class Cmd;
+
+//
+// Dynamic recompiler
+//
+//      Translates basic blocks of documented 6502 commands to x86-64.
+//      A block starts at PC and ends with a branch, jump or return, at
+//      the end of its page or before the first command it cannot take,
+//      which is then run by the interpreter.
+//
+//      A, X, Y and S are pinned to host registers and N, Z, C and V are
+//      kept in LazyStatus form while a block runs. Memory is accessed
+//      through the page table, only devices and watched RAM are called.
+//
+//      Blocks are cached by address and host memory of their page, so a
+//      bank switch selects other blocks. RAM blocks holding translated
+//      code are watched on Bus and their blocks are dropped on write.
+//
+//      Every command runs with the same bus accesses and cycle counter
+//      as in the interpreter. A block leaves early after a device write
+//      or when a device read raised an interrupt, and runs only if it
+//      fits in the cycle budget, so runs stop on the same command.
+//
+//      x86-64 System V hosts only, built with JIT option.
+//
+
+class Jit : public PageTracker
+{
+public:
+
+    // N, Z, C and V of running blocks, N is bit 7 and Z is set by zero
+    struct Flags
+    {
+        uint8_t n = 0;
+        uint8_t z = 1;
+        uint8_t c = 0;
+        uint8_t v = 0;
+    };
+
+private:
+
+    // Translated block, returns 1 if last command jumped to itself
+    using Native = int (*) (Cpu * cpu, Flags * flags);
+
+    struct Block
+    {
+        // Host memory of page block was translated from
+        const uint8_t * host = nullptr;
+
+        // Translated code, nullptr if first command is not translatable
+        Native code = nullptr;
+
+        // Most cycles block can take
+        uint16_t worst = 0;
+    };
+
+    // Block is identified by address and host memory of its page
+    struct Key
+    {
+        uint16_t pc;
+        const uint8_t * host;
+
+        bool operator== (const Key & other) const {
+            return pc == other.pc && host == other.host;
+        }
+    };
+
+    struct Hash
+    {
+        size_t operator() (const Key & key) const {
+            return std::hash<const uint8_t *>()(key.host) ^ key.pc;
+        }
+    };
+
+    // Translation time accounting of current command
+    struct Step
+    {
+        uint16_t at;       // Address of command
+        uint16_t next;     // Address of next command
+        uint32_t before;   // Static cycles of block before command
+        uint32_t after;    // Static cycles of block including command
+        uint32_t count;    // Commands of block including command
+        bool last;         // Command ends block
+    };
+
+    // Operand address, static or in ESI
+    struct Address
+    {
+        bool fixed;
+        uint16_t value;
+
+        // Page of dynamic address if known, -1 otherwise
+        int16_t page;
+    };
+
+    Cpu & cpu;
+
+    Flags flags;
+
+    // Translated blocks
+    std::unordered_map<Key, Block, Hash> blocks;
+
+    // Last block found at address
+    std::vector<Block *> cache;
+
+    // Blocks translated from RAM page
+    std::array<std::vector<Key>, 256> watching;
+
+    // Executable memory
+    uint8_t * arena = nullptr;
+    size_t used = 0;
+
+    Emitter emitter;
+
+    // Out of line code of current block
+    std::vector<std::pair<Emitter::Label, Step>> exits;
+    std::vector<std::function<void()>> stubs;
+
+    Emitter::Label epilogue;
+
+    // Offsets of Cpu fields
+    int32_t offA, offX, offY, offS, offPc, offCycles, offCounter, offPending;
+
+    /*
+        Load N, Z, C and V from P and back
+    */
+    void load ();
+    void save ();
+
+    /*
+        Returns block at address, translates it on first run
+        nullptr if page is not memory
+    */
+    template <Cpu::Variant V>
+    Block * find (uint16_t pc);
+
+    /*
+        Translate block
+    */
+    template <Cpu::Variant V>
+    Block translate (uint16_t pc, const uint8_t * host);
+
+    /*
+        Command is translated
+    */
+    template <Cpu::Variant V>
+    static bool isSupported (const Cmd & cmd);
+
+    /*
+        Drop all blocks, e.g. when executable memory is full
+    */
+    void flush ();
+
+    /*
+        Drop blocks translated from RAM page
+    */
+    void drop (uint8_t index) override;
+
+    /*
+        Code generation of commands
+    */
+    void command (const Cmd & cmd, const Step & step, const uint8_t * bytes);
+
+    Address address (const Cmd & cmd, const Step & step, const uint8_t * bytes);
+    void operand (const Cmd & cmd, const Step & step, const uint8_t * bytes);
+
+    void read (const Address & address, const Step & step);
+    void write (const Address & address, const Step & step);
+
+    void call (const Address & address, const Step & step, uint64_t helper);
+
+    void result (Emitter::Reg reg);
+    void modify (const Cmd & cmd, Emitter::Reg reg);
+    void compare (Emitter::Reg reg);
+    void add ();
+    void push (const Step & step);
+    void pull (const Step & step);
+
+    void branch (const Cmd & cmd, const Step & step, const uint8_t * bytes);
+    void leave (uint16_t pc, uint32_t cycles, uint32_t count, bool trap);
+    void leave (const Step & step);
+    Emitter::Label side (const Step & step);
+
+    void prologue ();
+    void finish ();
+
+    /*
+        Bus access of translated code
+    */
+    static uint8_t fetch (Cpu * cpu, uint16_t index);
+    static void store (Cpu * cpu, uint16_t index, uint8_t data);
+
+public:
+
+    Jit(Cpu & cpu, Bus & bus);
+
+    /*
+        Run commands until cycle or stop condition
+        Commands outside of blocks are run by interpreter
+    */
+    template <Cpu::Variant V>
+    Cpu::Stop run (uint64_t end);
+
+    ~Jit();
+};
+
+#endif
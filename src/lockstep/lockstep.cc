@@ -0,0 +1,1125 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lockstep.h"
+
+#include "cpu/cmd.h"
+#include "cpu/map.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Group runs on its own lanes when it holds less than this share of lanes
+static constexpr size_t narrow = 16;
+
+// Narrow rounds in a row before every lane runs a slice on its own
+static constexpr uint32_t patience = 256;
+
+// CPU cycles every lane runs per slice
+static constexpr uint64_t span = 2000;
+
+// Status flags in pushed form
+static constexpr uint8_t Carry    = 1 << 0;
+static constexpr uint8_t Zero     = 1 << 1;
+static constexpr uint8_t Decimal  = 1 << 3;
+static constexpr uint8_t Overflow = 1 << 6;
+static constexpr uint8_t Negative = 1 << 7;
+
+
+/*
+    N and Z flags of value
+*/
+static inline uint8_t nz (uint8_t value)
+{
+    return (value & Negative) | (value ? 0 : Zero);
+}
+
+
+/*
+    Update where lane mask is set, value elsewhere
+    Masks are 0xFF or 0x00, so lane loops need no branches
+*/
+static inline uint8_t blend (uint8_t value, uint8_t update, uint8_t mask)
+{
+    return (value & ~mask) | (update & mask);
+}
+
+static inline uint16_t blend16 (uint16_t value, uint16_t update, uint8_t mask)
+{
+    uint16_t wide = mask * 0x0101;
+    return (value & ~wide) | (update & wide);
+}
+
+
+/*
+    Command has lane handler
+*/
+static bool isGrouped (const Cmd & cmd)
+{
+    if (cmd.isIllegal())
+        return false;
+
+    switch (cmd.mnemonic)
+    {
+        // Interrupt disable changes are taken by CPU of lane
+        case Mnemonic::BRK:
+        case Mnemonic::RTI:
+        case Mnemonic::PHP:
+        case Mnemonic::PLP:
+        case Mnemonic::CLI:
+        case Mnemonic::SEI:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+
+/*
+    Fork lanes from CPU on bare bus
+    Registers, configuration and RAM are copied, RAM on write
+*/
+Lockstep::Lockstep (const Cpu & cpu, Bus & bus, size_t lanes) :
+    lanes(lanes),
+    chunks((lanes + chunk - 1) / chunk),
+    stops(lanes, Cpu::Stop::Budget)
+{
+    for (size_t lane = 0; lane < lanes; lane++)
+    {
+        buses.push_back(bus.fork());
+        cpus.push_back(cpu.fork(*buses.back()));
+
+        load(lane);
+    }
+
+    decimal = cpu.variant == Cpu::Variant::Nmos6502;
+
+    // Forks keep page table of bus, so lanes share its mirrors
+    for (unsigned page = 0; page < mirrors.size(); page++)
+    {
+        auto block = bus.pages[page].block;
+        auto next  = page;
+
+        do {
+            next = (next + 1) & 0xFF;
+        } while (block >= 0 && bus.pages[next].block != block);
+
+        mirrors[page] = (block >= 0) ? next : page;
+    }
+}
+
+
+Lockstep::~Lockstep() = default;
+
+
+/*
+    Copy registers of lane from its CPU
+*/
+void Lockstep::load (size_t lane)
+{
+    auto & cpu = *cpus[lane];
+    auto & c = chunks[lane / chunk];
+    auto i = lane % chunk;
+
+    c.a[i] = cpu.a;
+    c.x[i] = cpu.x;
+    c.y[i] = cpu.y;
+    c.s[i] = cpu.s;
+    c.p[i] = cpu.p;
+
+    c.pc[i]       = cpu.pc;
+    c.cycles[i]   = cpu.cycles;
+    c.counters[i] = cpu.counter;
+    c.solo[i]     = (cpu.pending || cpu.trace != UINT64_MAX) ? 0xFF : 0x00;
+}
+
+
+/*
+    Copy registers of lane to its CPU
+*/
+void Lockstep::store (size_t lane)
+{
+    auto & cpu = *cpus[lane];
+    auto & c = chunks[lane / chunk];
+    auto i = lane % chunk;
+
+    cpu.a = c.a[i];
+    cpu.x = c.x[i];
+    cpu.y = c.y[i];
+    cpu.s = c.s[i];
+    cpu.p = c.p[i];
+
+    cpu.pc      = c.pc[i];
+    cpu.cycles  = c.cycles[i];
+    cpu.counter = c.counters[i];
+}
+
+
+/*
+    Returns lowest PC of live lanes
+*/
+uint16_t Lockstep::leader () const
+{
+    uint16_t lowest = 0xFFFF;
+
+    for (auto & c : chunks)
+    {
+        #if defined(__AVX2__)
+
+            // Stopped lanes count as $FFFF, 16 lanes per vector
+            auto live = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.live));
+            auto low  = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(live));
+            auto high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(live, 1));
+
+            auto all = _mm256_set1_epi16(-1);
+
+            low  = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.pc)), _mm256_xor_si256(low, all));
+            high = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.pc + 16)), _mm256_xor_si256(high, all));
+
+            auto both = _mm256_min_epu16(low, high);
+            auto half = _mm_min_epu16(_mm256_castsi256_si128(both), _mm256_extracti128_si256(both, 1));
+
+            lowest = std::min<uint16_t>(lowest, _mm_extract_epi16(_mm_minpos_epu16(half), 0));
+
+        #else
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                uint16_t key = c.live[i] ? c.pc[i] : 0xFFFF;
+                lowest = std::min(lowest, key);
+            }
+
+        #endif
+    }
+
+    return lowest;
+}
+
+
+/*
+    Mark live lanes at PC as group, returns their number
+*/
+size_t Lockstep::gather (uint16_t at)
+{
+    size_t count = 0;
+
+    for (auto & c : chunks)
+    {
+        #if defined(__AVX2__)
+
+            const __m256i key = _mm256_set1_epi16(at);
+
+            auto low  = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.pc)), key);
+            auto high = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.pc + 16)), key);
+
+            // Packing interleaves 128-bit halves, so quadwords are put back in lane order
+            auto same = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+            auto mask = _mm256_and_si256(same, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c.live)));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c.group), mask);
+            count += __builtin_popcount(_mm256_movemask_epi8(mask));
+
+        #else
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                c.group[i] = (c.pc[i] == at) ? c.live[i] : 0x00;
+                count += c.group[i] & 1;
+            }
+
+        #endif
+    }
+
+    return count;
+}
+
+
+/*
+    Code bytes of page are the same host memory on every live lane
+
+    Lanes share RAM blocks frozen by fork, so the same host memory
+    holds the same bytes. Page is checked again after group lanes write
+    it and after any lane steps on its own.
+*/
+bool Lockstep::isUniform (uint8_t page)
+{
+    if (checked[page] == epoch)
+        return true;
+
+    const uint8_t * host = nullptr;
+
+    for (size_t lane = 0; lane < lanes; lane++)
+    {
+        if (!chunks[lane / chunk].live[lane % chunk])
+            continue;
+
+        auto read = buses[lane] -> pages[page].read;
+
+        if (!read || (host && read != host))
+            return false;
+
+        host = read;
+    }
+
+    checked[page] = epoch;
+    return true;
+}
+
+
+/*
+    Check page and its mirrors again, memory of group lanes was written
+*/
+void Lockstep::written (uint8_t page)
+{
+    auto mirror = page;
+
+    do {
+        checked[mirror] = 0;
+        mirror = mirrors[mirror];
+    } while (mirror != page);
+}
+
+
+/*
+    Stop lane for reason
+*/
+void Lockstep::stop (size_t lane, Cpu::Stop reason)
+{
+    chunks[lane / chunk].live[lane % chunk] = 0x00;
+    stops[lane] = reason;
+
+    remaining--;
+}
+
+
+/*
+    Step lane on its own and test stop conditions
+    Same as single round of Cpu::run() loop
+*/
+void Lockstep::step (size_t lane)
+{
+    auto & cpu = *cpus[lane];
+    auto at = cpu.pc;
+
+    cpu.clock();
+    load(lane);
+
+    single++;
+    epoch++;
+
+    if (cpu.jammed) {
+        stop(lane, Cpu::Stop::Jam);
+    } else if (cpu.traps && cpu.pc == at) {
+        stop(lane, Cpu::Stop::Trap);
+    } else if (cpu.breaks && cpu.breakpoints[cpu.pc]) {
+        stop(lane, Cpu::Stop::Breakpoint);
+    } else if (cpu.cycles >= chunks[lane / chunk].ends[lane % chunk]) {
+        stop(lane, Cpu::Stop::Budget);
+    }
+}
+
+
+/*
+    Step every group lane on its own
+*/
+void Lockstep::scatter ()
+{
+    each([&] (Chunk &, size_t, size_t lane) {
+        store(lane);
+        step(lane);
+    });
+}
+
+
+/*
+    Run every live lane on its own for slice of cycles
+*/
+void Lockstep::slice ()
+{
+    for (size_t lane = 0; lane < lanes; lane++)
+    {
+        auto & c = chunks[lane / chunk];
+        auto i = lane % chunk;
+
+        if (!c.live[i])
+            continue;
+
+        auto & cpu = *cpus[lane];
+        auto count = c.counters[i];
+
+        store(lane);
+        auto reason = cpu.run(std::min(span, c.ends[i] - c.cycles[i]));
+        load(lane);
+
+        single += c.counters[i] - count;
+
+        if (reason != Cpu::Stop::Budget) {
+            stop(lane, reason);
+        } else if (c.cycles[i] >= c.ends[i]) {
+            stop(lane, Cpu::Stop::Budget);
+        }
+    }
+
+    epoch++;
+}
+
+
+/*
+    Step group lanes on their own if they cannot run command in lanes,
+    code holds command bytes of the first group lane
+*/
+void Lockstep::filter (uint16_t at, const uint8_t * code, const Cmd & cmd)
+{
+    uint16_t last = at + cmd.getBytes() - 1;
+
+    bool uniform = isUniform(at >> 8) && isUniform(last >> 8);
+    bool bcd = decimal && (cmd.mnemonic == Mnemonic::ADC || cmd.mnemonic == Mnemonic::SBC);
+
+    if (uniform && !bcd)
+    {
+        uint8_t any = 0;
+
+        for (auto & c : chunks)
+        {
+            for (size_t i = 0; i < chunk; i++) {
+                any |= c.group[i] & c.solo[i];
+            }
+        }
+
+        // Whole group runs in lanes
+        if (!any)
+            return;
+    }
+
+    each([&] (Chunk & c, size_t i, size_t lane)
+    {
+        bool own = c.solo[i] || (bcd && (c.p[i] & Decimal));
+
+        for (uint8_t index = 0; !uniform && !own && index < cmd.getBytes(); index++) {
+            own = buses[lane] -> read(at + index) != code[index];
+        }
+
+        if (own)
+        {
+            c.group[i] = 0x00;
+
+            store(lane);
+            step(lane);
+        }
+    });
+}
+
+
+/*
+    Call visit with chunk, index and lane of every group lane
+*/
+template <typename Visit>
+void Lockstep::each (Visit visit)
+{
+    for (size_t first = 0; first < lanes; first += chunk)
+    {
+        auto & c = chunks[first / chunk];
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            if (c.group[i])
+                visit(c, i, first + i);
+        }
+    }
+}
+
+
+/*
+    Set effective address of group lanes for addressing mode
+*/
+void Lockstep::resolve (const Cmd & cmd, uint16_t operand)
+{
+    switch (cmd.addressing)
+    {
+        case Mode::ZPG:
+        case Mode::ABS:
+            for (auto & c : chunks) {
+                std::fill(c.address, c.address + chunk, operand);
+            }
+            break;
+
+        case Mode::ZPGX:
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++) {
+                    c.address[i] = uint8_t(operand + c.x[i]);
+                }
+            }
+            break;
+
+        case Mode::ZPGY:
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++) {
+                    c.address[i] = uint8_t(operand + c.y[i]);
+                }
+            }
+            break;
+
+        case Mode::ABSX:
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    c.address[i] = operand + c.x[i];
+                    c.crossed[i] = ((operand ^ c.address[i]) & 0xFF00) ? 1 : 0;
+                }
+            }
+            break;
+
+        case Mode::ABSY:
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    c.address[i] = operand + c.y[i];
+                    c.crossed[i] = ((operand ^ c.address[i]) & 0xFF00) ? 1 : 0;
+                }
+            }
+            break;
+
+        // Pointers are read lane by lane, zeropage pointer wraps without carry
+        case Mode::INDX:
+            each([&] (Chunk & c, size_t i, size_t lane)
+            {
+                auto & bus = *buses[lane];
+                uint8_t zp = operand + c.x[i];
+
+                c.address[i] = bus.read(zp) | (bus.read(uint8_t(zp + 1)) << 8);
+            });
+            break;
+
+        case Mode::INDY:
+            each([&] (Chunk & c, size_t i, size_t lane)
+            {
+                auto & bus = *buses[lane];
+                uint16_t base = bus.read(uint8_t(operand)) | (bus.read(uint8_t(operand + 1)) << 8);
+
+                c.address[i] = base + c.y[i];
+                c.crossed[i] = ((base ^ c.address[i]) & 0xFF00) ? 1 : 0;
+            });
+            break;
+
+        case Mode::IND:
+            each([&] (Chunk & c, size_t i, size_t lane)
+            {
+                auto & bus = *buses[lane];
+                c.address[i] = bus.read(operand) | (bus.read(uint16_t(operand + 1)) << 8);
+            });
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/*
+    Read operand of group lanes, immediate, accumulator or
+    from effective address
+*/
+void Lockstep::fetch (const Cmd & cmd, uint16_t operand)
+{
+    switch (cmd.addressing)
+    {
+        case Mode::IMM:
+            for (auto & c : chunks) {
+                std::fill(c.data, c.data + chunk, uint8_t(operand));
+            }
+            break;
+
+        case Mode::ACC:
+            for (auto & c : chunks) {
+                std::copy(c.a, c.a + chunk, c.data);
+            }
+            break;
+
+        default:
+            each([&] (Chunk & c, size_t i, size_t lane) {
+                c.data[i] = buses[lane] -> read(c.address[i]);
+            });
+            break;
+    }
+}
+
+
+/*
+    Write register of group lanes to effective address
+*/
+template <Lockstep::Lane Value>
+void Lockstep::put ()
+{
+    each([&] (Chunk & c, size_t i, size_t lane)
+    {
+        buses[lane] -> write(c.address[i], (c.*Value)[i]);
+        written(c.address[i] >> 8);
+    });
+}
+
+
+/*
+    Set register of group lanes to value, N and Z from it
+*/
+template <Lockstep::Lane Target, Lockstep::Lane Value>
+void Lockstep::assign ()
+{
+    for (auto & c : chunks)
+    {
+        auto & target = c.*Target;
+        auto & value  = c.*Value;
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            uint8_t result = value[i];
+
+            target[i] = blend(target[i], result, c.group[i]);
+            c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero)) | nz(result), c.group[i]);
+        }
+    }
+}
+
+
+/*
+    Compare operand with register of group lanes
+    Same as Cpu::CMP(), N is set when operand is above register
+*/
+template <Lockstep::Lane Target>
+void Lockstep::compare ()
+{
+    for (auto & c : chunks)
+    {
+        auto & target = c.*Target;
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            uint8_t flags = (c.data[i] >  target[i] ? Negative : 0) |
+                            (c.data[i] == target[i] ? Zero     : 0) |
+                            (c.data[i] <= target[i] ? Carry    : 0);
+
+            c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero | Carry)) | flags, c.group[i]);
+        }
+    }
+}
+
+
+/*
+    Add step to register of group lanes, N and Z from result
+*/
+template <Lockstep::Lane Target>
+void Lockstep::increment (uint8_t step)
+{
+    for (auto & c : chunks)
+    {
+        auto & target = c.*Target;
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            uint8_t result = target[i] + step;
+
+            target[i] = blend(target[i], result, c.group[i]);
+            c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero)) | nz(result), c.group[i]);
+        }
+    }
+}
+
+
+/*
+    Shift or rotate operand of group lanes, result is left in operand
+*/
+void Lockstep::shift (Mnemonic mnemonic)
+{
+    bool left = (mnemonic == Mnemonic::ASL || mnemonic == Mnemonic::ROL);
+    bool rotate = (mnemonic == Mnemonic::ROL || mnemonic == Mnemonic::ROR);
+
+    // Carry enters at bit 0 of 9-bit left shift or at bit 8 of right one
+    uint16_t in = rotate ? (left ? 0x0001 : 0x0100) : 0x0000;
+
+    for (auto & c : chunks)
+    {
+        if (left)
+        {
+            for (size_t i = 0; i < chunk; i++)
+            {
+                uint16_t wide = (c.data[i] << 1) | ((c.p[i] & Carry) ? in : 0);
+                uint8_t result = wide;
+
+                c.data[i] = result;
+                c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero | Carry)) | nz(result) | (wide >> 8), c.group[i]);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < chunk; i++)
+            {
+                uint16_t wide = c.data[i] | ((c.p[i] & Carry) ? in : 0);
+                uint8_t result = wide >> 1;
+
+                c.data[i] = result;
+                c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero | Carry)) | nz(result) | (wide & Carry), c.group[i]);
+            }
+        }
+    }
+}
+
+
+/*
+    Set or clear flag of group lanes
+*/
+void Lockstep::flag (uint8_t mask, bool set)
+{
+    uint8_t value = set ? mask : 0;
+
+    for (auto & c : chunks)
+    {
+        for (size_t i = 0; i < chunk; i++) {
+            c.p[i] = blend(c.p[i], (c.p[i] & ~mask) | value, c.group[i]);
+        }
+    }
+}
+
+
+/*
+    Take branch in group lanes where flag has value
+
+    Group lanes share PC, so target and penalty are the same
+    for every lane taking the branch, see Cpu::BRA()
+*/
+void Lockstep::branch (uint16_t next, int8_t offset, uint8_t mask, bool set)
+{
+    uint16_t target = next + offset;
+    uint8_t  extra  = ((next ^ target) & 0xFF00) ? 2 : 1;
+    uint8_t  expect = set ? mask : 0;
+
+    for (auto & c : chunks)
+    {
+        for (size_t i = 0; i < chunk; i++)
+        {
+            uint8_t taken = c.group[i] & (((c.p[i] & mask) == expect) ? 0xFF : 0x00);
+
+            c.pc[i] = blend16(c.pc[i], target, taken);
+            c.penalty[i] = extra & taken;
+        }
+    }
+}
+
+
+/*
+    Push byte on stack of lane
+*/
+void Lockstep::push (size_t lane, uint8_t value)
+{
+    auto & s = chunks[lane / chunk].s[lane % chunk];
+
+    buses[lane] -> write(0x100 + s, value);
+    s--;
+
+    written(0x01);
+}
+
+
+/*
+    Pull byte from stack of lane
+*/
+uint8_t Lockstep::pull (size_t lane)
+{
+    auto & s = chunks[lane / chunk].s[lane % chunk];
+
+    s++;
+    return buses[lane] -> read(0x100 + s);
+}
+
+
+/*
+    Run command of group in lanes
+    Registers and flags change only in group lanes, see Cpu for semantics
+*/
+void Lockstep::execute (uint16_t at, const uint8_t * code, const Cmd & cmd)
+{
+    uint16_t operand = (cmd.getBytes() > 2) ? code[1] | (code[2] << 8) : code[1];
+    uint16_t next    = at + cmd.getBytes();
+
+    for (auto & c : chunks)
+    {
+        for (size_t i = 0; i < chunk; i++)
+        {
+            c.pc[i] = blend16(c.pc[i], next, c.group[i]);
+            c.crossed[i] = 0;
+            c.penalty[i] = 0;
+        }
+    }
+
+    resolve(cmd, operand);
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::LDA: fetch(cmd, operand); assign<&Chunk::a, &Chunk::data>(); break;
+        case Mnemonic::LDX: fetch(cmd, operand); assign<&Chunk::x, &Chunk::data>(); break;
+        case Mnemonic::LDY: fetch(cmd, operand); assign<&Chunk::y, &Chunk::data>(); break;
+
+        case Mnemonic::STA: put<&Chunk::a>(); break;
+        case Mnemonic::STX: put<&Chunk::x>(); break;
+        case Mnemonic::STY: put<&Chunk::y>(); break;
+
+        case Mnemonic::TAX: assign<&Chunk::x, &Chunk::a>(); break;
+        case Mnemonic::TAY: assign<&Chunk::y, &Chunk::a>(); break;
+        case Mnemonic::TXA: assign<&Chunk::a, &Chunk::x>(); break;
+        case Mnemonic::TYA: assign<&Chunk::a, &Chunk::y>(); break;
+        case Mnemonic::TSX: assign<&Chunk::x, &Chunk::s>(); break;
+
+        case Mnemonic::TXS:
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++) {
+                    c.s[i] = blend(c.s[i], c.x[i], c.group[i]);
+                }
+            }
+            break;
+
+        case Mnemonic::ADC:
+        case Mnemonic::SBC:
+        {
+            // Binary SBC adds complement, decimal lanes were left to their CPU
+            uint8_t invert = (cmd.mnemonic == Mnemonic::SBC) ? 0xFF : 0x00;
+
+            fetch(cmd, operand);
+
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    uint8_t  arg = c.data[i] ^ invert;
+                    uint16_t sum = c.a[i] + arg + (c.p[i] & Carry);
+
+                    uint8_t result = sum;
+                    uint8_t flags  = nz(result) | (sum >> 8) | ((~(c.a[i] ^ arg) & (c.a[i] ^ result) & 0x80) >> 1);
+
+                    c.a[i] = blend(c.a[i], result, c.group[i]);
+                    c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero | Carry | Overflow)) | flags, c.group[i]);
+                }
+            }
+            break;
+        }
+
+        case Mnemonic::AND:
+        case Mnemonic::ORA:
+        case Mnemonic::EOR:
+        {
+            // Logic operations as AND and XOR masks, ORA is A XOR M XOR (A AND M)
+            uint8_t both = (cmd.mnemonic == Mnemonic::EOR) ? 0x00 : 0xFF;
+            uint8_t diff = (cmd.mnemonic == Mnemonic::AND) ? 0x00 : 0xFF;
+
+            fetch(cmd, operand);
+
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    uint8_t common = c.data[i] & c.a[i];
+                    c.data[i] = (common & both) | ((c.data[i] ^ c.a[i]) & diff);
+                }
+            }
+
+            assign<&Chunk::a, &Chunk::data>();
+            break;
+        }
+
+        case Mnemonic::CMP: fetch(cmd, operand); compare<&Chunk::a>(); break;
+        case Mnemonic::CPX: fetch(cmd, operand); compare<&Chunk::x>(); break;
+        case Mnemonic::CPY: fetch(cmd, operand); compare<&Chunk::y>(); break;
+
+        case Mnemonic::BIT:
+            fetch(cmd, operand);
+
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    uint8_t flags = (c.data[i] & (Negative | Overflow)) | ((c.data[i] & c.a[i]) ? 0 : Zero);
+                    c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Overflow | Zero)) | flags, c.group[i]);
+                }
+            }
+            break;
+
+        case Mnemonic::INC:
+        case Mnemonic::DEC:
+        {
+            uint8_t step = (cmd.mnemonic == Mnemonic::INC) ? 0x01 : 0xFF;
+
+            fetch(cmd, operand);
+
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++)
+                {
+                    c.data[i] += step;
+                    c.p[i] = blend(c.p[i], (c.p[i] & ~(Negative | Zero)) | nz(c.data[i]), c.group[i]);
+                }
+            }
+
+            put<&Chunk::data>();
+            break;
+        }
+
+        case Mnemonic::INX: case Mnemonic::DEX:
+        case Mnemonic::INY: case Mnemonic::DEY:
+        {
+            uint8_t step = (cmd.mnemonic == Mnemonic::INX || cmd.mnemonic == Mnemonic::INY) ? 0x01 : 0xFF;
+
+            if (cmd.mnemonic == Mnemonic::INX || cmd.mnemonic == Mnemonic::DEX) {
+                increment<&Chunk::x>(step);
+            } else {
+                increment<&Chunk::y>(step);
+            }
+            break;
+        }
+
+        case Mnemonic::ASL:
+        case Mnemonic::LSR:
+        case Mnemonic::ROL:
+        case Mnemonic::ROR:
+            fetch(cmd, operand);
+            shift(cmd.mnemonic);
+
+            if (cmd.addressing != Mode::ACC)
+            {
+                put<&Chunk::data>();
+                break;
+            }
+
+            for (auto & c : chunks)
+            {
+                for (size_t i = 0; i < chunk; i++) {
+                    c.a[i] = blend(c.a[i], c.data[i], c.group[i]);
+                }
+            }
+            break;
+
+        case Mnemonic::CLC: flag(Carry,    false); break;
+        case Mnemonic::SEC: flag(Carry,    true);  break;
+        case Mnemonic::CLV: flag(Overflow, false); break;
+        case Mnemonic::CLD: flag(Decimal,  false); break;
+        case Mnemonic::SED: flag(Decimal,  true);  break;
+
+        case Mnemonic::BCC: branch(next, code[1], Carry,    false); break;
+        case Mnemonic::BCS: branch(next, code[1], Carry,    true);  break;
+        case Mnemonic::BNE: branch(next, code[1], Zero,     false); break;
+        case Mnemonic::BEQ: branch(next, code[1], Zero,     true);  break;
+        case Mnemonic::BPL: branch(next, code[1], Negative, false); break;
+        case Mnemonic::BMI: branch(next, code[1], Negative, true);  break;
+        case Mnemonic::BVC: branch(next, code[1], Overflow, false); break;
+        case Mnemonic::BVS: branch(next, code[1], Overflow, true);  break;
+
+        case Mnemonic::JMP:
+            for (auto & c : chunks)
+            {
+                if (cmd.addressing != Mode::IND)
+                    std::fill(c.address, c.address + chunk, operand);
+
+                for (size_t i = 0; i < chunk; i++) {
+                    c.pc[i] = blend16(c.pc[i], c.address[i], c.group[i]);
+                }
+            }
+            break;
+
+        // Stack is accessed lane by lane
+        case Mnemonic::JSR:
+            each([&] (Chunk & c, size_t i, size_t lane)
+            {
+                uint16_t back = next - 1;
+
+                push(lane, back >> 8);
+                push(lane, back & 0xFF);
+
+                c.pc[i] = operand;
+            });
+            break;
+
+        case Mnemonic::RTS:
+            each([&] (Chunk & c, size_t i, size_t lane)
+            {
+                uint16_t back = pull(lane);
+                back |= pull(lane) << 8;
+
+                c.pc[i] = back + 1;
+            });
+            break;
+
+        case Mnemonic::PHA:
+            each([&] (Chunk & c, size_t i, size_t lane) {
+                push(lane, c.a[i]);
+            });
+            break;
+
+        case Mnemonic::PLA:
+            each([&] (Chunk & c, size_t i, size_t lane) {
+                c.data[i] = pull(lane);
+            });
+
+            assign<&Chunk::a, &Chunk::data>();
+            break;
+
+        // NOP and commands left to lanes on their own
+        default:
+            break;
+    }
+}
+
+
+/*
+    Advance group lanes and test stop conditions
+    Conditions are tested in the same order as in Cpu::loop()
+*/
+void Lockstep::retire (uint16_t at, const Cmd & cmd)
+{
+    uint8_t base  = cmd.cycles;
+    uint8_t cross = cmd.isCross() ? 1 : 0;
+    uint8_t check = 0x00;
+
+    for (auto & c : chunks)
+    {
+        uint32_t count = 0;
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            uint8_t total = base + (c.crossed[i] & cross) + c.penalty[i];
+
+            c.cycles[i]   += total & c.group[i];
+            c.counters[i] += c.group[i] & 1;
+
+            // Lanes which may stop, breakpoints are looked up only for them
+            uint8_t trapped = c.traps[i] & ((c.pc[i] == at) ? 0xFF : 0x00);
+            uint8_t spent   = (c.cycles[i] >= c.ends[i]) ? 0xFF : 0x00;
+
+            check |= (trapped | c.breaks[i] | spent) & c.group[i];
+            count += c.group[i] & 1;
+        }
+
+        grouped += count;
+    }
+
+    if (!check)
+        return;
+
+    each([&] (Chunk & c, size_t i, size_t lane)
+    {
+        if (c.traps[i] && c.pc[i] == at) {
+            stop(lane, Cpu::Stop::Trap);
+        } else if (c.breaks[i] && cpus[lane] -> breakpoints[c.pc[i]]) {
+            stop(lane, Cpu::Stop::Breakpoint);
+        } else if (c.cycles[i] >= c.ends[i]) {
+            stop(lane, Cpu::Stop::Budget);
+        }
+    });
+}
+
+
+/*
+    Run every lane for cycle budget or until its stop condition
+
+    Every round runs the command at the lowest PC of live lanes, so lanes
+    behind a taken branch wait there for the others to catch up.
+*/
+void Lockstep::run (uint64_t budget)
+{
+    remaining = 0;
+    epoch++;
+
+    for (size_t lane = 0; lane < lanes; lane++)
+    {
+        auto & cpu = *cpus[lane];
+        auto & c = chunks[lane / chunk];
+        auto i = lane % chunk;
+
+        load(lane);
+
+        c.ends[i]   = c.cycles[i] + budget;
+        c.traps[i]  = cpu.traps ? 0xFF : 0x00;
+        c.breaks[i] = cpu.breaks ? 0xFF : 0x00;
+
+        c.live[i] = 0xFF;
+        remaining++;
+
+        // Same as Cpu::run() before its first command
+        if (cpu.jammed) {
+            stop(lane, Cpu::Stop::Jam);
+        } else if (c.cycles[i] >= c.ends[i]) {
+            stop(lane, Cpu::Stop::Budget);
+        }
+    }
+
+    // Narrow rounds in a row
+    uint32_t rounds = 0;
+
+    while (remaining)
+    {
+        auto at    = leader();
+        auto count = gather(at);
+
+        if (count * narrow < lanes)
+        {
+            scatter();
+
+            if (++rounds >= patience)
+            {
+                slice();
+                rounds = 0;
+            }
+
+            continue;
+        }
+
+        rounds = 0;
+
+        // Code is read from the first group lane, filter checks the others
+        size_t first = 0;
+
+        while (!chunks[first / chunk].group[first % chunk])
+            first++;
+
+        auto & bus = *buses[first];
+
+        uint8_t code[3] { bus.read(at), 0x00, 0x00 };
+        auto & cmd = Map::getCommand(code[0]);
+
+        if (!isGrouped(cmd))
+        {
+            scatter();
+            continue;
+        }
+
+        for (uint8_t index = 1; index < cmd.getBytes(); index++) {
+            code[index] = bus.read(at + index);
+        }
+
+        filter(at, code, cmd);
+        execute(at, code, cmd);
+        retire(at, cmd);
+    }
+
+    for (size_t lane = 0; lane < lanes; lane++) {
+        store(lane);
+    }
+}
@@ -0,0 +1,332 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bus/bus.h"
+#include "cpu/cpu.h"
+
+class Cmd;
+
+enum class Mnemonic : uint8_t;
+
+//
+// Lockstep runner
+//
+//      Runs many copies of one program, each lane on its own CPU and
+//      forked bus, and keeps registers of all lanes in chunks of arrays
+//      indexed by lane. Lanes at the lowest PC form the group of a round.
+//      The group fetches and decodes its command once, and register and
+//      flag updates run over whole chunks under the group mask. Memory
+//      is still accessed lane by lane through each lane's bus.
+//
+//      Lanes that branch apart wait at their PC until the lowest group
+//      catches up with them, so they join again behind ifs and loops.
+//      Lanes that cannot run in the group step on their own CPU. Such
+//      lanes have a pending interrupt, traced disassembly, different
+//      code bytes or decimal ADC/SBC on NMOS, and commands without a lane
+//      handler (BRK, RTI, PHP, PLP, CLI, SEI, JAM and undocumented ones)
+//      run the same way. While groups stay narrow, every lane runs a
+//      slice on its own before lanes are grouped again.
+//
+//      Every lane stops exactly as Cpu::run() would on its own. Lanes
+//      are forked from a bare bus, so devices and cartridge are not
+//      mapped on them.
+//
+//      Lane masks are scanned with AVX2 when the build host has it,
+//      chunk loops are vectorized by the compiler to host width.
+//
+
+class Lockstep
+{
+private:
+
+    // Lanes per chunk, byte registers of chunk fill one AVX2 vector
+    static constexpr size_t chunk = 32;
+
+    //
+    // Registers and state of chunk lanes
+    //
+    //      Every field is an array indexed by lane, so loops over chunk
+    //      have a fixed length and run as vector instructions. Lanes past
+    //      the last one are never live and never in group.
+    //
+    //      P is kept in pushed form, see Cpu::save(), and loaded back
+    //      to CPU of lane when it steps on its own.
+    //
+
+    struct Chunk
+    {
+        uint8_t a[chunk] {};
+        uint8_t x[chunk] {};
+        uint8_t y[chunk] {};
+        uint8_t s[chunk] {};
+        uint8_t p[chunk] {};
+
+        uint16_t pc[chunk] {};
+        uint64_t cycles[chunk] {};
+        uint64_t counters[chunk] {};
+
+        // Cycle end of lane
+        uint64_t ends[chunk] {};
+
+        // 0xFF while lane runs, 0x00 once stopped
+        uint8_t live[chunk] {};
+
+        // 0xFF for lanes of running group
+        uint8_t group[chunk] {};
+
+        // 0xFF while lane steps on its own, interrupt is pending or disassembly printed
+        uint8_t solo[chunk] {};
+
+        // Lane stops when command jumps to itself, lane has breakpoints
+        uint8_t traps[chunk] {};
+        uint8_t breaks[chunk] {};
+
+        // Effective address, operand, crossed page and penalty of group command
+        uint16_t address[chunk] {};
+        uint8_t  data[chunk] {};
+        uint8_t  crossed[chunk] {};
+        uint8_t  penalty[chunk] {};
+    };
+
+    // Byte register of chunk, fixed at compile time so lane loops have no aliasing
+    using Lane = uint8_t (Chunk::*)[chunk];
+
+    // Buses and CPUs of lanes
+    std::vector<std::unique_ptr<Bus>> buses;
+    std::vector<std::unique_ptr<Cpu>> cpus;
+
+    // Number of lanes
+    size_t lanes;
+
+    // Lane registers, last chunk is padded
+    std::vector<Chunk> chunks;
+
+    // Stop reason of lane
+    std::vector<Cpu::Stop> stops;
+
+    // Code of page is the same host memory on every live lane since epoch
+    std::array<uint32_t, 256> checked {};
+
+    // Next page on the same RAM block, page itself if it has no mirror
+    std::array<uint8_t, 256> mirrors {};
+
+    // Advanced whenever lane steps on its own and may write anywhere
+    uint32_t epoch = 1;
+
+    // Live lanes
+    size_t remaining = 0;
+
+    // Decimal ADC/SBC of NMOS lanes
+    bool decimal = false;
+
+    // Commands run by groups and by lanes on their own
+    uint64_t grouped = 0;
+    uint64_t single  = 0;
+
+    /*
+        Copy registers of lane from its CPU
+    */
+    void load (size_t lane);
+
+    /*
+        Copy registers of lane to its CPU
+    */
+    void store (size_t lane);
+
+    /*
+        Returns lowest PC of live lanes
+    */
+    uint16_t leader () const;
+
+    /*
+        Mark live lanes at PC as group, returns their number
+    */
+    size_t gather (uint16_t at);
+
+    /*
+        Code bytes of page are the same host memory on every live lane
+    */
+    bool isUniform (uint8_t page);
+
+    /*
+        Check page and its mirrors again, memory of group lanes was written
+    */
+    void written (uint8_t page);
+
+    /*
+        Step group lanes on their own if they cannot run command in lanes,
+        code holds command bytes of the first group lane
+    */
+    void filter (uint16_t at, const uint8_t * code, const Cmd & cmd);
+
+    /*
+        Step every group lane on its own
+    */
+    void scatter ();
+
+    /*
+        Stop lane for reason
+    */
+    void stop (size_t lane, Cpu::Stop reason);
+
+    /*
+        Step lane on its own and test stop conditions
+    */
+    void step (size_t lane);
+
+    /*
+        Run every live lane on its own for slice of cycles
+    */
+    void slice ();
+
+    /*
+        Call visit with chunk, index and lane of every group lane
+    */
+    template <typename Visit>
+    void each (Visit visit);
+
+    /*
+        Set effective address of group lanes for addressing mode
+    */
+    void resolve (const Cmd & cmd, uint16_t operand);
+
+    /*
+        Read operand of group lanes, immediate, accumulator or
+        from effective address
+    */
+    void fetch (const Cmd & cmd, uint16_t operand);
+
+    /*
+        Write register of group lanes to effective address
+    */
+    template <Lane Value>
+    void put ();
+
+    /*
+        Set register of group lanes to value, N and Z from it
+    */
+    template <Lane Target, Lane Value>
+    void assign ();
+
+    /*
+        Compare operand with register of group lanes
+    */
+    template <Lane Target>
+    void compare ();
+
+    /*
+        Add step to register of group lanes, N and Z from result
+    */
+    template <Lane Target>
+    void increment (uint8_t step);
+
+    /*
+        Shift or rotate operand of group lanes, result is left in operand
+    */
+    void shift (Mnemonic mnemonic);
+
+    /*
+        Set or clear flag of group lanes
+    */
+    void flag (uint8_t mask, bool set);
+
+    /*
+        Take branch in group lanes where flag has value
+    */
+    void branch (uint16_t next, int8_t offset, uint8_t mask, bool set);
+
+    /*
+        Push/Pull byte on stack of lane
+    */
+    void push (size_t lane, uint8_t value);
+    uint8_t pull (size_t lane);
+
+    /*
+        Run command of group in lanes
+    */
+    void execute (uint16_t at, const uint8_t * code, const Cmd & cmd);
+
+    /*
+        Advance group lanes and test stop conditions
+    */
+    void retire (uint16_t at, const Cmd & cmd);
+
+public:
+
+    /*
+        Fork lanes from CPU on bare bus
+        Registers, configuration and RAM are copied, RAM on write
+    */
+    Lockstep (const Cpu & cpu, Bus & bus, size_t lanes);
+
+    Lockstep(const Lockstep &) = delete;
+    Lockstep & operator= (const Lockstep &) = delete;
+
+    /*
+        Run every lane for cycle budget or until its stop condition
+    */
+    void run (uint64_t budget);
+
+    /*
+        Returns number of lanes
+    */
+    size_t size () const {
+        return lanes;
+    }
+
+    /*
+        Returns CPU and bus of lane, registers are current between runs
+    */
+    Cpu & getCpu (size_t lane) {
+        return *cpus[lane];
+    }
+
+    Bus & getBus (size_t lane) {
+        return *buses[lane];
+    }
+
+    /*
+        Returns reason lane stopped in last run
+    */
+    Cpu::Stop getStop (size_t lane) const {
+        return stops[lane];
+    }
+
+    /*
+        Returns commands run by groups and by lanes on their own
+    */
+    uint64_t getGrouped () const {
+        return grouped;
+    }
+
+    uint64_t getSingle () const {
+        return single;
+    }
+
+    ~Lockstep();
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "cpu/cpu.h"
 #include "cpu/cmd.h"
+#include "cpu/map.h"
 #include "bus/bus.h"
 
 #include "fmt/core.h"
@@ -38,29 +39,29 @@ static const fmt::text_style light = fg(fmt::color::dark_gray);
 /*
     Default constructor
 */
-Log::Log(std::shared_ptr<Bus> bus) : bus(bus) 
+Log::Log(Bus & bus) : bus(bus) 
 { }
 
 
 /*
     Disassembly operation and print details
 */
-void Log::step (uint32_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu) const
+void Log::step (uint64_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu) const
 {
     fmt::print(dark, "{:06} ", counter);
 
     // Programm counter & Operation code
     fmt::print(dark, "{:#06x} ", pc);
-    fmt::print(dark, "{:#04x} ", bus -> read(pc));
+    fmt::print(dark, "{:#04x} ", bus.read(pc));
 
     // Command name
-    fmt::print(code, "{} ", cmd.name);
+    fmt::print(code, "{} ", Map::getName(bus.read(pc)));
 
     // Command arguments    
     printArgs(pc, cmd.getBytes()); 
 
     // Print memory at argument
-    fmt::print(dark, "${:02X} ", bus -> read(cpu -> op));
+    fmt::print(dark, "${:02X} ", bus.read(cpu -> op));
 
     // Registers
     fmt::print(light, 
@@ -73,9 +74,9 @@ void Log::step (uint32_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu)
 
     // Print memory at argument
     fmt::print(light, "${:02X} ${:02X} ${:02X} ", 
-        bus -> read(0x0100 + cpu -> s - 1),
-        bus -> read(0x0100 + cpu -> s),
-        bus -> read(0x0100 + cpu -> s + 1));
+        bus.read(0x0100 + cpu -> s - 1),
+        bus.read(0x0100 + cpu -> s),
+        bus.read(0x0100 + cpu -> s + 1));
 
     // Status register
     fmt::print(dark, 
@@ -98,7 +99,7 @@ void Log::step (uint32_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu)
 void Log::printArgs(uint16_t pc, uint8_t size) const
 {
     for (int i = 1; i < size; i++) {
-        fmt::print(light, "{:#04x} ", bus -> read(++pc));
+        fmt::print(light, "{:#04x} ", bus.read(++pc));
     }
 
     fmt::print("{:^{}}", "", (3 - size) * 5);   
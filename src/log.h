@@ -19,7 +19,6 @@
 #define LOG_H
 
 #include <cstdint>
-#include <memory>
 #include <string>
 
 class Cpu;
@@ -29,17 +28,17 @@ class Cmd;
 class Log
 {
 private:
-    std::shared_ptr<Bus> bus;
+    Bus & bus;
     
     void printArgs(uint16_t pc, uint8_t size) const;
 
 public:
-    Log(std::shared_ptr<Bus> bus);
+    Log(Bus & bus);
 
     /*
         Disassembly operation
     */
-    void step (uint32_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu) const;
+    void step (uint64_t counter, uint16_t pc, const Cmd & cmd, const Cpu * cpu) const;
 };
 
 #endif
\ No newline at end of file
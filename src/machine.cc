@@ -0,0 +1,236 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "machine.h"
+#include "state.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "fmt/core.h"
+
+
+/*
+    Load ROM, iNES image is inserted as cartridge
+    and raw binary is loaded over whole memory
+*/
+Machine::Machine(const std::string & path) : cpu(bus)
+{
+    if (Cart::isCart(path)) {
+        insert(path);
+    } else {
+        load(path);
+    }
+}
+
+
+Machine::~Machine() = default;
+
+
+/*
+    Load ROM to memory
+*/
+void Machine::load(const std::string & path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error(fmt::format("File not found {}", path));
+
+    // Image is loaded over whole memory from $0000
+    std::vector<uint8_t> image (
+        (std::istreambuf_iterator<char>(file)),
+        (std::istreambuf_iterator<char>())
+    );
+
+    bus.poke(0x0000, image.data(), std::min<size_t>(image.size(), 0x10000));
+
+    // Raw binaries are generic 6502 programs, decimal mode included
+    cpu.setVariant(Cpu::Variant::Nmos6502);
+}
+
+
+/*
+    Insert iNES cartridge
+*/
+void Machine::insert(const std::string & path)
+{
+    cart.emplace(path);
+    wire();
+
+    // Cartridge starts from reset vector, games loop on purpose
+    cpu.reset();
+    cpu.setTraps(false);
+}
+
+
+/*
+    Create mapper of inserted cartridge and wire devices on bus
+*/
+void Machine::wire()
+{
+    mapper = Mapper::create(*cart);
+
+    // 2KB internal RAM mirrored up to $1FFF
+    for (uint8_t page = 0x08; page < 0x20; page += 0x08) {
+        bus.mirror(page, page + 0x07, 0x00);
+    }
+
+    mapper -> attach(bus, cpu);
+
+    samples.emplace();
+
+    io.emplace();
+    ppu.emplace(cpu, bus, *mapper);
+    apu.emplace(cpu, bus, *samples);
+
+    // PPU registers mirrored over $2000 - $3FFF, I/O registers at $4000
+    bus.map(0x20, 0x3F, &*ppu);
+    bus.map(0x40, 0x40, &*io);
+
+    io -> attach(0x4000, 0x4013, &*apu);
+    io -> attach(0x4014, 0x4014, &*ppu);
+    io -> attach(0x4015, 0x4015, &*apu);
+    io -> attach(0x4017, 0x4017, &*apu);
+}
+
+
+/*
+    Fork machine
+
+    Child bus shares RAM copy-on-write and has only RAM pages mapped,
+    so cartridge devices are wired on it again. Mapper, PPU and APU
+    are cloned through their snapshot, mapper remaps PRG banks of
+    parent on load. Cartridge shares ROM image and copies its RAM.
+*/
+Machine::Machine(Machine & parent, std::nullptr_t) : bus(parent.bus, nullptr), cpu(bus)
+{
+    cpu.assign(parent.cpu);
+
+    if (!parent.cart)
+        return;
+
+    cart.emplace(*parent.cart);
+    wire();
+
+    State state;
+    state.begin();
+
+    parent.mapper -> save(state);
+    parent.ppu -> save(state);
+    parent.apu -> save(state);
+
+    state.open();
+
+    mapper -> load(state);
+    ppu -> load(state);
+    apu -> load(state);
+}
+
+
+/*
+    New machine sharing RAM and ROM with this one
+*/
+std::unique_ptr<Machine> Machine::fork()
+{
+    return std::unique_ptr<Machine>(new Machine(*this, nullptr));
+}
+
+
+/*
+    Run up to cycle or next event
+
+    CPU runs freely up to the next PPU or APU event and both catch up
+    afterwards, register accesses synchronize them in between.
+*/
+Cpu::Stop Machine::advance(uint64_t end)
+{
+    if (!cart)
+        return cpu.until(end);
+
+    auto stop = cpu.until(std::min({ end, ppu -> getDeadline(), apu -> getDeadline() }));
+
+    ppu -> sync();
+    apu -> sync();
+
+    return stop;
+}
+
+
+/*
+    Run until cycle or stop condition
+*/
+Cpu::Stop Machine::run(uint64_t end)
+{
+    while (true)
+    {
+        auto stop = advance(end);
+
+        if (stop != Cpu::Stop::Budget || cpu.getCycles() >= end)
+            return stop;
+    }
+}
+
+
+/*
+    Take machine snapshot
+*/
+void Machine::save(State & state) const
+{
+    state.begin();
+
+    cpu.save(state);
+    bus.save(state);
+
+    if (cart)
+    {
+        mapper -> save(state);
+        ppu -> save(state);
+        apu -> save(state);
+    }
+}
+
+
+/*
+    Restore machine snapshot
+*/
+void Machine::load(State & state)
+{
+    state.open();
+
+    cpu.load(state);
+    bus.load(state);
+
+    if (cart)
+    {
+        mapper -> load(state);
+        ppu -> load(state);
+        apu -> load(state);
+    }
+}
+
+
+/*
+    Returns rendered frames
+*/
+uint64_t Machine::getFrames() const
+{
+    return ppu ? ppu -> getFrames() : 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "bus/bus.h"
+#include "bus/io.h"
+#include "cpu/cpu.h"
+#include "ppu/ppu.h"
+#include "apu/apu.h"
+#include "cart/cart.h"
+#include "cart/mapper.h"
+
+class State;
+
+//
+// Emulator instance
+//
+//      Owns every component of one machine, so any number of instances
+//      run side by side without shared state. An iNES image is inserted
+//      as cartridge with PPU, APU and I/O registers wired on the bus,
+//      any other file is raw binary loaded over whole memory and runs
+//      on the bare CPU.
+//
+//      Components are held by value and refer to each other by plain
+//      references, so an instance is one allocation apart from RAM
+//      blocks (shared on fork) and the mapper picked by cartridge.
+//
+
+class Machine
+{
+private:
+
+    Bus bus;
+    Cpu cpu;
+
+    // Inserted cartridge, empty for raw binary
+    std::optional<Cart> cart;
+    std::unique_ptr<Mapper> mapper;
+
+    // Cartridge devices
+    std::optional<Apu::Samples> samples;
+    std::optional<Io> io;
+    std::optional<Ppu> ppu;
+    std::optional<Apu> apu;
+
+    /*
+        Load raw binary over whole memory
+    */
+    void load(const std::string & path);
+
+    /*
+        Insert iNES cartridge and wire devices
+    */
+    void insert(const std::string & path);
+
+    /*
+        Create mapper of inserted cartridge and wire devices on bus
+    */
+    void wire();
+
+    /*
+        Fork parent, devices are cloned and wired on shared RAM
+    */
+    Machine(Machine & parent, std::nullptr_t);
+
+public:
+
+    /*
+        Load ROM, cartridge starts from reset vector
+    */
+    explicit Machine(const std::string & path);
+
+    Machine(const Machine &) = delete;
+    Machine & operator= (const Machine &) = delete;
+
+    ~Machine();
+
+    /*
+        Run CPU up to cycle or next device event and catch devices up
+        Devices are synchronized on return, so machine state is consistent
+    */
+    Cpu::Stop advance(uint64_t end);
+
+    /*
+        Run until cycle or stop condition
+        Audio samples are not drained and are dropped when ring is full
+    */
+    Cpu::Stop run(uint64_t end);
+
+    /*
+        New machine sharing RAM copy-on-write and ROM image with this one
+        Child runs on its own from parent state, CPU configuration included
+    */
+    std::unique_ptr<Machine> fork();
+
+    /*
+        Write/Read snapshot of all components
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    bool isCart() const {
+        return cart.has_value();
+    }
+
+    Cpu & getCpu() {
+        return cpu;
+    }
+
+    Bus & getBus() {
+        return bus;
+    }
+
+    /*
+        Audio samples, null for raw binary
+    */
+    Apu::Samples * getSamples() {
+        return samples ? &*samples : nullptr;
+    }
+
+    /*
+        Rendered frames, 0 for raw binary
+    */
+    uint64_t getFrames() const;
+};
+
+#endif
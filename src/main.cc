@@ -15,14 +15,23 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <memory>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <fstream>
+#include <thread>
 
-#include "log.h"
+#include "state.h"
+#include "rewind.h"
+#include "machine.h"
+
+#include "batch/batch.h"
 
 #include "cpu/cpu.h"
 #include "bus/bus.h"
+#include "apu/apu.h"
+#include "apu/wav.h"
 
 #include "fmt/core.h"
 #include "fmt/format.h"
@@ -35,73 +44,210 @@
 // Caption text style
 static const fmt::text_style caption = fg(fmt::color::dark_gray) | fmt::emphasis::underline;
 
-// Memory bus
-std::shared_ptr<Bus> bus = std::make_shared<Bus>();
+/*
+    Save-state options
+*/
+struct Snapshot
+{
+    // Save at CPU cycle, UINT64_MAX to never save
+    uint64_t at = UINT64_MAX;
+
+    // File written at cycle
+    std::string path;
+
+    // File to resume from, empty to start from reset
+    std::string resume;
+
+    // Rewind history budget in MB, 0 disables rewind
+    uint32_t rewind = 0;
+
+    // Frames to step back before stopping
+    uint32_t back = 0;
+};
+
 
 /*
-    Load ROM to memory
+    Save machine state to file
 */
-void load(std::string path)
+void save_state(const std::string & path, Machine & machine)
 {
-    std::ifstream file(path, std::ios::in | std::ios::binary);
+    State state;
+
+    auto start = std::chrono::steady_clock::now();
+
+    machine.save(state);
 
-    if (!file.is_open())
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    state.save(path);
+
+    fmt::print(caption, "\nState saved to {} at cycle {}, {} bytes in {:.1f}us\n",
+        path, machine.getCpu().getCycles(), state.size(), elapsed.count());
+}
+
+
+/*
+    Resume machine state from file
+*/
+void load_state(const std::string & path, Machine & machine)
+{
+    State state;
+
+    state.load(path);
+    machine.load(state);
+}
+
+
+/*
+    Run machine for cycle budget
+
+    Audio samples are drained to WAV file if given,
+    every frame is captured to rewind history if given.
+*/
+Cpu::Stop play(Machine & machine, Wav * wav, Rewind * rewind, uint64_t cycles, const Snapshot & snapshot)
+{
+    auto & cpu = machine.getCpu();
+    auto samples = machine.getSamples();
+
+    uint64_t end = cpu.getCycles() + cycles;
+    uint64_t at  = snapshot.at;
+
+    int16_t buffer[1024];
+
+    State state;
+    uint64_t captured = machine.getFrames();
+
+    while (true)
     {
-        std::cerr << "File not found " << path;
-        exit(EXIT_FAILURE);
-        
-        return;
-    }
-    
-    #ifdef WIN32
+        auto stop = machine.advance(std::min(end, at));
+
+        // Devices are synchronized, so snapshot is consistent
+        if (cpu.getCycles() >= at)
+        {
+            save_state(snapshot.path, machine);
+            at = UINT64_MAX;
+        }
+
+        if (rewind && machine.getFrames() != captured)
+        {
+            machine.save(state);
+            rewind -> push(state);
 
-        // ~
+            captured = machine.getFrames();
+        }
 
-    #else
-        file.read ( 
-            (std::ifstream::char_type *) bus -> begin(), 
-            (std::streamsize) bus -> size()
-        );
-    #endif
+        while (auto count = samples ? samples -> pop(buffer, sizeof(buffer) / sizeof(buffer[0])) : 0)
+        {
+            if (wav)
+                wav -> write(buffer, count);
+        }
 
-    file.close();
+        if (stop != Cpu::Stop::Budget || cpu.getCycles() >= end)
+            return stop;
+    }
 }
 
 
 /*
-    Load ROM
+    Print commands run fused per idiom by Cache engine
 */
-void load_rom(std::string rom)
+void fusion(const Cpu & cpu)
 {
-    auto path = fmt::format("../ext/asm/bin_files/{}", rom);
-    load(path);
+    static const std::pair<Cpu::Fusion, const char *> idioms[]
+    {
+        { Cpu::Fusion::LdaSta, "LDA STA" },
+        { Cpu::Fusion::CmpBne, "CMP BNE" },
+        { Cpu::Fusion::DexBne, "DEX BNE" },
+        { Cpu::Fusion::DeyBne, "DEY BNE" },
+        { Cpu::Fusion::IncBne, "INC BNE" }
+    };
+
+    uint64_t total = 0;
+
+    for (auto & idiom : idioms)
+        total += cpu.getFused(idiom.first);
+
+    fmt::print(caption, "\nFused {} of {} commands, {:.1f}%\n\n",
+        total, cpu.getCounter(), 100.0 * total / std::max<uint64_t>(cpu.getCounter(), 1));
+
+    for (auto & idiom : idioms)
+        fmt::print("{}  {}\n", idiom.second, cpu.getFused(idiom.first));
 }
 
 
 /*
     Run CPU
 */
-void run(int cycles)
+void run(Machine & machine, uint64_t cycles, uint64_t trace, Cpu::Engine engine, std::string audio, const Snapshot & snapshot)
 {
-    auto log = std::make_shared<Log>(bus);
-    auto cpu = std::make_unique<Cpu>(bus);
+    auto & cpu = machine.getCpu();
+
+    cpu.setEngine(engine);
+    cpu.setTrace(trace);
 
-    fmt::print(caption, "\nDissassembly\n\n");
-        
-    while (cycles--) {
-        cpu -> clock();
+    if (trace != UINT64_MAX)
+        fmt::print(caption, "\nDissassembly\n\n");
+
+    if (!snapshot.resume.empty())
+        load_state(snapshot.resume, machine);
+
+    std::unique_ptr<Wav> wav;
+
+    if (!audio.empty() && machine.isCart())
+        wav = std::make_unique<Wav>(audio, Apu::rate);
+
+    std::unique_ptr<Rewind> rewind;
+
+    if (snapshot.rewind && machine.isCart())
+        rewind = std::make_unique<Rewind>(size_t(snapshot.rewind) << 20);
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto stop = play(machine, wav.get(), rewind.get(), cycles, snapshot);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (machine.isCart())
+    {
+        // Headless, so frame rate is bound by emulation only
+        fmt::print(caption, "\n{} frames rendered in {:.3f}s, {:.1f} frames/s\n",
+            machine.getFrames(), elapsed.count(), machine.getFrames() / elapsed.count());
     }
+
+    if (engine == Cpu::Engine::Cache)
+        fusion(cpu);
+
+    if (rewind)
+    {
+        fmt::print(caption, "\nRewind history of {} frames in {:.1f}MB\n",
+            rewind -> size(), rewind -> getUsed() / double(1 << 20));
+
+        State state;
+        uint32_t count = 0;
+
+        while (count < snapshot.back && rewind -> back(state))
+            count++;
+
+        if (count)
+        {
+            machine.load(state);
+            fmt::print(caption, "\nStepped back {} frames to cycle {}\n", count, cpu.getCycles());
+        }
+    }
+
+    fmt::print(caption, "\nStopped by {} at {:#06x} after {} cycles\n",
+        Cpu::getReason(stop), cpu.getPc(), cpu.getCycles());
 }
 
 
 /*
     Print memory dump
 */
-void dump(uint16_t from, uint16_t to)
+void dump(Bus & bus, uint16_t from, uint16_t to)
 {
     fmt::print(caption, "\n\nMemory dump from {:#04x} to {:#04x}\n", 0x00, 0xFF);
 
-    bus -> printDump(from, to);
+    bus.printDump(from, to);
     fmt::print("\n\n");
 }
 
@@ -112,30 +258,94 @@ int main(int argc, char** argv)
 {
     CLI::App app {"MOS 6502 CPU Emulator"};
 
-    uint32_t c;
+    uint64_t c;
+    uint64_t d;
     uint16_t f;
     uint16_t t; 
 
+    std::string r;
+    std::string w;
+
+    Snapshot s;
+
+    Cpu::Engine e = Cpu::Engine::Table;
+
+    std::map<std::string, Cpu::Engine> engines
+    {
+        { "table",  Cpu::Engine::Table  },
+        { "switch", Cpu::Engine::Switch },
+        { "cache",  Cpu::Engine::Cache  },
+        { "aot",    Cpu::Engine::Aot    },
+
+        #ifdef JIT
+        { "jit",    Cpu::Engine::Jit    }
+        #endif
+    };
+
     app.add_option ("-c", c, "CPU loop cycles")                
         -> default_val(100000000);
 
+    // Tracing keeps CPU in per-command loop, so it is off unless asked for
+    app.add_option ("-d", d, "Print disassembly after command number")
+        -> default_val(UINT64_MAX);
+
     app.add_option ("-f", f, "Print memory dump from address") 
         -> default_val(0x0000);
 
     app.add_option ("-t", t, "Print memory dump to address")   
         -> default_val(0x00FF);
 
+    app.add_option ("-r", r, "ROM file (iNES image or raw binary)")
+        -> default_val("../ext/asm/bin_files/6502_functional_test.bin");
+
+    app.add_option ("-w", w, "Write cartridge audio to WAV file");
+
+    app.add_option ("-s", s.at, "Save state at CPU cycle");
+
+    app.add_option ("-o", s.path, "Save-state file written at cycle")
+        -> default_val("emulator.state");
+
+    app.add_option ("-l", s.resume, "Resume from save-state file");
+
+    app.add_option ("-R", s.rewind, "Rewind history budget in MB, captured every frame of cartridge");
+
+    app.add_option ("-b", s.back, "Step back frames of rewind history before stopping");
+
+    app.add_option ("-e", e, "CPU dispatch engine")
+        -> transform(CLI::CheckedTransformer(engines, CLI::ignore_case));
+
+    // Batch mode, -c is cycle budget of jobs without one
+    auto batch = app.add_subcommand("batch", "Run manifest jobs in parallel, report JSON lines");
+
+    std::string m;
+    unsigned j;
+
+    batch -> add_option ("manifest", m, "Manifest file, ROM path and optional cycle budget per line")
+        -> required();
+
+    batch -> add_option ("-j", j, "Worker threads")
+        -> default_val(std::max(std::thread::hardware_concurrency(), 1u));
+
+    batch -> add_option ("-e", e, "CPU dispatch engine of jobs")
+        -> transform(CLI::CheckedTransformer(engines, CLI::ignore_case));
+
     try
     {
         app.parse(argc, argv);
-        
-        load_rom("6502_functional_test.bin");
+
+        if (*batch)
+        {
+            Batch(m, c, e).run(j);
+            return 0;
+        }
+
+        Machine machine(r);
 
         // Run CPU loop
-        run (c);
+        run (machine, c, d, e, w, s);
  
         // Print memory dump
-        dump (f, t);
+        dump (machine.getBus(), f, t);
     }
     catch(const CLI::ParseError & e) {
         return app.exit(e);
@@ -0,0 +1,703 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ppu.h"
+
+#include <algorithm>
+
+#include "cpu/cpu.h"
+#include "bus/bus.h"
+#include "cart/mapper.h"
+
+#include "renderer.h"
+#include "state.h"
+
+
+Ppu::Ppu(Cpu & cpu, Bus & bus, Mapper & mapper) :
+    cpu    (cpu),
+    bus    (bus),
+    mapper (mapper)
+{ }
+
+
+/*
+    Catch up with CPU cycle counter
+
+    Advances from event to event, so cost depends on the number
+    of scanlines passed rather than the number of dots.
+*/
+void Ppu::sync()
+{
+    uint64_t target = cpu.getCycles() * 3;
+
+    while (clock < target)
+    {
+        uint16_t next = nextEvent();
+        uint64_t step = std::min<uint64_t>(target - clock, next - cycle);
+
+        clock += step;
+        cycle += step;
+
+        if (cycle == next)
+            event();
+    }
+}
+
+
+/*
+    CPU cycle of next vertical blank or mapper IRQ clock
+
+    Mapper IRQ is raised by scanline counter at dot 260, so CPU stops
+    on the clock expiring the counter rather than at vertical blank.
+    With rendering off counter is not clocked until it is enabled,
+    which is checked again on pre-render line.
+*/
+uint64_t Ppu::getDeadline() const
+{
+    uint32_t current = scanline * dots + cycle;
+    uint32_t target  = vblank * dots + 1;
+
+    if (target <= current)
+        target += lines * dots;
+
+    uint32_t distance = target - current;
+
+    if (auto clocks = mapper.getIrqClocks())
+        distance = std::min(distance, getClockDistance(isRendering() ? clocks : 0));
+
+    // Round up, so that CPU reaches event dot
+    return (clock + distance + 2) / 3;
+}
+
+
+/*
+    Dots until clock of mapper scanline counter
+    Counts clocks of rendering lines, 0 is the next clock of pre-render line
+*/
+uint32_t Ppu::getClockDistance(uint16_t clocks) const
+{
+    uint32_t distance = 0;
+
+    uint16_t line = scanline;
+    uint16_t dot  = cycle;
+
+    while (true)
+    {
+        bool fetch = clocks ? (line < height || line == prerender) : line == prerender;
+
+        if (fetch && dot < 260 && (!clocks || --clocks == 0))
+            return distance + 260 - dot;
+
+        distance += dots - dot;
+
+        dot  = 0;
+        line = (line + 1) % lines;
+    }
+}
+
+
+/*
+    Next dot with event on current scanline
+*/
+uint16_t Ppu::nextEvent() const
+{
+    static const uint16_t events[] = { 1, 256, 257, 260, 280 };
+
+    for (auto event : events)
+    {
+        if (event > cycle)
+            return event;
+    }
+
+    // Odd frames skip last dot of pre-render line when rendering
+    if (scanline == prerender && (frames & 1) && isRendering())
+        return dots - 1;
+
+    return dots;
+}
+
+
+/*
+    Process event on current dot
+
+    +---------+-----------+------------------------------------------+
+    | dot     | scanlines | event                                    |
+    +---------+-----------+------------------------------------------+
+    | 1       | 241       | set vertical blank, NMI                  |
+    | 1       | 261       | clear vertical blank, sprite 0, overflow |
+    | 256     | 0 - 239   | render scanline                          |
+    | 256     | 0 - 239,  | increment vertical position of v         |
+    | 257     | 261       | copy horizontal position from t to v     |
+    | 260     |           | clock mapper scanline counter            |
+    | 280     | 261       | copy vertical position from t to v       |
+    | 340/341 | all       | next scanline                            |
+    +---------+-----------+------------------------------------------+
+*/
+void Ppu::event()
+{
+    if (cycle >= dots - 1 && cycle == nextEvent())
+    {
+        cycle = 0;
+        rendered = 0;
+        scanline = (scanline + 1) % lines;
+        return;
+    }
+
+    bool visible = scanline < height;
+    bool fetch   = isRendering() && (visible || scanline == prerender);
+
+    switch (cycle)
+    {
+        case 1:
+            if (scanline == vblank)
+            {
+                status |= 0x80;
+                frames++;
+            }
+
+            if (scanline == prerender)
+                status &= ~0xE0;
+
+            updateNmi();
+            break;
+
+        case 256:
+            if (visible)
+                render(rendered, width);
+
+            if (fetch)
+                incrementY();
+            break;
+
+        case 257:
+            if (fetch)
+                v = (v & ~0x041F) | (t & 0x041F);
+            break;
+
+        case 260:
+            if (fetch)
+                mapper.scanline();
+            break;
+
+        case 280:
+            if (fetch && scanline == prerender)
+                v = (v & ~0x7BE0) | (t & 0x7BE0);
+            break;
+    }
+}
+
+
+/*
+    Drive CPU NMI line, active while vertical blank flag
+    and NMI enable are both set
+*/
+void Ppu::updateNmi()
+{
+    cpu.nmi((status & 0x80) && (ctrl & 0x80));
+}
+
+
+/*
+    Increment fine Y, then coarse Y with nametable wrap
+*/
+void Ppu::incrementY()
+{
+    if ((v & 0x7000) != 0x7000)
+    {
+        v += 0x1000;
+        return;
+    }
+
+    v &= ~0x7000;
+
+    uint16_t y = (v & 0x03E0) >> 5;
+
+    if (y == 29) {
+        y = 0;
+        v ^= 0x0800;
+    } else if (y == 31) {
+        y = 0;
+    } else {
+        y++;
+    }
+
+    v = (v & ~0x03E0) | (y << 5);
+}
+
+
+/*
+    Background palette indices of current scanline
+
+    Tile rows are fetched for 33 tiles, as fine X scroll
+    shifts the line by up to 7 pixels into the next tile.
+*/
+void Ppu::background(Line & back)
+{
+    if (!(mask & 0x08))
+    {
+        back.fill(0x00);
+        return;
+    }
+
+    std::array<uint8_t, 33> lo;
+    std::array<uint8_t, 33> hi;
+    std::array<uint8_t, 33> group;
+
+    std::array<uint8_t, 33 * 8> pixels;
+
+    uint16_t address = v;
+    uint16_t table   = (ctrl & 0x10) ? 0x1000 : 0x0000;
+    uint16_t fine    = (v >> 12) & 0x07;
+
+    for (int tile = 0; tile < 33; tile++)
+    {
+        uint8_t id   = load(0x2000 | (address & 0x0FFF));
+        uint8_t attr = load(0x23C0 | (address & 0x0C00) | ((address >> 4) & 0x38) | ((address >> 2) & 0x07));
+
+        group[tile] = (attr >> (((address >> 4) & 0x04) | (address & 0x02))) & 0x03;
+
+        lo[tile] = mapper.readChr(table + id * 16 + fine);
+        hi[tile] = mapper.readChr(table + id * 16 + fine + 8);
+
+        // Increment coarse X with nametable wrap
+        if ((address & 0x001F) == 31) {
+            address &= ~0x001F;
+            address ^= 0x0400;
+        } else {
+            address++;
+        }
+    }
+
+    Renderer::decode(lo.data(), hi.data(), group.data(), pixels.data(), 33);
+
+    std::copy(pixels.begin() + x, pixels.begin() + x + width, back.begin());
+
+    // Hide background in leftmost 8 pixels
+    if (!(mask & 0x02))
+        std::fill(back.begin(), back.begin() + 8, 0x00);
+}
+
+
+/*
+    Evaluate and decode sprites of current scanline
+
+    Up to eight sprites are taken in OAM order, the ninth sets
+    sprite overflow flag. Lower OAM index wins overlapping pixels.
+*/
+void Ppu::sprites(Line & fore, Line & behind, Line & zero)
+{
+    fore.fill(0x00);
+
+    if (!(mask & 0x10))
+        return;
+
+    uint8_t size  = (ctrl & 0x20) ? 16 : 8;
+    uint8_t count = 0;
+
+    for (int index = 0; index < 64; index++)
+    {
+        auto sprite = &oam[index * 4];
+
+        // Sprite is delayed by one scanline
+        int row = scanline - sprite[0] - 1;
+
+        if (row < 0 || row >= size)
+            continue;
+
+        if (count == 8)
+        {
+            status |= 0x20;
+            break;
+        }
+
+        count++;
+
+        uint8_t tile = sprite[1];
+        uint8_t attr = sprite[2];
+
+        if (attr & 0x80)
+            row = size - 1 - row;
+
+        uint16_t address;
+
+        if (size == 16) {
+            address = ((tile & 0x01) * 0x1000) + (tile & 0xFE) * 16 + ((row & 0x08) << 1) + (row & 0x07);
+        } else {
+            address = ((ctrl & 0x08) ? 0x1000 : 0x0000) + tile * 16 + row;
+        }
+
+        uint8_t lo = mapper.readChr(address);
+        uint8_t hi = mapper.readChr(address + 8);
+
+        if (attr & 0x40)
+        {
+            lo = Renderer::flip(lo);
+            hi = Renderer::flip(hi);
+        }
+
+        // Sprite palettes are groups 4 - 7
+        uint8_t group = 0x04 | (attr & 0x03);
+        uint8_t pixels[8];
+
+        Renderer::decode(&lo, &hi, &group, pixels, 1);
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            int px = sprite[3] + bit;
+
+            if (px >= width)
+                break;
+
+            if (!pixels[bit] || fore[px])
+                continue;
+
+            fore[px]   = pixels[bit];
+            behind[px] = (attr & 0x20) ? 0xFF : 0x00;
+            zero[px]   = (index == 0) ? 0xFF : 0x00;
+        }
+    }
+
+    // Hide sprites in leftmost 8 pixels
+    if (!(mask & 0x04))
+        std::fill(fore.begin(), fore.begin() + 8, 0x00);
+}
+
+
+/*
+    Render pixels from - to of current scanline
+
+    Whole line is prepared with current state and only
+    the requested range is merged into frame.
+*/
+void Ppu::render(uint16_t from, uint16_t to)
+{
+    Line back;
+    Line fore;
+    Line behind {};
+    Line zero {};
+    Line index;
+
+    background(back);
+    sprites(fore, behind, zero);
+
+    // Sprite 0 hit never happens on the last pixel
+    zero[width - 1] = 0x00;
+
+    uint16_t count = to - from;
+
+    if (Renderer::merge(&back[from], &fore[from], &behind[from], &zero[from], &index[from], count))
+        status |= 0x40;
+
+    uint8_t gray = (mask & 0x01) ? 0x30 : 0x3F;
+
+    Renderer::lookup(&index[from], palette.data(), gray, &frame[scanline * width + from], count);
+}
+
+
+/*
+    Render dots passed on current scanline before register change
+
+    Pixel N is output at dot N + 1, so at cycle C pixels
+    up to C - 1 show the state before the change.
+*/
+void Ppu::split()
+{
+    if (scanline >= height || cycle >= width || cycle <= rendered)
+        return;
+
+    render(rendered, cycle);
+    rendered = cycle;
+}
+
+
+/*
+    Read PPU address space
+*/
+uint8_t Ppu::load(uint16_t address) const
+{
+    address &= 0x3FFF;
+
+    if (address < 0x2000)
+        return mapper.readChr(address);
+
+    if (address < 0x3F00)
+        return vram[mirror(address)];
+
+    // $3F10/$3F14/$3F18/$3F1C mirror backdrop entries
+    address &= 0x1F;
+
+    if ((address & 0x13) == 0x10)
+        address &= ~0x10;
+
+    return palette[address];
+}
+
+
+/*
+    Write PPU address space
+*/
+void Ppu::store(uint16_t address, uint8_t data)
+{
+    address &= 0x3FFF;
+
+    if (address < 0x2000)
+    {
+        mapper.writeChr(address, data);
+    }
+    else if (address < 0x3F00)
+    {
+        vram[mirror(address)] = data;
+    }
+    else
+    {
+        address &= 0x1F;
+
+        if ((address & 0x13) == 0x10)
+            address &= ~0x10;
+
+        palette[address] = data;
+    }
+}
+
+
+/*
+    Nametable address with cartridge mirroring
+*/
+uint16_t Ppu::mirror(uint16_t address) const
+{
+    uint16_t table = (address >> 10) & 0x03;
+
+    switch (mapper.getMirroring())
+    {
+        case Mirroring::Horizontal: table >>= 1;   break;
+        case Mirroring::Vertical:   table &= 0x01; break;
+        case Mirroring::SingleLow:  table = 0;     break;
+        case Mirroring::SingleHigh: table = 1;     break;
+        case Mirroring::FourScreen:                break;
+    }
+
+    return (table << 10) | (address & 0x03FF);
+}
+
+
+/*
+    Read register
+
+    +-------+-----------+------------------------------------------+
+    | $2002 | PPUSTATUS | vblank, sprite 0 hit, overflow           |
+    | $2004 | OAMDATA   | OAM byte at OAMADDR                      |
+    | $2007 | PPUDATA   | buffered VRAM read, palette is immediate |
+    +-------+-----------+------------------------------------------+
+*/
+uint8_t Ppu::read(uint16_t index)
+{
+    if (index == 0x4014)
+        return 0x00;
+
+    sync();
+
+    uint8_t data = latch;
+
+    switch (index & 0x07)
+    {
+        case 2:
+            // Sprite 0 hit is polled, so it has to be exact to the dot
+            if (!(status & 0x40))
+                split();
+
+            data = (status & 0xE0) | (latch & 0x1F);
+
+            status &= ~0x80;
+            w = false;
+
+            updateNmi();
+            break;
+
+        case 4:
+            data = oam[oamAddress];
+            break;
+
+        case 7:
+            if ((v & 0x3FFF) < 0x3F00)
+            {
+                data   = buffer;
+                buffer = load(v);
+            }
+            else
+            {
+                data   = load(v);
+                buffer = load(v - 0x1000);
+            }
+
+            v = (v + ((ctrl & 0x04) ? 32 : 1)) & 0x7FFF;
+            break;
+    }
+
+    return data;
+}
+
+
+/*
+    Write register
+
+    +-------+-----------+------------------------------------------+
+    | $2000 | PPUCTRL   | nametable, increment, tables, size, NMI  |
+    | $2001 | PPUMASK   | grayscale, clipping, rendering enable    |
+    | $2003 | OAMADDR   | OAM address                              |
+    | $2004 | OAMDATA   | OAM byte at OAMADDR, increments OAMADDR  |
+    | $2005 | PPUSCROLL | X then Y scroll                          |
+    | $2006 | PPUADDR   | VRAM address high then low byte          |
+    | $2007 | PPUDATA   | VRAM write                               |
+    | $4014 | OAMDMA    | copy CPU page to OAM                     |
+    +-------+-----------+------------------------------------------+
+*/
+void Ppu::write(uint16_t index, uint8_t data)
+{
+    if (index == 0x4014)
+    {
+        dma(data);
+        return;
+    }
+
+    sync();
+
+    // OAM changes are not visible before next scanline
+    if ((index & 0x07) != 3 && (index & 0x07) != 4)
+        split();
+
+    latch = data;
+
+    switch (index & 0x07)
+    {
+        case 0:
+            ctrl = data;
+            t = (t & ~0x0C00) | ((data & 0x03) << 10);
+
+            // Enabling NMI during vertical blank raises it immediately
+            updateNmi();
+            break;
+
+        case 1:
+            mask = data;
+            break;
+
+        case 3:
+            oamAddress = data;
+            break;
+
+        case 4:
+            oam[oamAddress++] = data;
+            break;
+
+        case 5:
+            if (!w) {
+                t = (t & ~0x001F) | (data >> 3);
+                x = data & 0x07;
+            } else {
+                t = (t & ~0x73E0) | ((data & 0x07) << 12) | ((data & 0xF8) << 2);
+            }
+
+            w = !w;
+            break;
+
+        case 6:
+            if (!w) {
+                t = (t & 0x00FF) | ((data & 0x3F) << 8);
+            } else {
+                t = (t & 0xFF00) | data;
+                v = t;
+            }
+
+            w = !w;
+            break;
+
+        case 7:
+            store(v, data);
+            v = (v + ((ctrl & 0x04) ? 32 : 1)) & 0x7FFF;
+            break;
+    }
+}
+
+
+/*
+    OAM DMA from CPU page
+    CPU is halted for 513 cycles, one more on odd cycle
+*/
+void Ppu::dma(uint8_t page)
+{
+    for (uint16_t index = 0; index < 256; index++) {
+        oam[(oamAddress + index) & 0xFF] = bus.read((page << 8) | index);
+    }
+
+    cpu.stall(513 + (cpu.getCycles() & 1));
+}
+
+
+/*
+    Write registers, memory and timing
+*/
+void Ppu::save(State & state) const
+{
+    state.mark("PPU ");
+
+    state.put(ctrl);
+    state.put(mask);
+    state.put(status);
+    state.put(oamAddress);
+    state.put(latch);
+    state.put(buffer);
+    state.put(v);
+    state.put(t);
+    state.put(x);
+    state.put(w);
+    state.put(vram);
+    state.put(palette);
+    state.put(oam);
+    state.put(clock);
+    state.put(scanline);
+    state.put(cycle);
+    state.put(rendered);
+    state.put(frames);
+}
+
+
+/*
+    Read registers, memory and timing
+*/
+void Ppu::load(State & state)
+{
+    state.check("PPU ");
+
+    state.get(ctrl);
+    state.get(mask);
+    state.get(status);
+    state.get(oamAddress);
+    state.get(latch);
+    state.get(buffer);
+    state.get(v);
+    state.get(t);
+    state.get(x, uint8_t(7));
+    state.get(w);
+    state.get(vram);
+    state.get(palette);
+    state.get(oam);
+    state.get(clock);
+    state.get(scanline, uint16_t(lines - 1));
+    state.get(cycle, uint16_t(dots - 1));
+    state.get(rendered, uint16_t(256));
+    state.get(frames);
+}
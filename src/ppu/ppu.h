@@ -0,0 +1,239 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPU_H
+#define PPU_H
+
+#include <array>
+#include <cstdint>
+
+#include "bus/device.h"
+
+class Cpu;
+class Bus;
+class Mapper;
+class State;
+
+//
+// Ricoh 2C02 Picture Processing Unit
+//
+//      PPU runs three dots per CPU cycle, 341 dots per scanline and
+//      262 scanlines per frame. It is emulated in catch-up fashion:
+//      state is advanced to the CPU cycle counter only when CPU touches
+//      PPU registers or when the next frame event (vertical blank) is due,
+//      so CPU and PPU never run in per-cycle lockstep.
+//
+//      Between events PPU advances scanline by scanline, visible lines
+//      are rendered whole at dot 256 by the vectorized Renderer pipeline.
+//      A register write in the middle of a visible line first renders
+//      the dots already passed with the old state, so raster effects
+//      split the line into dot-exact segments.
+//
+
+class Ppu : public Device
+{
+public:
+
+    static const uint16_t width  = 256;
+    static const uint16_t height = 240;
+
+    using Frame = std::array<uint8_t, width * height>;
+
+private:
+
+    static const uint16_t dots  = 341;
+    static const uint16_t lines = 262;
+
+    // Scanline where vertical blank starts
+    static const uint16_t vblank = 241;
+
+    // Pre-render scanline
+    static const uint16_t prerender = 261;
+
+    Cpu & cpu;
+    Bus & bus;
+    Mapper & mapper;
+
+    //
+    // Registers
+    //
+
+    uint8_t ctrl   = 0x00; // $2000 PPUCTRL
+    uint8_t mask   = 0x00; // $2001 PPUMASK
+    uint8_t status = 0x00; // $2002 PPUSTATUS
+    uint8_t oamAddress = 0x00; // $2003 OAMADDR
+
+    // Last value written to any register (open bus)
+    uint8_t latch = 0x00;
+
+    // PPUDATA read buffer
+    uint8_t buffer = 0x00;
+
+    //
+    // Loopy scroll registers
+    //
+    //      v   Current VRAM address  (yyy NN YYYYY XXXXX)
+    //      t   Temporary VRAM address
+    //      x   Fine X scroll
+    //      w   First or second write toggle
+    //
+
+    uint16_t v = 0x0000;
+    uint16_t t = 0x0000;
+    uint8_t  x = 0x00;
+    bool     w = false;
+
+    //
+    // Memory
+    //
+
+    // Nametables, 4KB to support four-screen cartridges
+    std::array<uint8_t, 4096> vram {};
+
+    // Palette RAM
+    std::array<uint8_t, 32> palette {};
+
+    // Object attribute memory
+    std::array<uint8_t, 256> oam {};
+
+    // Rendered frame, palette index per pixel
+    Frame frame {};
+
+    //
+    // Timing
+    //
+
+    // Elapsed PPU dots
+    uint64_t clock = 0;
+
+    uint16_t scanline = 0;
+    uint16_t cycle = 0;
+
+    // Pixels of current scanline already rendered
+    uint16_t rendered = 0;
+
+    // Completed frames
+    uint64_t frames = 0;
+
+    /*
+        Process event on current dot
+    */
+    void event();
+
+    /*
+        Next dot with event on current scanline
+    */
+    uint16_t nextEvent() const;
+
+    /*
+        Dots until clock of mapper scanline counter
+    */
+    uint32_t getClockDistance(uint16_t clocks) const;
+
+    /*
+        Rendering (background or sprites) is enabled
+    */
+    bool isRendering() const {
+        return mask & 0x18;
+    }
+
+    /*
+        Drive CPU NMI line from vertical blank and NMI enable
+    */
+    void updateNmi();
+
+    /*
+        Increment coarse X and fine Y of v
+    */
+    void incrementY();
+
+    using Line = std::array<uint8_t, width>;
+
+    /*
+        Background palette indices of current scanline
+    */
+    void background(Line & back);
+
+    /*
+        Evaluate and decode sprites of current scanline
+    */
+    void sprites(Line & fore, Line & behind, Line & zero);
+
+    /*
+        Render pixels from - to of current scanline
+    */
+    void render(uint16_t from, uint16_t to);
+
+    /*
+        Render dots passed on current scanline before register change
+    */
+    void split();
+
+    /*
+        Read/Write PPU address space
+    */
+    uint8_t load(uint16_t address) const;
+    void store(uint16_t address, uint8_t data);
+
+    /*
+        Nametable address with cartridge mirroring
+    */
+    uint16_t mirror(uint16_t address) const;
+
+    /*
+        OAM DMA from CPU page
+    */
+    void dma(uint8_t page);
+
+public:
+
+    Ppu(Cpu & cpu, Bus & bus, Mapper & mapper);
+
+    /*
+        Catch up with CPU cycle counter
+    */
+    void sync();
+
+    /*
+        CPU cycle of next vertical blank or mapper IRQ clock
+        CPU must not run past it without calling sync()
+    */
+    uint64_t getDeadline() const;
+
+    /*
+        Register access $2000 - $3FFF and OAM DMA $4014
+    */
+    uint8_t read(uint16_t index) override;
+    void write(uint16_t index, uint8_t data) override;
+
+    /*
+        Write/Read registers, memory and timing
+        Frame is not kept, it is complete again after next frame
+    */
+    void save(State & state) const;
+    void load(State & state);
+
+    const Frame & getFrame() const {
+        return frame;
+    }
+
+    uint64_t getFrames() const {
+        return frames;
+    }
+};
+
+#endif
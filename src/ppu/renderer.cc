@@ -0,0 +1,220 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renderer.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #define RENDERER_SSE2
+    #include <emmintrin.h>
+#endif
+
+// Byte broadcast multiplier
+static const uint64_t spread = 0x0101010101010101;
+
+
+/*
+    Decode tile rows, 8 pixels per tile
+
+    Plane byte is broadcast over 8 lanes and tested against
+    a per-lane bit mask, so one compare yields one pixel per lane.
+*/
+void Renderer::decode(const uint8_t * lo, const uint8_t * hi, const uint8_t * group, uint8_t * out, size_t tiles)
+{
+    size_t tile = 0;
+
+    #if defined(__AVX2__)
+
+        const __m256i bits = _mm256_set1_epi64x(0x0102040810204080);
+        const __m256i one  = _mm256_set1_epi8(1);
+        const __m256i two  = _mm256_set1_epi8(2);
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (; tile + 4 <= tiles; tile += 4)
+        {
+            auto l = _mm256_set_epi64x(lo[tile + 3] * spread, lo[tile + 2] * spread, lo[tile + 1] * spread, lo[tile] * spread);
+            auto h = _mm256_set_epi64x(hi[tile + 3] * spread, hi[tile + 2] * spread, hi[tile + 1] * spread, hi[tile] * spread);
+
+            auto g = _mm256_set_epi64x(
+                (group[tile + 3] << 2) * spread, (group[tile + 2] << 2) * spread,
+                (group[tile + 1] << 2) * spread, (group[tile + 0] << 2) * spread);
+
+            auto value = _mm256_or_si256(
+                _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(l, bits), bits), one),
+                _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(h, bits), bits), two));
+
+            // Group applies to opaque pixels only
+            value = _mm256_or_si256(value, _mm256_andnot_si256(_mm256_cmpeq_epi8(value, zero), g));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + tile * 8), value);
+        }
+
+    #elif defined(RENDERER_SSE2)
+
+        const __m128i bits = _mm_set1_epi64x(0x0102040810204080);
+        const __m128i one  = _mm_set1_epi8(1);
+        const __m128i two  = _mm_set1_epi8(2);
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; tile + 2 <= tiles; tile += 2)
+        {
+            auto l = _mm_set_epi64x(lo[tile + 1] * spread, lo[tile] * spread);
+            auto h = _mm_set_epi64x(hi[tile + 1] * spread, hi[tile] * spread);
+            auto g = _mm_set_epi64x((group[tile + 1] << 2) * spread, (group[tile] << 2) * spread);
+
+            auto value = _mm_or_si128(
+                _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(l, bits), bits), one),
+                _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(h, bits), bits), two));
+
+            // Group applies to opaque pixels only
+            value = _mm_or_si128(value, _mm_andnot_si128(_mm_cmpeq_epi8(value, zero), g));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + tile * 8), value);
+        }
+
+    #endif
+
+    for (; tile < tiles; tile++)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            uint8_t value = ((lo[tile] >> (7 - bit)) & 0x01) | (((hi[tile] >> (7 - bit)) & 0x01) << 1);
+            out[tile * 8 + bit] = value ? (group[tile] << 2) | value : 0x00;
+        }
+    }
+}
+
+
+/*
+    Merge background and sprite palette indices
+
+    Sprite pixel is taken when it is opaque and either background
+    is transparent or sprite is in front of background.
+*/
+bool Renderer::merge(const uint8_t * back, const uint8_t * fore, const uint8_t * behind, const uint8_t * zero, uint8_t * out, size_t count)
+{
+    size_t index = 0;
+    bool hit = false;
+
+    #if defined(__AVX2__)
+
+        const __m256i clear = _mm256_setzero_si256();
+        __m256i hits = clear;
+
+        for (; index + 32 <= count; index += 32)
+        {
+            auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(back + index));
+            auto f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fore + index));
+            auto p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(behind + index));
+            auto z = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(zero + index));
+
+            auto transparent = _mm256_cmpeq_epi8(b, clear);
+            auto hidden = _mm256_cmpeq_epi8(f, clear);
+
+            // ~hidden & (transparent | ~behind)
+            auto front = _mm256_andnot_si256(hidden, _mm256_or_si256(transparent, _mm256_cmpeq_epi8(p, clear)));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + index), _mm256_blendv_epi8(b, f, front));
+
+            hits = _mm256_or_si256(hits, _mm256_andnot_si256(_mm256_or_si256(transparent, hidden), z));
+        }
+
+        hit = _mm256_movemask_epi8(hits) != 0;
+
+    #elif defined(RENDERER_SSE2)
+
+        const __m128i clear = _mm_setzero_si128();
+        __m128i hits = clear;
+
+        for (; index + 16 <= count; index += 16)
+        {
+            auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(back + index));
+            auto f = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fore + index));
+            auto p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(behind + index));
+            auto z = _mm_loadu_si128(reinterpret_cast<const __m128i *>(zero + index));
+
+            auto transparent = _mm_cmpeq_epi8(b, clear);
+            auto hidden = _mm_cmpeq_epi8(f, clear);
+
+            // ~hidden & (transparent | ~behind)
+            auto front = _mm_andnot_si128(hidden, _mm_or_si128(transparent, _mm_cmpeq_epi8(p, clear)));
+
+            // SSE2 has no byte blend
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + index),
+                _mm_or_si128(_mm_and_si128(front, f), _mm_andnot_si128(front, b)));
+
+            hits = _mm_or_si128(hits, _mm_andnot_si128(_mm_or_si128(transparent, hidden), z));
+        }
+
+        hit = _mm_movemask_epi8(hits) != 0;
+
+    #endif
+
+    for (; index < count; index++)
+    {
+        uint8_t b = back[index];
+        uint8_t f = fore[index];
+
+        if (zero[index] && b && f)
+            hit = true;
+
+        out[index] = f && (!b || !behind[index]) ? f : b;
+    }
+
+    return hit;
+}
+
+
+/*
+    Replace palette indices by palette values
+
+    With AVX2 both palette halves are looked up by byte shuffle
+    and the half is selected by bit 4 of the index.
+*/
+void Renderer::lookup(const uint8_t * index, const uint8_t * palette, uint8_t gray, uint8_t * out, size_t count)
+{
+    size_t px = 0;
+
+    #if defined(__AVX2__)
+
+        const __m256i low  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(palette)));
+        const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(palette + 16)));
+
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i half   = _mm256_set1_epi8(0x10);
+        const __m256i mask   = _mm256_set1_epi8(gray);
+
+        for (; px + 32 <= count; px += 32)
+        {
+            auto i = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + px));
+            auto n = _mm256_and_si256(i, nibble);
+
+            auto value = _mm256_blendv_epi8(
+                _mm256_shuffle_epi8(low,  n),
+                _mm256_shuffle_epi8(high, n),
+                _mm256_cmpeq_epi8(_mm256_and_si256(i, half), half));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + px), _mm256_and_si256(value, mask));
+        }
+
+    #endif
+
+    for (; px < count; px++) {
+        out[px] = palette[index[px] & 0x1F] & gray;
+    }
+}
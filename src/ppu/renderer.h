@@ -0,0 +1,79 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Scanline pixel pipeline
+//
+//      Works on whole rows of pixels rather than on single dots:
+//
+//          decode  2bpp CHR tile rows to palette indices
+//          merge   background and sprite pixels by transparency and priority
+//          lookup  palette indices to palette values
+//
+//      Each stage is vectorized with AVX2 or SSE2 when the compiler targets
+//      them (see NATIVE option) and has a scalar fallback for other targets.
+//      Stages have no PPU state, so they can be used on any row range.
+//
+
+class Renderer
+{
+public:
+
+    /*
+        Decode tile rows, 8 pixels per tile
+
+            lo, hi  Bit planes, leftmost pixel in bit 7
+            group   Palette group (0 - 7) of each tile
+            out     Palette index (group << 2 | pixel), 0 if pixel is transparent
+    */
+    static void decode(const uint8_t * lo, const uint8_t * hi, const uint8_t * group, uint8_t * out, size_t tiles);
+
+    /*
+        Merge background and sprite palette indices
+
+            behind  0xFF where sprite is behind background, else 0x00
+            zero    0xFF where pixel belongs to sprite 0, else 0x00
+
+        Returns true on sprite 0 hit (opaque sprite 0 over opaque background)
+    */
+    static bool merge(const uint8_t * back, const uint8_t * fore, const uint8_t * behind, const uint8_t * zero, uint8_t * out, size_t count);
+
+    /*
+        Replace palette indices by palette values masked by grayscale mask
+    */
+    static void lookup(const uint8_t * index, const uint8_t * palette, uint8_t gray, uint8_t * out, size_t count);
+
+    /*
+        Reverse bits of tile row for horizontally flipped sprites
+    */
+    static constexpr uint8_t flip(uint8_t row)
+    {
+        row = ((row & 0xF0) >> 4) | ((row & 0x0F) << 4);
+        row = ((row & 0xCC) >> 2) | ((row & 0x33) << 2);
+        row = ((row & 0xAA) >> 1) | ((row & 0x55) << 1);
+
+        return row;
+    }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rewind.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "state.h"
+
+
+/*
+    Write variable length integer, 7 bits per byte
+*/
+static void putVarint(std::vector<uint8_t> & out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(uint8_t(value));
+}
+
+
+/*
+    Read variable length integer
+*/
+static size_t getVarint(const uint8_t * & from, const uint8_t * end)
+{
+    size_t value = 0;
+
+    for (int shift = 0; from < end; shift += 7)
+    {
+        uint8_t byte = *from++;
+        value |= size_t(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80))
+            return value;
+    }
+
+    throw std::runtime_error("Rewind delta is truncated");
+}
+
+
+/*
+    Length of equal run, compared by blocks first
+*/
+static size_t equalRun(const uint8_t * a, const uint8_t * b, size_t size)
+{
+    size_t index = 0;
+
+    while (index + 256 <= size && std::memcmp(a + index, b + index, 256) == 0)
+        index += 256;
+
+    for (; index + 8 <= size; index += 8)
+    {
+        uint64_t x, y;
+
+        std::memcpy(&x, a + index, 8);
+        std::memcpy(&y, b + index, 8);
+
+        if (x != y)
+            break;
+    }
+
+    while (index < size && a[index] == b[index])
+        index++;
+
+    return index;
+}
+
+
+Rewind::Rewind(size_t budget) :
+    budget (budget)
+{ }
+
+
+/*
+    Encode XOR of snapshots of equal size
+*/
+void Rewind::encode(const uint8_t * next, const uint8_t * prev, size_t size, std::vector<uint8_t> & out)
+{
+    out.clear();
+
+    size_t index = 0;
+
+    while (index < size)
+    {
+        size_t equal = equalRun(next + index, prev + index, size - index);
+        index += equal;
+
+        // Changed run ends at first equal byte
+        size_t start = index;
+
+        while (index < size && next[index] != prev[index])
+            index++;
+
+        putVarint(out, equal);
+        putVarint(out, index - start);
+
+        for (size_t byte = start; byte < index; byte++) {
+            out.push_back(next[byte] ^ prev[byte]);
+        }
+    }
+}
+
+
+/*
+    Apply encoded XOR to snapshot in place
+*/
+void Rewind::decode(const std::vector<uint8_t> & delta, uint8_t * data, size_t size)
+{
+    const uint8_t * from = delta.data();
+    const uint8_t * end  = from + delta.size();
+
+    size_t index = 0;
+
+    while (from < end)
+    {
+        index += getVarint(from, end);
+
+        size_t count = getVarint(from, end);
+
+        if (index + count > size || count > size_t(end - from))
+            throw std::runtime_error("Rewind delta is corrupted");
+
+        for (size_t byte = 0; byte < count; byte++) {
+            data[index++] ^= *from++;
+        }
+    }
+}
+
+
+/*
+    Capture snapshot
+
+    Delta from new snapshot back to previous one is stored,
+    history restarts if snapshot size changes (other machine)
+*/
+void Rewind::push(const State & state)
+{
+    auto data = state.getData();
+    auto size = state.size();
+
+    if (current.size() != size)
+    {
+        deltas.clear();
+        used = 0;
+    }
+    else
+    {
+        encode(data, current.data(), size, scratch);
+
+        deltas.emplace_back(scratch.begin(), scratch.end());
+        used += scratch.size();
+
+        while (used > budget && !deltas.empty())
+        {
+            used -= deltas.front().size();
+            deltas.pop_front();
+        }
+    }
+
+    current.assign(data, data + size);
+}
+
+
+/*
+    Step back to previous capture
+*/
+bool Rewind::back(State & state)
+{
+    if (deltas.empty())
+        return false;
+
+    decode(deltas.back(), current.data(), current.size());
+
+    used -= deltas.back().size();
+    deltas.pop_back();
+
+    state.assign(current.data(), current.size());
+    return true;
+}
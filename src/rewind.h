@@ -0,0 +1,106 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class State;
+
+//
+// Rewind history
+//
+//      Keeps the latest snapshot in full and every older one as backward
+//      delta: XOR against its successor, compressed by zero-run encoding.
+//      Frame to frame most of the machine does not change, so a delta is
+//      mostly one long zero run. Stepping back XORs the newest delta into
+//      the latest snapshot; the oldest deltas are dropped when history
+//      exceeds its memory budget, as nothing depends on them.
+//
+//      Delta encoding is a sequence of tokens
+//
+//          varint  unchanged bytes
+//          varint  changed bytes (N)
+//          N bytes XOR of changed bytes
+//
+
+class Rewind
+{
+private:
+
+    // Memory budget of deltas in bytes
+    size_t budget;
+
+    // Memory used by deltas
+    size_t used = 0;
+
+    // Backward deltas, newest last
+    std::deque<std::vector<uint8_t>> deltas;
+
+    // Latest snapshot
+    std::vector<uint8_t> current;
+
+    // Encoding buffer, keeps capacity
+    std::vector<uint8_t> scratch;
+
+    /*
+        Encode XOR of snapshots of equal size
+    */
+    static void encode(const uint8_t * next, const uint8_t * prev, size_t size, std::vector<uint8_t> & out);
+
+    /*
+        Apply encoded XOR to snapshot in place
+    */
+    static void decode(const std::vector<uint8_t> & delta, uint8_t * data, size_t size);
+
+public:
+
+    /*
+        History limited to budget bytes
+    */
+    Rewind(size_t budget);
+
+    /*
+        Capture snapshot
+    */
+    void push(const State & state);
+
+    /*
+        Step back to previous capture, returns false if history is empty
+    */
+    bool back(State & state);
+
+    /*
+        Captures available to step back
+    */
+    size_t size() const {
+        return deltas.size();
+    }
+
+    /*
+        Memory used by history, bytes
+    */
+    size_t getUsed() const {
+        return used + current.size();
+    }
+};
+
+#endif
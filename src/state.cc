@@ -0,0 +1,142 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "state.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+// File magic
+static const char magic[4] = { 'N', 'E', 'S', 'S' };
+
+
+/*
+    Start new snapshot with header
+*/
+void State::begin()
+{
+    data.clear();
+    position = 0;
+
+    put(magic, sizeof(magic));
+    put(version);
+}
+
+
+/*
+    Verify header and read from first section
+*/
+void State::open()
+{
+    position = 0;
+
+    char head[4];
+    uint16_t number;
+
+    get(head, sizeof(head));
+
+    if (std::memcmp(head, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("Not a save-state");
+
+    get(number);
+
+    if (number != version)
+        throw std::runtime_error(fmt::format("Unsupported save-state version {}, expected {}", number, version));
+}
+
+
+/*
+    Write section tag
+*/
+void State::mark(const char * tag)
+{
+    put(tag, 4);
+}
+
+
+/*
+    Verify section tag, snapshot of another machine
+    configuration (e.g. raw binary vs cartridge) is rejected
+*/
+void State::check(const char * tag)
+{
+    char found[4];
+    get(found, sizeof(found));
+
+    if (std::memcmp(found, tag, sizeof(found)) != 0)
+        throw std::runtime_error(fmt::format("Save-state section {} expected, found {}", std::string(tag, 4), std::string(found, 4)));
+}
+
+
+/*
+    Read raw bytes
+*/
+void State::get(void * bytes, size_t size)
+{
+    if (position + size > data.size())
+        throw std::runtime_error("Save-state is truncated");
+
+    std::memcpy(bytes, data.data() + position, size);
+    position += size;
+}
+
+
+/*
+    Read bool
+*/
+void State::get(bool & value)
+{
+    uint8_t read;
+    get(read);
+
+    if (read > 1)
+        throw std::runtime_error("Save-state value out of range");
+
+    value = read;
+}
+
+
+/*
+    Write snapshot file
+*/
+void State::save(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error(fmt::format("Unable to create {}", path));
+
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+
+/*
+    Read snapshot file
+*/
+void State::load(const std::string & path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error(fmt::format("File not found {}", path));
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    position = 0;
+}
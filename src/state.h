@@ -0,0 +1,143 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATE_H
+#define STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//
+// Machine save-state
+//
+//      Compact binary snapshot: header (magic, format version) followed
+//      by one tagged section per component, each component writes its
+//      own fields in fixed order. Values are stored in host byte order,
+//      so snapshots are meant for the machine that made them.
+//
+//      Buffer keeps its capacity between snapshots, so saving
+//      every frame does not allocate.
+//
+
+class State
+{
+private:
+
+    std::vector<uint8_t> data;
+
+    // Read position
+    size_t position = 0;
+
+public:
+
+    // Snapshot format version, bump on any layout change
+    static constexpr uint16_t version = 2;
+
+    /*
+        Start new snapshot with header
+    */
+    void begin();
+
+    /*
+        Verify header and read from first section
+    */
+    void open();
+
+    /*
+        Write/Verify section tag of four characters
+    */
+    void mark(const char * tag);
+    void check(const char * tag);
+
+    /*
+        Write/Read raw bytes
+    */
+    void put(const void * bytes, size_t size)
+    {
+        auto from = static_cast<const uint8_t *>(bytes);
+        data.insert(data.end(), from, from + size);
+    }
+
+    void get(void * bytes, size_t size);
+
+    /*
+        Write/Read value of trivially copyable type
+    */
+    template <typename T>
+    void put(const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "State value must be trivially copyable");
+        put(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void get(T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "State value must be trivially copyable");
+        get(&value, sizeof(T));
+    }
+
+    /*
+        Read bool, bytes other than 0 and 1 are rejected
+    */
+    void get(bool & value);
+
+    /*
+        Read enum or table index, values past last are rejected
+    */
+    template <typename T>
+    void get(T & value, T last)
+    {
+        T read;
+        get(read);
+
+        if (read > last)
+            throw std::runtime_error("Save-state value out of range");
+
+        value = read;
+    }
+
+    /*
+        Write/Read snapshot file
+    */
+    void save(const std::string & path) const;
+    void load(const std::string & path);
+
+    /*
+        Replace snapshot bytes, e.g. rebuilt by Rewind
+    */
+    void assign(const uint8_t * bytes, size_t size)
+    {
+        data.assign(bytes, bytes + size);
+        position = 0;
+    }
+
+    const uint8_t * getData() const {
+        return data.data();
+    }
+
+    size_t size() const {
+        return data.size();
+    }
+};
+
+#endif
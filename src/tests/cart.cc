@@ -0,0 +1,106 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "check.h"
+
+#include "cart/cart.h"
+#include "cart/mapper.h"
+#include "bus/bus.h"
+#include "cpu/cpu.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/*
+    Write NES 2.0 image of mapper 0, PRG pages hold their page number
+    Returns path of image
+*/
+static std::string write(const char * name, uint8_t prg, uint8_t chr, uint8_t msb, size_t body)
+{
+    std::vector<uint8_t> image { 'N', 'E', 'S', 0x1A, prg, chr, 0x00, 0x08, 0x00, msb, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+    for (size_t index = 0; index < body; index++) {
+        image.push_back(uint8_t(index >> 8));
+    }
+
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(image.data()), image.size());
+
+    return path;
+}
+
+
+/*
+    Image is refused by parser
+*/
+static bool isRejected(const std::string & path)
+{
+    bool rejected = false;
+
+    try {
+        Cart cart(path);
+    } catch (const std::runtime_error &) {
+        rejected = true;
+    }
+
+    std::filesystem::remove(path);
+    return rejected;
+}
+
+
+/*
+    NES 2.0 sizes in exponent notation, 2^E * (MM * 2 + 1)
+*/
+void testCart()
+{
+    // PRG 3 << 30 and CHR 1 << 30 wrap 32-bit sum of sizes to zero
+    CHECK(isRejected(write("wrap.nes", (30 << 2) | 1, 30 << 2, 0xFF, 0x10000)));
+
+    // 1 byte PRG, mappers switch 8KB banks
+    CHECK(isRejected(write("prg.nes", 0x00, 0x00, 0x0F, 0x10000)));
+
+    // 512 bytes CHR, mappers switch 1KB banks
+    CHECK(isRejected(write("chr.nes", 0x01, 9 << 2, 0xF0, 0x10000)));
+
+    // 24KB PRG with 8KB CHR, 16KB banks of NROM wrap within ROM
+    auto path = write("odd.nes", (13 << 2) | 1, 0x01, 0x0F, 0x8000);
+
+    {
+        Cart cart(path);
+        CHECK(cart.getPrgSize() == 0x6000);
+
+        Bus bus;
+        Cpu cpu(bus);
+
+        auto mapper = Mapper::create(cart);
+        mapper -> attach(bus, cpu);
+
+        // $C000 maps last 16KB, which starts at 8KB
+        for (unsigned page = 0x80; page <= 0xFF; page++)
+        {
+            unsigned expected = page < 0xC0 ? page - 0x80 : 0x20 + page - 0xC0;
+            CHECK(bus.read((page << 8) | 0xFF) == expected);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
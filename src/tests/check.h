@@ -0,0 +1,34 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+//
+// Test assertion
+// Failed condition throws with its source location, test runner reports it
+//
+
+#define CHECK(condition)                                                                    \
+    if (!(condition))                                                                       \
+        throw std::runtime_error(fmt::format("{}:{} {}", __FILE__, __LINE__, #condition))
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "check.h"
+
+#include "machine.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/*
+    Write NROM image counting frames and loop rounds
+    Returns path of image
+
+    $E000   LDA #$80, STA $2000     NMI on vertical blank
+            LDA #$40, STA $4017     no frame IRQ
+    loop    INC $10                 loop rounds
+            LDA $10, STA $6000      copy to PRG RAM
+            LDA $8000, STA $11      PRG ROM byte, must not be open bus
+            JMP loop
+    $E040   INC $12, RTI            NMI counts frames
+*/
+std::string writeNrom(const char * name)
+{
+    std::vector<uint8_t> image { 'N', 'E', 'S', 0x1A, 0x02, 0x01, 0x00, 0x00, 0, 0, 0, 0, 0, 0, 0, 0 };
+    std::vector<uint8_t> prg(0x8000, 0xEA);
+
+    const uint8_t code[] =
+    {
+        0xA9, 0x80, 0x8D, 0x00, 0x20,
+        0xA9, 0x40, 0x8D, 0x17, 0x40,
+        0xE6, 0x10,
+        0xA5, 0x10, 0x8D, 0x00, 0x60,
+        0xAD, 0x00, 0x80, 0x85, 0x11,
+        0x4C, 0x0A, 0xE0
+    };
+
+    const uint8_t nmi[] = { 0xE6, 0x12, 0x40 };
+
+    std::copy(std::begin(code), std::end(code), prg.begin() + 0x6000);
+    std::copy(std::begin(nmi), std::end(nmi), prg.begin() + 0x6040);
+
+    // NMI, reset and IRQ vectors
+    const uint8_t vectors[] = { 0x40, 0xE0, 0x00, 0xE0, 0x40, 0xE0 };
+    std::copy(std::begin(vectors), std::end(vectors), prg.end() - 6);
+
+    image.insert(image.end(), prg.begin(), prg.end());
+    image.insert(image.end(), 0x2000, 0x00);
+
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(image.data()), image.size());
+
+    return path;
+}
+
+
+/*
+    Forked cartridge machine runs on its own devices and RAM
+*/
+void testFork()
+{
+    auto path = writeNrom("fork.nes");
+
+    {
+        Machine parent(path);
+        parent.run(100000);
+
+        auto child = parent.fork();
+
+        auto & bus = child -> getBus();
+        auto & cpu = child -> getCpu();
+
+        CHECK(cpu.getPc() == parent.getCpu().getPc());
+        CHECK(bus.read(0x8000) == 0xEA);
+
+        // Same state runs the same way
+        uint64_t end = parent.getCpu().getCycles() + 200000;
+
+        parent.run(end);
+        child -> run(end);
+
+        CHECK(cpu.getCycles() == parent.getCpu().getCycles());
+        CHECK(child -> getFrames() == parent.getFrames());
+        CHECK(child -> getFrames() > 0);
+
+        for (uint16_t address : { 0x0010, 0x0011, 0x0012, 0x6000 }) {
+            CHECK(bus.read(address) == parent.getBus().read(address));
+        }
+
+        CHECK(bus.read(0x0011) == 0xEA);
+
+        // Writes of one side are not seen by the other
+        bus.write(0x0012, bus.read(0x0012) + 0x40);
+        bus.write(0x6001, 0x55);
+        parent.getBus().write(0x0013, 0xAA);
+
+        end += 100000;
+
+        parent.run(end);
+        child -> run(end);
+
+        CHECK(parent.getBus().read(0x6001) == 0x00);
+        CHECK(bus.read(0x6001) == 0x55);
+        CHECK(bus.read(0x0013) == 0x00);
+        CHECK(parent.getBus().read(0x0013) == 0xAA);
+
+        // Frame counters in RAM diverged by the write, PPU of each keeps counting
+        CHECK(uint8_t(bus.read(0x0012) - parent.getBus().read(0x0012)) == 0x40);
+        CHECK(child -> getFrames() == parent.getFrames());
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "check.h"
+
+#include "machine.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// NROM image of fork test
+std::string writeNrom(const char * name);
+
+
+/*
+    Returns true when snapshot with byte at offset replaced is rejected
+*/
+static bool rejected(Machine & machine, const std::vector<uint8_t> & bytes, size_t offset, const void * value, size_t size)
+{
+    auto copy = bytes;
+    std::memcpy(copy.data() + offset, value, size);
+
+    State state;
+    state.assign(copy.data(), copy.size());
+
+    try {
+        machine.load(state);
+    }
+    catch (const std::runtime_error &) {
+        return true;
+    }
+
+    return false;
+}
+
+
+/*
+    Corrupted bools, enums and bank offsets are rejected on load
+*/
+void testState()
+{
+    auto path = writeNrom("state.nes");
+
+    {
+        Machine machine(path);
+        machine.run(100000);
+
+        State state;
+        machine.save(state);
+
+        std::vector<uint8_t> bytes(state.getData(), state.getData() + state.size());
+
+        // Mapper section: PRG offsets, CHR offsets, mirroring, IRQ line
+        const char tag[] = "MAP ";
+        auto found = std::search(bytes.begin(), bytes.end(), tag, tag + 4);
+        CHECK(found != bytes.end());
+
+        size_t prg = (found - bytes.begin()) + 4;
+        size_t chr = prg + 128 * sizeof(uint32_t);
+        size_t mirroring = chr + 8 * sizeof(uint32_t);
+        size_t irq = mirroring + 1;
+
+        const uint32_t outside = 0x10000, unaligned = 0x10, chrOutside = 0x2000, chrUnaligned = 0x100;
+        const uint8_t two = 2, screen = 5;
+
+        CHECK(!rejected(machine, bytes, irq, &bytes[irq], 1));
+
+        CHECK(rejected(machine, bytes, prg, &outside, sizeof(outside)));
+        CHECK(rejected(machine, bytes, prg, &unaligned, sizeof(unaligned)));
+        CHECK(rejected(machine, bytes, chr, &chrOutside, sizeof(chrOutside)));
+        CHECK(rejected(machine, bytes, chr, &chrUnaligned, sizeof(chrUnaligned)));
+        CHECK(rejected(machine, bytes, mirroring, &screen, 1));
+        CHECK(rejected(machine, bytes, irq, &two, 1));
+
+        // Rejected snapshot leaves machine loadable from a good one
+        state.assign(bytes.data(), bytes.size());
+        machine.load(state);
+        machine.run(200000);
+
+        CHECK(machine.getFrames() > 0);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "check.h"
+
+#include <cstring>
+#include <iostream>
+
+// Test cases
+void testCart();
+void testFork();
+void testState();
+
+//
+// Test runner
+//
+//      Runs test case given by name, or all of them without one.
+//      Exit code is the number of failed cases.
+//
+
+static const struct
+{
+    const char * name;
+    void (* run) ();
+}
+cases[] =
+{
+    { "cart", testCart },
+    { "fork", testFork },
+    { "state", testState }
+};
+
+
+int main(int argc, char ** argv)
+{
+    int failed = 0;
+
+    for (auto & test : cases)
+    {
+        if (argc > 1 && std::strcmp(argv[1], test.name))
+            continue;
+
+        try
+        {
+            test.run();
+            fmt::print("{} ok\n", test.name);
+        }
+        catch (const std::exception & e)
+        {
+            std::cerr << test.name << " failed: " << e.what() << '\n';
+            failed++;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,836 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "machine.h"
+
+#include "cpu/cpu.h"
+#include "cpu/cmd.h"
+#include "cpu/map.h"
+#include "bus/bus.h"
+
+#include "fmt/core.h"
+#include "fmt/format.h"
+
+//
+// Ahead-of-time recompiler
+//
+//      Disassembles ROM by recursive descent from reset, NMI and IRQ
+//      vectors, start of raw binary and given entries, and writes C++
+//      unit with one function per block working on registers of Cpu.
+//      The unit is linked into emulator with AOT_ROMS option and runs
+//      with -e aot, see Aot.
+//
+//      Descent follows branches, jumps and subroutine returns, it stops
+//      at indirect jumps, returns, BRK and undocumented commands. Only
+//      banks mapped on start are seen, others are left to interpreter.
+//
+//      Usage: nes-aot <rom> <unit.cc> [entry ...]
+//
+
+// Commands per block
+static const uint32_t limit = 64;
+
+
+/*
+    Translated block
+*/
+struct Block
+{
+    uint16_t pc;
+    uint16_t size;
+    uint16_t worst;
+
+    // Function body
+    std::string code;
+};
+
+
+class Recompiler
+{
+private:
+
+    Bus & bus;
+
+    Cpu::Variant variant;
+
+    // Block addresses found, queued until translated
+    std::set<uint16_t> leaders;
+    std::vector<uint16_t> queue;
+
+    std::vector<Block> blocks;
+
+    // Commands translated
+    uint32_t commands = 0;
+
+    /*
+        Queue block at address on memory page
+    */
+    void enqueue (uint16_t pc)
+    {
+        if (bus.isMemory(pc >> 8) && leaders.insert(pc).second)
+            queue.push_back(pc);
+    }
+
+    /*
+        Queue addresses command continues at
+    */
+    void follow (const Cmd & cmd, uint16_t at, const uint8_t * bytes);
+
+    /*
+        Translate block at address, queue its successors
+    */
+    void translate (uint16_t pc);
+
+    /*
+        Command is translated, BRK is left to interpreter
+    */
+    static bool isSupported (const Cmd & cmd)
+    {
+        return !cmd.isIllegal() && cmd.mnemonic != Mnemonic::BRK;
+    }
+
+    /*
+        Command text for comments
+    */
+    static std::string disassemble (const Cmd & cmd, uint16_t at, const uint8_t * bytes);
+
+public:
+
+    Recompiler(Bus & bus, Cpu::Variant variant) : bus(bus), variant(variant)
+    { }
+
+    /*
+        Translate blocks reachable from entry addresses
+    */
+    void run (const std::vector<uint16_t> & entries);
+
+    /*
+        Returns C++ unit of translated blocks
+    */
+    std::string unit (const std::string & name, uint32_t rom) const;
+
+    size_t getBlocks () const {
+        return blocks.size();
+    }
+
+    uint32_t getCommands () const {
+        return commands;
+    }
+};
+
+
+/*
+    Translate blocks reachable from entry addresses
+*/
+void Recompiler::run (const std::vector<uint16_t> & entries)
+{
+    for (auto entry : entries) {
+        enqueue(entry);
+    }
+
+    while (!queue.empty())
+    {
+        auto pc = queue.back();
+        queue.pop_back();
+
+        translate(pc);
+    }
+
+    std::sort(blocks.begin(), blocks.end(), [] (const Block & a, const Block & b) {
+        return a.pc < b.pc;
+    });
+}
+
+
+/*
+    Queue addresses command continues at
+*/
+void Recompiler::follow (const Cmd & cmd, uint16_t at, const uint8_t * bytes)
+{
+    uint16_t next = at + cmd.getBytes();
+    uint16_t word = bytes[1] | (bytes[2] << 8);
+
+    if (cmd.isRel())
+    {
+        enqueue(next + (int8_t) bytes[1]);
+        enqueue(next);
+
+        return;
+    }
+
+    switch (cmd.mnemonic)
+    {
+        case Mnemonic::JMP:
+            if (cmd.addressing == Mode::ABS)
+                enqueue(word);
+            break;
+
+        // Subroutine is expected to return
+        case Mnemonic::JSR:
+            enqueue(word);
+            enqueue(next);
+            break;
+
+        case Mnemonic::RTS:
+        case Mnemonic::RTI:
+        case Mnemonic::BRK:
+            break;
+
+        default:
+            if (!cmd.isIllegal())
+                enqueue(next);
+            break;
+    }
+}
+
+
+/*
+    Translate block at address, queue its successors
+
+    Cycles of translated commands are added to the counter before
+    the next bus access and when leaving, so devices see the same
+    counter as when run by interpreter.
+*/
+void Recompiler::translate (uint16_t pc)
+{
+    std::string code;
+    auto out = std::back_inserter(code);
+
+    // Cycles not yet added to counter
+    uint32_t cycles = 0;
+
+    uint32_t worst = 0;
+    uint32_t count = 0;
+
+    // Block accesses bus, command accesses bus
+    bool memory = false;
+    bool access = false;
+
+    bool last = false;
+
+    uint16_t next = pc;
+
+    // Before first bus access of command
+    auto flush = [&] {
+        if (cycles)
+            fmt::format_to(out, "        cpu.cycles += {};\n", cycles);
+
+        cycles = 0;
+        memory = access = true;
+    };
+
+    auto leave = [&] (const std::string & target, uint32_t penalty, const std::string & trap) {
+        fmt::format_to(out, "return Aot::leave(cpu, {}, {}, {}{});\n", target, cycles + penalty, count, trap.empty() ? "" : ", " + trap);
+    };
+
+    // Block ends on its page
+    while (count < limit && (next >> 8) == (pc >> 8))
+    {
+        uint16_t at = next;
+        uint8_t bytes[3] = { bus.read(at), 0, 0 };
+
+        auto & cmd = Map::getCommand(bytes[0]);
+
+        for (unsigned index = 1; index < cmd.getBytes(); index++) {
+            bytes[index] = bus.read(at + index);
+        }
+
+        // Interpreter runs it, operand on next page included
+        if (!isSupported(cmd) || (at & 0xFF) + cmd.getBytes() > 0x100)
+        {
+            if (count == 0)
+                follow(cmd, at, bytes);
+
+            break;
+        }
+
+        next = at + cmd.getBytes();
+        count++;
+
+        access = false;
+
+        // Page crossing and taken branch
+        worst += cmd.cycles + (cmd.isCross() ? 1 : 0) + (cmd.isRel() ? 2 : 0);
+
+        uint16_t word = bytes[1] | (bytes[2] << 8);
+
+        fmt::format_to(out, "\n    // {:04X}  {}\n    {{\n", at, disassemble(cmd, at, bytes));
+
+        // Effective address and page crossing test
+        std::string ea;
+        std::string cross;
+
+        switch (cmd.addressing)
+        {
+            case Mode::ZPG:
+                ea = fmt::format("0x{:04X}", bytes[1]);
+                break;
+
+            case Mode::ABS:
+                ea = fmt::format("0x{:04X}", word);
+                break;
+
+            case Mode::ZPGX:
+            case Mode::ZPGY:
+                fmt::format_to(out, "        uint16_t ea = 0x00FF & (0x{:02X} + cpu.{});\n", bytes[1], cmd.addressing == Mode::ZPGX ? 'x' : 'y');
+                ea = "ea";
+                break;
+
+            case Mode::ABSX:
+            case Mode::ABSY:
+                fmt::format_to(out, "        uint16_t ea = 0x{:04X} + cpu.{};\n", word, cmd.addressing == Mode::ABSX ? 'x' : 'y');
+                ea = "ea";
+                cross = fmt::format("(0x{:04X} ^ ea) & 0xFF00", word);
+                break;
+
+            case Mode::INDX:
+                flush();
+                fmt::format_to(out, "        uint16_t ea = Aot::pointer(bus, 0x{:02X} + cpu.x, slow);\n", bytes[1]);
+                ea = "ea";
+                break;
+
+            case Mode::INDY:
+                flush();
+                fmt::format_to(out, "        uint16_t base = Aot::pointer(bus, 0x{:02X}, slow);\n", bytes[1]);
+                fmt::format_to(out, "        uint16_t ea = base + cpu.y;\n");
+                ea = "ea";
+                cross = "(base ^ ea) & 0xFF00";
+                break;
+
+            default:
+                break;
+        }
+
+        // Operand of reading commands
+        auto load = [&] {
+            if (cmd.addressing == Mode::IMM) {
+                fmt::format_to(out, "        uint8_t data = 0x{:02X};\n", bytes[1]);
+            } else if (cmd.addressing == Mode::ACC) {
+                fmt::format_to(out, "        uint8_t data = cpu.a;\n");
+            } else {
+                flush();
+                fmt::format_to(out, "        uint8_t data = Aot::read(bus, {}, slow);\n", ea);
+            }
+        };
+
+        // Result of read-modify-write commands
+        auto store = [&] (const char * value) {
+            if (cmd.addressing == Mode::ACC) {
+                fmt::format_to(out, "        cpu.a = {};\n", value);
+            } else {
+                fmt::format_to(out, "        Aot::write(bus, {}, {}, slow);\n", ea, value);
+            }
+        };
+
+        const char * reg = "a";
+
+        switch (cmd.mnemonic)
+        {
+            case Mnemonic::LDX: case Mnemonic::STX: case Mnemonic::CPX:
+            case Mnemonic::INX: case Mnemonic::DEX: case Mnemonic::TAX:
+            case Mnemonic::TSX:
+                reg = "x";
+                break;
+
+            case Mnemonic::LDY: case Mnemonic::STY: case Mnemonic::CPY:
+            case Mnemonic::INY: case Mnemonic::DEY: case Mnemonic::TAY:
+                reg = "y";
+                break;
+
+            default:
+                break;
+        }
+
+        switch (cmd.mnemonic)
+        {
+            case Mnemonic::LDA: case Mnemonic::LDX: case Mnemonic::LDY:
+                load();
+                fmt::format_to(out, "        cpu.{0} = data;\n        cpu.p.setNegativeZero(cpu.{0});\n", reg);
+                break;
+
+            case Mnemonic::STA: case Mnemonic::STX: case Mnemonic::STY:
+                flush();
+                fmt::format_to(out, "        Aot::write(bus, {}, cpu.{}, slow);\n", ea, reg);
+                break;
+
+            case Mnemonic::AND: case Mnemonic::ORA: case Mnemonic::EOR:
+                load();
+                fmt::format_to(out, "        cpu.a {}= data;\n        cpu.p.setNegativeZero(cpu.a);\n",
+                    cmd.mnemonic == Mnemonic::AND ? '&' : cmd.mnemonic == Mnemonic::ORA ? '|' : '^');
+                break;
+
+            case Mnemonic::CMP: case Mnemonic::CPX: case Mnemonic::CPY:
+                load();
+                fmt::format_to(out,
+                    "        cpu.p.setNegative((bool) (data >  cpu.{0}));\n"
+                    "        cpu.p.setZero    ((bool) (data == cpu.{0}));\n"
+                    "        cpu.p.setCarry   ((bool) (data <= cpu.{0}));\n", reg);
+                break;
+
+            case Mnemonic::BIT:
+                load();
+                fmt::format_to(out,
+                    "        cpu.p.setNegative((bool) (data & 0x80));\n"
+                    "        cpu.p.setOverflow((bool) (data & 0x40));\n"
+                    "        cpu.p.setZero(data & cpu.a);\n");
+                break;
+
+            case Mnemonic::ADC: case Mnemonic::SBC:
+            {
+                bool add = cmd.mnemonic == Mnemonic::ADC;
+
+                load();
+
+                std::string indent = "        ";
+
+                // Decimal mode of NMOS 6502 stays in Cpu
+                if (variant != Cpu::Variant::Ricoh2A03)
+                {
+                    fmt::format_to(out, "        if (cpu.p.isDecimal()) {{\n            cpu.{}D(data);\n        }} else {{\n", add ? "ADC" : "SBC");
+                    indent += "    ";
+                }
+
+                fmt::format_to(out,
+                    "{0}uint8_t arg = {1};\n"
+                    "{0}uint16_t sum = (uint16_t) cpu.a + (uint16_t) arg + cpu.p.getCarry();\n"
+                    "{0}cpu.p.setNegativeZero(sum);\n"
+                    "{0}cpu.p.setCarry((bool) (sum > 255));\n"
+                    "{0}cpu.p.setOverflow((bool) (~(cpu.a ^ arg) & (cpu.a ^ sum) & 0x80));\n"
+                    "{0}cpu.a = 0x00FF & sum;\n", indent, add ? "data" : "~data");
+
+                if (variant != Cpu::Variant::Ricoh2A03)
+                    fmt::format_to(out, "        }}\n");
+
+                break;
+            }
+
+            case Mnemonic::ASL: case Mnemonic::LSR: case Mnemonic::ROL: case Mnemonic::ROR:
+            {
+                const char * shift = "data << 1";
+                const char * carry = "0x80";
+
+                if (cmd.mnemonic == Mnemonic::LSR) {
+                    shift = "data >> 1";
+                    carry = "0x01";
+                } else if (cmd.mnemonic == Mnemonic::ROL) {
+                    shift = "(data << 1) | cpu.p.getCarry()";
+                } else if (cmd.mnemonic == Mnemonic::ROR) {
+                    shift = "(data >> 1) | (cpu.p.getCarry() << 7)";
+                    carry = "0x01";
+                }
+
+                load();
+                fmt::format_to(out,
+                    "        uint8_t value = {};\n"
+                    "        cpu.p.setNegativeZero(value);\n"
+                    "        cpu.p.setCarry((bool) (data & {}));\n", shift, carry);
+                store("value");
+                break;
+            }
+
+            case Mnemonic::INC: case Mnemonic::DEC:
+                load();
+                fmt::format_to(out,
+                    "        uint16_t value = data;\n"
+                    "        value{};\n"
+                    "        cpu.p.setNegativeZero(value);\n", cmd.mnemonic == Mnemonic::INC ? "++" : "--");
+                store("(uint8_t) value");
+                break;
+
+            case Mnemonic::INX: case Mnemonic::INY:
+            case Mnemonic::DEX: case Mnemonic::DEY:
+                fmt::format_to(out, "        cpu.{0}{1};\n        cpu.p.setNegativeZero(cpu.{0});\n", reg,
+                    cmd.mnemonic == Mnemonic::INX || cmd.mnemonic == Mnemonic::INY ? "++" : "--");
+                break;
+
+            case Mnemonic::TAX: case Mnemonic::TAY:
+                fmt::format_to(out, "        cpu.{0} = cpu.a;\n        cpu.p.setNegativeZero(cpu.{0});\n", reg);
+                break;
+
+            case Mnemonic::TXA: case Mnemonic::TYA:
+                fmt::format_to(out, "        cpu.a = cpu.{};\n        cpu.p.setNegativeZero(cpu.a);\n",
+                    cmd.mnemonic == Mnemonic::TXA ? 'x' : 'y');
+                break;
+
+            case Mnemonic::TSX:
+                fmt::format_to(out, "        cpu.x = cpu.s;\n        cpu.p.setNegativeZero(cpu.x);\n");
+                break;
+
+            case Mnemonic::TXS:
+                fmt::format_to(out, "        cpu.s = cpu.x;\n");
+                break;
+
+            case Mnemonic::CLC: fmt::format_to(out, "        cpu.p.setCarry(false);\n");     break;
+            case Mnemonic::SEC: fmt::format_to(out, "        cpu.p.setCarry(true);\n");      break;
+            case Mnemonic::CLV: fmt::format_to(out, "        cpu.p.setOverflow(false);\n");  break;
+            case Mnemonic::CLI: fmt::format_to(out, "        cpu.p.setInterrupt(false);\n"); break;
+            case Mnemonic::SEI: fmt::format_to(out, "        cpu.p.setInterrupt(true);\n");  break;
+            case Mnemonic::CLD: fmt::format_to(out, "        cpu.p.setDecimal(false);\n");   break;
+            case Mnemonic::SED: fmt::format_to(out, "        cpu.p.setDecimal(true);\n");    break;
+
+            case Mnemonic::PHA:
+            case Mnemonic::PHP:
+                flush();
+                fmt::format_to(out, "        Aot::write(bus, 0x0100 + cpu.s, cpu.{}, slow);\n        cpu.s--;\n",
+                    cmd.mnemonic == Mnemonic::PHA ? 'a' : 'p');
+
+                if (cmd.mnemonic == Mnemonic::PHP)
+                    fmt::format_to(out, "        cpu.p.setBreak(false);\n");
+
+                break;
+
+            case Mnemonic::PLA:
+                flush();
+                fmt::format_to(out, "        cpu.s++;\n        cpu.a = Aot::read(bus, 0x0100 + cpu.s, slow);\n        cpu.p.setNegativeZero(cpu.a);\n");
+                break;
+
+            case Mnemonic::PLP:
+                flush();
+                fmt::format_to(out, "        cpu.s++;\n        cpu.p = Aot::read(bus, 0x0100 + cpu.s, slow);\n");
+                break;
+
+            case Mnemonic::BPL: case Mnemonic::BMI: case Mnemonic::BVC: case Mnemonic::BVS:
+            case Mnemonic::BCC: case Mnemonic::BCS: case Mnemonic::BNE: case Mnemonic::BEQ:
+            {
+                const char * test = "";
+
+                switch (cmd.mnemonic)
+                {
+                    case Mnemonic::BPL: test = "!cpu.p.isNegative()"; break;
+                    case Mnemonic::BMI: test = "cpu.p.isNegative()";  break;
+                    case Mnemonic::BVC: test = "!cpu.p.isOverflow()"; break;
+                    case Mnemonic::BVS: test = "cpu.p.isOverflow()";  break;
+                    case Mnemonic::BCC: test = "!cpu.p.isCarry()";    break;
+                    case Mnemonic::BCS: test = "cpu.p.isCarry()";     break;
+                    case Mnemonic::BNE: test = "!cpu.p.isZero()";     break;
+                    case Mnemonic::BEQ: test = "cpu.p.isZero()";      break;
+                    default: break;
+                }
+
+                uint16_t target = next + (int8_t) bytes[1];
+
+                cycles += cmd.cycles;
+                last = true;
+
+                // Taken branch adds a cycle, one more if it lands on another page
+                fmt::format_to(out, "        if ({})\n            ", test);
+                leave(fmt::format("0x{:04X}", target), ((next ^ target) & 0xFF00) ? 2 : 1, target == at ? "true" : "");
+
+                fmt::format_to(out, "\n        ");
+                leave(fmt::format("0x{:04X}", next), 0, "");
+                break;
+            }
+
+            case Mnemonic::JMP:
+                if (cmd.addressing == Mode::IND)
+                {
+                    flush();
+                    fmt::format_to(out,
+                        "        uint16_t pc = Aot::read(bus, 0x{:04X}, slow);\n"
+                        "        pc |= Aot::read(bus, 0x{:04X}, slow) << 8;\n\n", word, uint16_t(word + 1));
+
+                    cycles += cmd.cycles;
+                    last = true;
+
+                    fmt::format_to(out, "        ");
+                    leave("pc", 0, fmt::format("pc == 0x{:04X}", at));
+                    break;
+                }
+
+                cycles += cmd.cycles;
+                last = true;
+
+                fmt::format_to(out, "        ");
+                leave(fmt::format("0x{:04X}", word), 0, word == at ? "true" : "");
+                break;
+
+            case Mnemonic::JSR:
+            {
+                uint16_t back = at + 2;
+
+                flush();
+                fmt::format_to(out,
+                    "        Aot::write(bus, 0x0100 + cpu.s, 0x{:02X}, slow);\n        cpu.s--;\n"
+                    "        Aot::write(bus, 0x0100 + cpu.s, 0x{:02X}, slow);\n        cpu.s--;\n\n", back >> 8, back & 0xFF);
+
+                cycles += cmd.cycles;
+                last = true;
+
+                fmt::format_to(out, "        ");
+                leave(fmt::format("0x{:04X}", word), 0, word == at ? "true" : "");
+                break;
+            }
+
+            case Mnemonic::RTS:
+            case Mnemonic::RTI:
+                flush();
+
+                if (cmd.mnemonic == Mnemonic::RTI)
+                    fmt::format_to(out, "        cpu.s++;\n        cpu.p = Aot::read(bus, 0x0100 + cpu.s, slow);\n\n");
+
+                fmt::format_to(out,
+                    "        cpu.s++;\n        uint16_t pc = Aot::read(bus, 0x0100 + cpu.s, slow);\n"
+                    "        cpu.s++;\n        pc |= Aot::read(bus, 0x0100 + cpu.s, slow) << 8;\n\n");
+
+                if (cmd.mnemonic == Mnemonic::RTI) {
+                    fmt::format_to(out, "        cpu.p.setBreak(false);\n\n");
+                } else {
+                    fmt::format_to(out, "        pc++;\n\n");
+                }
+
+                cycles += cmd.cycles;
+                last = true;
+
+                fmt::format_to(out, "        ");
+                leave("pc", 0, fmt::format("pc == 0x{:04X}", at));
+                break;
+
+            // NOP
+            default:
+                break;
+        }
+
+        if (last)
+        {
+            fmt::format_to(out, "    }}\n");
+            follow(cmd, at, bytes);
+            break;
+        }
+
+        // Read commands take one more cycle when indexing crosses page
+        if (cmd.isCross() && !cross.empty())
+            fmt::format_to(out, "\n        if ({})\n            cpu.cycles++;\n", cross);
+
+        fmt::format_to(out, "    }}\n");
+
+        cycles += cmd.cycles;
+
+        // Device access may switch banks or raise interrupt
+        if (access)
+        {
+            fmt::format_to(out, "\n    if (slow)\n        ");
+            leave(fmt::format("0x{:04X}", next), 0, "");
+        }
+    }
+
+    if (count == 0)
+        return;
+
+    // Next command is interpreted or starts another block
+    if (!last)
+    {
+        fmt::format_to(out, "\n    ");
+        leave(fmt::format("0x{:04X}", next), 0, "");
+
+        enqueue(next);
+    }
+
+    std::string body;
+
+    if (memory)
+        body = "    auto & bus = cpu.mem.getBus();\n    bool slow = false;\n";
+
+    blocks.push_back(Block { pc, uint16_t(next - pc), uint16_t(worst), body + code });
+    commands += count;
+}
+
+
+/*
+    Command text for comments
+*/
+std::string Recompiler::disassemble (const Cmd & cmd, uint16_t at, const uint8_t * bytes)
+{
+    std::string name = Map::getName(bytes[0]);
+    uint16_t word = bytes[1] | (bytes[2] << 8);
+
+    switch (cmd.addressing)
+    {
+        case Mode::ACC:  return name + " A";
+        case Mode::IMM:  return fmt::format("{} #${:02X}", name, bytes[1]);
+        case Mode::ZPG:  return fmt::format("{} ${:02X}", name, bytes[1]);
+        case Mode::ZPGX: return fmt::format("{} ${:02X},X", name, bytes[1]);
+        case Mode::ZPGY: return fmt::format("{} ${:02X},Y", name, bytes[1]);
+        case Mode::ABS:  return fmt::format("{} ${:04X}", name, word);
+        case Mode::ABSX: return fmt::format("{} ${:04X},X", name, word);
+        case Mode::ABSY: return fmt::format("{} ${:04X},Y", name, word);
+        case Mode::IND:  return fmt::format("{} (${:04X})", name, word);
+        case Mode::INDX: return fmt::format("{} (${:02X},X)", name, bytes[1]);
+        case Mode::INDY: return fmt::format("{} (${:02X}),Y", name, bytes[1]);
+        case Mode::REL:  return fmt::format("{} ${:04X}", name, uint16_t(at + 2 + (int8_t) bytes[1]));
+
+        default:
+            return name;
+    }
+}
+
+
+/*
+    Returns C++ unit of translated blocks
+
+    Block functions are members of Compiled specialized for the ROM,
+    so they reach registers of Cpu and units of several ROMs link together.
+*/
+std::string Recompiler::unit (const std::string & name, uint32_t rom) const
+{
+    std::string code;
+    auto out = std::back_inserter(code);
+
+    auto type = fmt::format("Compiled<0x{:08X}>", rom);
+
+    fmt::format_to(out, "// Generated by nes-aot from {}, do not edit\n", name);
+    fmt::format_to(out, "// {} blocks of {} commands\n\n", blocks.size(), commands);
+    fmt::format_to(out, "#include \"aot/aot.h\"\n\n");
+
+    fmt::format_to(out, "template <>\nclass {}\n{{\npublic:\n\n", type);
+
+    for (auto & block : blocks) {
+        fmt::format_to(out, "    static int block{:04X} (Cpu & cpu);\n", block.pc);
+    }
+
+    fmt::format_to(out, "}};\n");
+
+    for (auto & block : blocks) {
+        fmt::format_to(out, "\n\n// ${:04X}\nint {}::block{:04X} (Cpu & cpu)\n{{\n{}}}\n", block.pc, type, block.pc, block.code);
+    }
+
+    // Bytes blocks are checked against
+    fmt::format_to(out, "\n\nstatic const uint8_t bytes[] =\n{{");
+
+    for (auto & block : blocks)
+    {
+        fmt::format_to(out, "\n   ");
+
+        for (unsigned index = 0; index < block.size; index++) {
+            fmt::format_to(out, " 0x{:02X},", bus.read(block.pc + index));
+        }
+    }
+
+    fmt::format_to(out, "\n}};\n\nstatic const Aot::Block blocks[] =\n{{\n");
+
+    size_t offset = 0;
+
+    for (auto & block : blocks)
+    {
+        fmt::format_to(out, "    {{ 0x{:04X}, {:3}, {:3}, bytes + {}, &{}::block{:04X} }},\n",
+            block.pc, block.size, block.worst, offset, type, block.pc);
+
+        offset += block.size;
+    }
+
+    fmt::format_to(out, "}};\n\n");
+
+    fmt::format_to(out, "static const Aot::Program program {{ \"{}\", Cpu::Variant::{}, blocks, sizeof(blocks) / sizeof(blocks[0]) }};\n\n",
+        name, variant == Cpu::Variant::Nmos6502 ? "Nmos6502" : "Ricoh2A03");
+
+    fmt::format_to(out, "static const Aot::Link link(program);\n");
+
+    return code;
+}
+
+
+/*
+    FNV-1a hash of ROM file, names its Compiled specialization
+*/
+static uint32_t hash(const std::string & path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    std::vector<uint8_t> image (
+        (std::istreambuf_iterator<char>(file)),
+        (std::istreambuf_iterator<char>())
+    );
+
+    uint32_t value = 2166136261u;
+
+    for (auto byte : image) {
+        value = (value ^ byte) * 16777619u;
+    }
+
+    return value;
+}
+
+
+/*
+    ~
+*/
+int main(int argc, char ** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: nes-aot <rom> <unit.cc> [entry ...]\n";
+        return 1;
+    }
+
+    try
+    {
+        std::string path = argv[1];
+
+        Machine machine(path);
+
+        auto & bus = machine.getBus();
+        auto & cpu = machine.getCpu();
+
+        std::vector<uint16_t> entries;
+
+        // Raw binary starts at PC, cartridge from reset vector
+        if (!machine.isCart())
+            entries.push_back(cpu.getPc());
+
+        for (uint16_t vector : { 0xFFFA, 0xFFFC, 0xFFFE })
+        {
+            if (bus.isMemory(vector >> 8))
+                entries.push_back(bus.read(vector) | (bus.read(vector + 1) << 8));
+        }
+
+        for (int index = 3; index < argc; index++) {
+            entries.push_back(std::stoul(argv[index], nullptr, 16));
+        }
+
+        Recompiler recompiler(bus, cpu.getVariant());
+        recompiler.run(entries);
+
+        if (!recompiler.getBlocks())
+            throw std::runtime_error("No blocks found");
+
+        // Name without directories, kept as string literal
+        auto name = path.substr(path.find_last_of("/\\") + 1);
+        name.erase(std::remove(name.begin(), name.end(), '"'), name.end());
+
+        std::ofstream file(argv[2], std::ios::out | std::ios::binary);
+
+        if (!file.is_open())
+            throw std::runtime_error(fmt::format("Unable to write {}", argv[2]));
+
+        file << recompiler.unit(name, hash(path));
+
+        fmt::print("{} blocks of {} commands written to {}\n", recompiler.getBlocks(), recompiler.getCommands(), argv[2]);
+    }
+    catch(const std::exception & e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "cpu/cpu.h"
+#include "bus/bus.h"
+
+#include "fmt/core.h"
+
+//
+// Flag update micro-benchmark
+//
+//      Runs a block of one command repeated, followed by JMP back, on the
+//      bare CPU and prints time per command for both dispatch engines.
+//      NOP is the baseline of fetch and dispatch, cost over it is what
+//      the command and its flag updates take. Build with and without
+//      LAZY_FLAGS to compare status representations.
+//
+
+struct Case
+{
+    const char * name;
+    std::vector<uint8_t> code;
+};
+
+static const Case cases[] =
+{
+    { "NOP",     { 0xEA } },
+    { "LDA #",   { 0xA9, 0x80 } },
+    { "ADC #",   { 0x69, 0x35 } },
+    { "SBC #",   { 0xE9, 0x35 } },
+    { "CMP #",   { 0xC9, 0x35 } },
+    { "BIT zpg", { 0x24, 0x10 } },
+    { "ROL A",   { 0x2A } },
+    { "ROR A",   { 0x6A } }
+};
+
+// Commands per block
+static const unsigned repeat = 200;
+
+// CPU cycles per measurement
+static const uint64_t budget = 200000000;
+
+
+/*
+    Nanoseconds per command of case on engine
+*/
+static double measure(const Case & test, Cpu::Engine engine)
+{
+    Bus bus;
+
+    std::vector<uint8_t> program;
+
+    for (unsigned index = 0; index < repeat; index++) {
+        program.insert(program.end(), test.code.begin(), test.code.end());
+    }
+
+    // JMP $0400
+    program.insert(program.end(), { 0x4C, 0x00, 0x04 });
+
+    bus.poke(0x0400, program.data(), program.size());
+
+    Cpu cpu(bus);
+
+    cpu.setEngine(engine);
+    cpu.setPc(0x0400);
+
+    auto start = std::chrono::steady_clock::now();
+
+    cpu.until(budget);
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / cpu.getCounter();
+}
+
+
+int main()
+{
+    #ifdef LAZY_FLAGS
+        fmt::print("\nStatus flags: lazy\n\n");
+    #else
+        fmt::print("\nStatus flags: eager\n\n");
+    #endif
+
+    fmt::print("{:<10}{:>10}{:>10}{:>12}{:>12}\n", "command", "table", "switch", "table-NOP", "switch-NOP");
+
+    double table = 0;
+    double fused = 0;
+
+    for (auto & test : cases)
+    {
+        auto t = measure(test, Cpu::Engine::Table);
+        auto s = measure(test, Cpu::Engine::Switch);
+
+        // NOP is measured first
+        if (&test == &cases[0])
+        {
+            table = t;
+            fused = s;
+        }
+
+        fmt::print("{:<10}{:>8.2f}ns{:>8.2f}ns{:>10.2f}ns{:>10.2f}ns\n", test.name, t, s, t - table, s - fused);
+    }
+}
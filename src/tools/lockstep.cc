@@ -0,0 +1,152 @@
+/*
+ * This file is part of the NES-6502 distribution (https://github.com/temaweb/NES-6502).
+ * Copyright (c) 2021 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "cpu/cpu.h"
+#include "bus/bus.h"
+#include "lockstep/lockstep.h"
+
+#include "fmt/core.h"
+
+//
+// Lockstep benchmark
+//
+//      Runs the same kernel on many CPUs, each with its own seed, once
+//      as independent CPUs and once in Lockstep, and prints aggregate
+//      commands per second of both. The kernel steps a Galois LFSR per
+//      lane, so its carry branch splits and joins lanes on every byte.
+//      Lanes of Lockstep are compared with independent CPUs afterwards.
+//
+
+// LFSR of seed at $10 filling $0200-$02FF, sum at $11
+static const std::vector<uint8_t> kernel
+{
+    0xA2, 0x00,       // $0400  LDX #$00
+    0xA5, 0x10,       // $0402  LDA $10
+    0x0A,             // $0404  ASL A
+    0x90, 0x02,       // $0405  BCC $0409
+    0x49, 0x1D,       // $0407  EOR #$1D
+    0x85, 0x10,       // $0409  STA $10
+    0x9D, 0x00, 0x02, // $040B  STA $0200,X
+    0x18,             // $040E  CLC
+    0x65, 0x11,       // $040F  ADC $11
+    0x85, 0x11,       // $0411  STA $11
+    0xE8,             // $0413  INX
+    0xD0, 0xEC,       // $0414  BNE $0402
+    0x4C, 0x00, 0x04  // $0416  JMP $0400
+};
+
+// CPU cycles per lane
+static const uint64_t budget = 2000000;
+
+
+/*
+    Seed of lane, never zero
+*/
+static uint8_t seed(size_t lane)
+{
+    return uint8_t(lane * 37 + 1) | 0x01;
+}
+
+
+/*
+    Lanes of Lockstep match independent CPUs
+*/
+static size_t compare(Lockstep & lockstep, std::vector<std::unique_ptr<Cpu>> & cpus, std::vector<std::unique_ptr<Bus>> & buses)
+{
+    size_t mismatches = 0;
+
+    for (size_t lane = 0; lane < lockstep.size(); lane++)
+    {
+        auto & cpu = lockstep.getCpu(lane);
+        auto & bus = lockstep.getBus(lane);
+
+        bool same = cpu.getPc() == cpus[lane] -> getPc() &&
+                    cpu.getCycles() == cpus[lane] -> getCycles() &&
+                    cpu.getCounter() == cpus[lane] -> getCounter();
+
+        for (uint32_t address = 0; same && address < 0x0300; address++) {
+            same = bus.read(address) == buses[lane] -> read(address);
+        }
+
+        mismatches += !same;
+    }
+
+    return mismatches;
+}
+
+
+int main()
+{
+    Bus bus;
+    bus.poke(0x0400, kernel.data(), kernel.size());
+
+    Cpu cpu(bus);
+
+    cpu.setEngine(Cpu::Engine::Switch);
+    cpu.setPc(0x0400);
+
+    fmt::print("\n{:<8}{:>14}{:>14}{:>10}{:>10}{:>12}\n", "lanes", "independent", "lockstep", "speedup", "grouped", "mismatches");
+
+    for (size_t lanes : { 1, 8, 32, 64, 256, 1024 })
+    {
+        std::vector<std::unique_ptr<Bus>> buses;
+        std::vector<std::unique_ptr<Cpu>> cpus;
+
+        Lockstep lockstep(cpu, bus, lanes);
+
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            uint8_t value = seed(lane);
+
+            buses.push_back(bus.fork());
+            cpus.push_back(cpu.fork(*buses.back()));
+
+            buses.back() -> poke(0x10, &value, 1);
+            lockstep.getBus(lane).poke(0x10, &value, 1);
+        }
+
+        uint64_t commands = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto & lane : cpus)
+        {
+            lane -> run(budget);
+            commands += lane -> getCounter();
+        }
+
+        std::chrono::duration<double> independent = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+
+        lockstep.run(budget);
+
+        std::chrono::duration<double> grouped = std::chrono::steady_clock::now() - start;
+
+        double total = lockstep.getGrouped() + lockstep.getSingle();
+
+        fmt::print("{:<8}{:>8.1f}M/s{:>11.1f}M/s{:>9.2f}x{:>9.1f}%{:>12}\n", lanes,
+            commands / independent.count() / 1e6,
+            total / grouped.count() / 1e6,
+            independent.count() / grouped.count(),
+            100.0 * lockstep.getGrouped() / total,
+            compare(lockstep, cpus, buses));
+    }
+}